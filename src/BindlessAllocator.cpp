@@ -0,0 +1,57 @@
+#include "BindlessAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+BindlessAllocator::BindlessAllocator(uint32_t capacity)
+    : _states(capacity, State::Free)
+{
+    if (capacity == 0 || capacity == Invalid) {
+        throw std::invalid_argument("Bindless capacity out of range");
+    }
+    _free.reserve(capacity);
+    for (uint32_t index = capacity; index-- > 0;) {
+        _free.push_back(index);
+    }
+}
+
+uint32_t BindlessAllocator::Allocate()
+{
+    if (_free.empty()) {
+        return Invalid;
+    }
+    const uint32_t index = _free.back();
+    _free.pop_back();
+    _states[index] = State::Live;
+    _peakLive = std::max(_peakLive, ++_live);
+    return index;
+}
+
+void BindlessAllocator::Free(uint32_t index, uint64_t fenceValue)
+{
+    if (index >= _states.size()) {
+        throw std::out_of_range("Bindless index out of range");
+    }
+    if (_states[index] != State::Live) {
+        throw std::logic_error("Bindless index freed twice or never allocated");
+    }
+    if (!_retiring.empty() && fenceValue < _retiring.back().fenceValue) {
+        throw std::logic_error("Bindless frees have to come in fence order");
+    }
+    _states[index] = State::Retiring;
+    _retiring.push_back(RetiringIndex{ fenceValue, index });
+    --_live;
+}
+
+uint32_t BindlessAllocator::Reclaim(uint64_t completedValue)
+{
+    uint32_t reclaimed = 0;
+    while (!_retiring.empty() && _retiring.front().fenceValue <= completedValue) {
+        const uint32_t index = _retiring.front().index;
+        _retiring.pop_front();
+        _states[index] = State::Free;
+        _free.push_back(index);
+        ++reclaimed;
+    }
+    return reclaimed;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Indices into a bindless descriptor heap. Shaders reach a resource through the index of its
+// descriptor, so an index never moves while it is allocated, and it is only handed out again once
+// the GPU can no longer index it: Free() takes the fence value of the last submission that may use
+// the index and Reclaim() returns it to the free list once that value has completed.
+//
+// The free list is a stack: a fresh allocator hands out 0, 1, 2, ... and afterwards the most recently
+// reclaimed index goes out first. Allocate, Free and Reclaim are O(1) per index.
+class BindlessAllocator
+{
+public:
+    static constexpr uint32_t Invalid = UINT32_MAX;
+
+    // Indices [0, capacity)
+    explicit BindlessAllocator(uint32_t capacity);
+
+    // A free index, or Invalid when every index is live or waiting for its fence.
+    // Reclaim or wait for OldestFence() and try again.
+    uint32_t Allocate();
+    // index stays reserved until fenceValue completes. Fence values must not decrease between calls.
+    void Free(uint32_t index, uint64_t fenceValue);
+    // Releases the indices freed with a fence value <= completedValue, returns how many
+    uint32_t Reclaim(uint64_t completedValue);
+
+    bool IsLive(uint32_t index) const { return index < _states.size() && _states[index] == State::Live; }
+    // Fence value of the oldest pending free, 0 when there is none
+    uint64_t OldestFence() const { return _retiring.empty() ? 0 : _retiring.front().fenceValue; }
+    uint32_t Capacity() const { return static_cast<uint32_t>(_states.size()); }
+    uint32_t Live() const { return _live; }
+    uint32_t PeakLive() const { return _peakLive; }
+    uint32_t Retiring() const { return static_cast<uint32_t>(_retiring.size()); }
+    uint32_t Available() const { return static_cast<uint32_t>(_free.size()); }
+
+private:
+    enum class State : uint8_t
+    {
+        Free,
+        Live,
+        Retiring,
+    };
+
+    struct RetiringIndex
+    {
+        uint64_t fenceValue;
+        uint32_t index;
+    };
+
+    std::vector<uint32_t>       _free;          // top is back()
+    std::vector<State>          _states;
+    std::deque<RetiringIndex>   _retiring;      // fence values non-decreasing
+    uint32_t                    _live = 0;
+    uint32_t                    _peakLive = 0;
+};
@@ -1,8 +1,41 @@
 set CompilerPath="D:\Programming\Windows Kits\10\bin\10.0.19041.0\x64\dxc.exe"
 
-set MeshShaderParams=-O0 -T ms_6_5 -Fo ../build/Debug/MeshletMS.cso MeshletMS.hlsl -Fc ../build/Debug/MeshletMS.asm
+rem One mesh shader per entry of MeshletConfigs in MeshletConfig.h, "MeshletTool occupancy" prints the defines.
+rem The _flat variants read MeshletVertexLayout::Flat packs, _bytes MeshletPrimitiveFormat::Bytes packs and
+rem _quant / _split MeshletVertexFormat::Quantized / Split packs, in that order when combined.
+set MeshShaderParams=-O0 -T ms_6_6 MeshletMS.hlsl
+set AmplificationShaderParams=-O0 -T as_6_6 MeshletAS.hlsl
+set HzbShaderParams=-O0 -T cs_6_5 -Fo ../build/Debug/HzbCS.cso HzbCS.hlsl -Fc ../build/Debug/HzbCS.asm
+set DrawCullShaderParams=-O0 -T cs_6_5 -Fo ../build/Debug/DrawCullCS.cso DrawCullCS.hlsl -Fc ../build/Debug/DrawCullCS.asm
 set PixelShaderParams=-O0 -T ps_6_5 -Fo ../build/Debug/MeshletPS.cso MeshletPS.hlsl -Fc ../build/Debug/MeshletPS.asm
 
-%CompilerPath% %MeshShaderParams%
+call :MeshShader 128v128p "-D MAX_VERTS=128 -D MAX_PRIMS=128 -D GROUP_SIZE_X=128"
+call :MeshShader 64v126p "-D MAX_VERTS=64 -D MAX_PRIMS=126 -D GROUP_SIZE_X=128"
+call :MeshShader 64v84p "-D MAX_VERTS=64 -D MAX_PRIMS=84 -D GROUP_SIZE_X=96"
+rem Config independent, every mesh shader variant runs behind the same early and late amplification shaders
+%CompilerPath% %AmplificationShaderParams% -D OCCLUSION_PASS=1 -Fo ../build/Debug/MeshletAS_early.cso -Fc ../build/Debug/MeshletAS_early.asm
+%CompilerPath% %AmplificationShaderParams% -D OCCLUSION_PASS=2 -Fo ../build/Debug/MeshletAS_late.cso -Fc ../build/Debug/MeshletAS_late.asm
+%CompilerPath% %HzbShaderParams%
+%CompilerPath% %DrawCullShaderParams%
 %CompilerPath% %PixelShaderParams%
+goto :eof
 
+:MeshShader
+call :PrimitiveVariants %1 "%~2"
+call :PrimitiveVariants %1_flat "%~2 -D FLAT_VERTICES"
+goto :eof
+
+:PrimitiveVariants
+call :VertexVariants %1 "%~2"
+call :VertexVariants %1_bytes "%~2 -D BYTE_PRIMITIVES"
+goto :eof
+
+:VertexVariants
+call :Compile %1 "%~2"
+call :Compile %1_quant "%~2 -D QUANTIZED_VERTICES"
+call :Compile %1_split "%~2 -D SPLIT_VERTICES"
+goto :eof
+
+:Compile
+%CompilerPath% %MeshShaderParams% %~2 -Fo ../build/Debug/MeshletMS_%1.cso -Fc ../build/Debug/MeshletMS_%1.asm
+goto :eof
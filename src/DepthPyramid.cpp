@@ -0,0 +1,113 @@
+#include "DepthPyramid.h"
+
+#include <algorithm>
+#include <cmath>
+
+DepthProjection DepthProjection::FromMatrix(const float (&m)[4][4])
+{
+    // clip.z = z * m22 + m32 and clip.w = -z = d
+    DepthProjection projection;
+    projection.p00 = m[0][0];
+    projection.p11 = m[1][1];
+    projection.depthOffset = -m[2][2];
+    projection.depthScale = m[3][2];
+    projection.zNear = m[3][2] / m[2][2];
+    return projection;
+}
+
+uint32_t DepthPyramid::LevelCount(uint32_t width, uint32_t height)
+{
+    uint32_t size = std::max(1u, std::max(width, height) >> 1);
+    uint32_t levels = 1;
+    while (size > 1) {
+        size >>= 1;
+        ++levels;
+    }
+    return levels;
+}
+
+void DepthPyramid::Build(const float* depth, uint32_t width, uint32_t height)
+{
+    _width = width;
+    _height = height;
+    _levels.assign(LevelCount(width, height), {});
+
+    const float* source = depth;
+    uint32_t sourceWidth = width;
+    uint32_t sourceHeight = height;
+    for (uint32_t level = 0; level < Levels(); ++level) {
+        const uint32_t levelWidth = Width(level);
+        const uint32_t levelHeight = Height(level);
+        std::vector<float>& texels = _levels[level];
+        texels.resize(size_t(levelWidth) * levelHeight);
+
+        // Same as HzbCS.hlsl
+        for (uint32_t y = 0; y < levelHeight; ++y) {
+            const uint32_t y0 = y * 2;
+            const uint32_t y1 = std::min(y0 + 1 + (y == levelHeight - 1 ? sourceHeight & 1 : 0), sourceHeight - 1);
+            for (uint32_t x = 0; x < levelWidth; ++x) {
+                const uint32_t x0 = x * 2;
+                const uint32_t x1 = std::min(x0 + 1 + (x == levelWidth - 1 ? sourceWidth & 1 : 0), sourceWidth - 1);
+                float farthest = 0.f;
+                for (uint32_t sy = y0; sy <= y1; ++sy) {
+                    for (uint32_t sx = x0; sx <= x1; ++sx) {
+                        farthest = std::max(farthest, source[sy * sourceWidth + sx]);
+                    }
+                }
+                texels[y * levelWidth + x] = farthest;
+            }
+        }
+
+        source = texels.data();
+        sourceWidth = levelWidth;
+        sourceHeight = levelHeight;
+    }
+}
+
+bool DepthPyramid::SphereVisible(const Float3& viewCenter, float radius, const DepthProjection& projection) const
+{
+    // Distance in front of the camera
+    const Float3 c = { viewCenter.x, viewCenter.y, -viewCenter.z };
+    if (c.z - radius < projection.zNear || _levels.empty()) {
+        return true;
+    }
+
+    // Screen rectangle of the projected sphere, 2D Polyhedral Bounds of a Clipped, Perspective-Projected
+    // 3D Sphere (Mara, McGuire 2013)
+    const float czr2 = c.z * c.z - radius * radius;
+    const float vx = std::sqrt(c.x * c.x + czr2);
+    const float minX = (vx * c.x - c.z * radius) / (vx * c.z + c.x * radius);
+    const float maxX = (vx * c.x + c.z * radius) / (vx * c.z - c.x * radius);
+    const float vy = std::sqrt(c.y * c.y + czr2);
+    const float minY = (vy * c.y - c.z * radius) / (vy * c.z + c.y * radius);
+    const float maxY = (vy * c.y + c.z * radius) / (vy * c.z - c.y * radius);
+
+    // Clip space to depth pixels, y points down
+    auto pixel = [](float ndc, float scale, uint32_t size, bool flip) {
+        const float uv = flip ? ndc * scale * -0.5f + 0.5f : ndc * scale * 0.5f + 0.5f;
+        return static_cast<int32_t>(std::clamp(std::floor(uv * size), 0.f, float(size - 1)));
+    };
+    const int32_t x0 = pixel(minX, projection.p00, _width, false);
+    const int32_t x1 = pixel(maxX, projection.p00, _width, false);
+    const int32_t y0 = pixel(maxY, projection.p11, _height, true);
+    const int32_t y1 = pixel(minY, projection.p11, _height, true);
+
+    // Lowest level where the rectangle touches at most 2x2 texels
+    uint32_t level = 0;
+    while (level + 1 < Levels() && ((x1 >> (level + 1)) - (x0 >> (level + 1)) > 1 || (y1 >> (level + 1)) - (y0 >> (level + 1)) > 1)) {
+        ++level;
+    }
+    const uint32_t tx0 = std::min(uint32_t(x0) >> (level + 1), Width(level) - 1);
+    const uint32_t tx1 = std::min(uint32_t(x1) >> (level + 1), Width(level) - 1);
+    const uint32_t ty0 = std::min(uint32_t(y0) >> (level + 1), Height(level) - 1);
+    const uint32_t ty1 = std::min(uint32_t(y1) >> (level + 1), Height(level) - 1);
+    float farthest = 0.f;
+    for (uint32_t y = ty0; y <= ty1; ++y) {
+        for (uint32_t x = tx0; x <= tx1; ++x) {
+            farthest = std::max(farthest, Texel(level, x, y));
+        }
+    }
+
+    const float nearestDepth = projection.depthOffset + projection.depthScale / (c.z - radius);
+    return nearestDepth <= farthest;
+}
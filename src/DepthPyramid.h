@@ -0,0 +1,56 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// What the occlusion test needs from a right handed D3D perspective projection
+// (XMMatrixPerspectiveFovRH: the view looks down -z, depth 0 at the near and 1 at the far plane).
+// depth(d) = depthOffset + depthScale / d for a point d units in front of the camera.
+struct DepthProjection
+{
+    float   p00;
+    float   p11;
+    float   zNear;
+    float   depthOffset;
+    float   depthScale;
+
+    // matrix as for Frustum::FromMatrix, row vectors
+    static DepthProjection FromMatrix(const float (&matrix)[4][4]);
+};
+
+// Hierarchical Z: a max (farthest depth) mip chain of a depth buffer, the CPU reference of HzbCS.hlsl.
+//
+// Level 0 is half the depth buffer size and every level halves the previous one the way D3D12 mips
+// do, rounding down. Texels on the last row or column of an odd sized level also cover the row or
+// column that rounding drops, so depth pixel p is covered by texel min(p >> (level + 1), size - 1).
+class DepthPyramid
+{
+public:
+    // depth is width * height, row major, top row first
+    void Build(const float* depth, uint32_t width, uint32_t height);
+
+    uint32_t Levels() const { return static_cast<uint32_t>(_levels.size()); }
+    uint32_t Width(uint32_t level) const { return std::max(1u, _width >> (level + 1)); }
+    uint32_t Height(uint32_t level) const { return std::max(1u, _height >> (level + 1)); }
+    float Texel(uint32_t level, uint32_t x, uint32_t y) const { return _levels[level][y * Width(level) + x]; }
+
+    // Depth buffer size the pyramid was built from
+    uint32_t DepthWidth() const { return _width; }
+    uint32_t DepthHeight() const { return _height; }
+
+    // False when the sphere (view space, right handed) is behind the depth buffer everywhere it
+    // covers. Spheres crossing the near plane are always visible. Same steps as OcclusionVisible in
+    // MeshletAS.hlsl; that one uses GPU sqrt and division, so the two can round differently.
+    bool SphereVisible(const Float3& viewCenter, float radius, const DepthProjection& projection) const;
+
+    // Mip count of a pyramid for the given depth buffer size
+    static uint32_t LevelCount(uint32_t width, uint32_t height);
+
+private:
+    uint32_t                            _width = 0;
+    uint32_t                            _height = 0;
+    std::vector<std::vector<float>>     _levels;
+};
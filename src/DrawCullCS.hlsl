@@ -0,0 +1,69 @@
+// Frustum culls the MeshletDraw records and appends the DispatchMeshCommand of every visible one for
+// ExecuteIndirect, see IndirectDraws for the CPU reference.
+#include "MeshletCommon.hlsli"
+
+#define ROOT_SIG "CBV(b0), SRV(t0), UAV(u0), UAV(u1), RootConstants(num32BitConstants = 1, b2)"
+
+// IndirectDraws::GroupSize on the CPU
+#define DRAW_CULL_GROUP_SIZE 64
+
+struct MeshletDraw
+{
+    float3 Center;
+    float  Radius;
+    uint   MeshletOffset;
+    uint   MeshletCount;
+    uint   Descriptors[8];      // MeshDescriptors, in DrawConstants order
+    uint2  Padding;
+};
+
+// DrawConstants, then the DispatchMesh arguments
+struct DispatchMeshCommand
+{
+    uint  MeshletOffset;
+    uint  MeshletCount;
+    uint  Descriptors[8];
+    uint3 ThreadGroupCount;
+};
+
+StructuredBuffer<MeshletDraw>           Draws       : register(t0);
+RWStructuredBuffer<DispatchMeshCommand> Commands    : register(u0);
+RWByteAddressBuffer                     Count       : register(u1);     // zeroed before the dispatch
+
+// Draws is a root SRV, which carries no size to query. b1 is the mesh passes' DrawConstants.
+cbuffer CullConstants : register(b2)
+{
+    uint DrawCount;
+};
+
+[RootSignature(ROOT_SIG)]
+[NumThreads(DRAW_CULL_GROUP_SIZE, 1, 1)]
+void main(uint dtid : SV_DispatchThreadID)
+{
+    bool visible = false;
+    MeshletDraw draw = (MeshletDraw)0;
+    if (dtid < DrawCount)
+    {
+        draw = Draws[dtid];
+        visible = SphereVisible(draw.Center, draw.Radius);
+    }
+
+    // One atomic per wave, the lanes fill the wave's range in order
+    uint waveCount = WaveActiveCountBits(visible);
+    uint base = 0;
+    if (WaveIsFirstLane())
+    {
+        Count.InterlockedAdd(0, waveCount, base);
+    }
+    base = WaveReadLaneFirst(base);
+
+    if (visible)
+    {
+        DispatchMeshCommand command;
+        command.MeshletOffset = draw.MeshletOffset;
+        command.MeshletCount = draw.MeshletCount;
+        command.Descriptors = draw.Descriptors;
+        command.ThreadGroupCount = uint3((draw.MeshletCount + AS_GROUP_SIZE - 1) / AS_GROUP_SIZE, 1, 1);
+        Commands[base + WavePrefixCountBits(visible)] = command;
+    }
+}
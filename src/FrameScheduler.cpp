@@ -0,0 +1,45 @@
+#include "FrameScheduler.h"
+
+#include <stdexcept>
+
+FrameScheduler::FrameScheduler(FrameQueue& queue, uint32_t framesInFlight)
+    : _queue(queue), _slotFences(framesInFlight, 0)
+{
+    if (framesInFlight == 0) {
+        throw std::invalid_argument("At least one frame has to be in flight");
+    }
+}
+
+uint32_t FrameScheduler::BeginFrame()
+{
+    if (_inFrame) {
+        throw std::logic_error("BeginFrame called twice without EndFrame");
+    }
+    const uint32_t slot = static_cast<uint32_t>(_frameIndex % _slotFences.size());
+    if (_queue.CompletedValue() < _slotFences[slot]) {
+        _queue.WaitFor(_slotFences[slot]);
+        ++_waits;
+    }
+    _inFrame = true;
+    ++_frameIndex;
+    return slot;
+}
+
+uint64_t FrameScheduler::EndFrame()
+{
+    if (!_inFrame) {
+        throw std::logic_error("EndFrame called without BeginFrame");
+    }
+    const uint32_t slot = static_cast<uint32_t>((_frameIndex - 1) % _slotFences.size());
+    _slotFences[slot] = _queue.Signal();
+    _inFrame = false;
+    return _slotFences[slot];
+}
+
+void FrameScheduler::WaitIdle()
+{
+    const uint64_t value = _queue.Signal();
+    if (_queue.CompletedValue() < value) {
+        _queue.WaitFor(value);
+    }
+}
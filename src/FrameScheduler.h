@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// The part of a GPU queue frame pacing needs: a fence that counts up as submitted work completes.
+// D3D12FrameQueue in main.cpp wraps ID3D12CommandQueue::Signal and an ID3D12Fence, MeshletTool's
+// frame-pacing command simulates one.
+class FrameQueue
+{
+public:
+    virtual ~FrameQueue() = default;
+
+    // Fence value that is reached once everything submitted so far has completed
+    virtual uint64_t Signal() = 0;
+    virtual uint64_t CompletedValue() = 0;
+    // Blocks until CompletedValue() >= value
+    virtual void WaitFor(uint64_t value) = 0;
+};
+
+// N frames in flight. Every frame owns a slot of per-frame resources (command allocator, constant
+// buffer range, ...) that the CPU may only touch again once the GPU is done with the frame that last
+// used it, so BeginFrame waits for that frame's fence and nothing else.
+class FrameScheduler
+{
+public:
+    FrameScheduler(FrameQueue& queue, uint32_t framesInFlight);
+
+    // Slot of the next frame, in [0, FramesInFlight()). Its resources are free when this returns.
+    uint32_t BeginFrame();
+    // After submitting the frame's work. Returns the fence value that releases the slot.
+    uint64_t EndFrame();
+    // Waits for everything submitted so far, e.g. before resizing or destroying per-frame resources.
+    void WaitIdle();
+
+    uint32_t FramesInFlight() const { return static_cast<uint32_t>(_slotFences.size()); }
+    uint64_t FrameIndex() const { return _frameIndex; }     // frames begun so far
+    uint32_t Waits() const { return _waits; }               // BeginFrame calls that had to block
+
+private:
+    FrameQueue&             _queue;
+    std::vector<uint64_t>   _slotFences;    // fence value releasing every slot, 0 = never used
+    uint64_t                _frameIndex = 0;
+    uint32_t                _waits = 0;
+    bool                    _inFrame = false;
+};
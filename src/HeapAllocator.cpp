@@ -0,0 +1,366 @@
+#include "HeapAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+uint32_t LowestBit(uint64_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+uint32_t HighestBit(uint64_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+bool IsPowerOfTwo(uint64_t value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+HeapAllocator::HeapAllocator(uint64_t blockSize, uint64_t granularity)
+    : _blockSize(blockSize)
+    , _granularity(granularity)
+{
+    if (!IsPowerOfTwo(blockSize) || !IsPowerOfTwo(granularity) || blockSize < granularity) {
+        throw std::invalid_argument("Heap block size and granularity must be powers of two, the block size at least the granularity");
+    }
+    _granularityShift = LowestBit(granularity);
+    for (auto& firstLevel : _freeLists) {
+        std::fill(std::begin(firstLevel), std::end(firstLevel), None);
+    }
+}
+
+// Sizes are binned in granularity units: the first level is the highest set bit, the second level
+// the next SecondLevelBits bits below it. Below 2^SecondLevelBits units every size has a bin of its own.
+void HeapAllocator::Bin(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel) const
+{
+    const uint64_t units = size >> _granularityShift;
+    firstLevel = HighestBit(units);
+    const uint64_t mantissa = firstLevel >= SecondLevelBits ? units >> (firstLevel - SecondLevelBits) : units << (SecondLevelBits - firstLevel);
+    secondLevel = static_cast<uint32_t>(mantissa ^ SecondLevelCount);
+}
+
+uint32_t HeapAllocator::FindFree(uint64_t size) const
+{
+    // Round up to the start of the next bin, so every range in the bin found fits
+    uint64_t units = size >> _granularityShift;
+    const uint32_t highest = HighestBit(units);
+    if (highest >= SecondLevelBits) {
+        units += (uint64_t(1) << (highest - SecondLevelBits)) - 1;
+    }
+    if (units < (size >> _granularityShift)) {
+        return None;
+    }
+
+    uint32_t firstLevel, secondLevel;
+    Bin(units << _granularityShift, firstLevel, secondLevel);
+    uint32_t secondLevelMap = _secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    if (secondLevelMap == 0) {
+        const uint64_t firstLevelMap = firstLevel + 1 < FirstLevelCount ? _firstLevelBitmap & (~uint64_t(0) << (firstLevel + 1)) : 0;
+        if (firstLevelMap == 0) {
+            return None;
+        }
+        firstLevel = LowestBit(firstLevelMap);
+        secondLevelMap = _secondLevelBitmaps[firstLevel];
+    }
+    return _freeLists[firstLevel][LowestBit(secondLevelMap)];
+}
+
+uint32_t HeapAllocator::FindExact(uint64_t size, uint64_t alignment) const
+{
+    // The ranges in the request's own bin may still fit, walk it before giving up
+    uint32_t firstLevel, secondLevel;
+    Bin(size, firstLevel, secondLevel);
+    for (uint32_t index = _freeLists[firstLevel][secondLevel]; index != None; index = _nodes[index].nextFree) {
+        const Node& node = _nodes[index];
+        if (AlignUp(node.offset, alignment) + size <= node.offset + node.size) {
+            return index;
+        }
+    }
+    return None;
+}
+
+void HeapAllocator::InsertFree(uint32_t index)
+{
+    uint32_t firstLevel, secondLevel;
+    Bin(_nodes[index].size, firstLevel, secondLevel);
+    Node& node = _nodes[index];
+    node.free = true;
+    node.prevFree = None;
+    node.nextFree = _freeLists[firstLevel][secondLevel];
+    if (node.nextFree != None) {
+        _nodes[node.nextFree].prevFree = index;
+    }
+    _freeLists[firstLevel][secondLevel] = index;
+    _secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+    _firstLevelBitmap |= uint64_t(1) << firstLevel;
+}
+
+void HeapAllocator::RemoveFree(uint32_t index)
+{
+    Node& node = _nodes[index];
+    if (node.prevFree != None) {
+        _nodes[node.prevFree].nextFree = node.nextFree;
+    } else {
+        uint32_t firstLevel, secondLevel;
+        Bin(node.size, firstLevel, secondLevel);
+        _freeLists[firstLevel][secondLevel] = node.nextFree;
+        if (node.nextFree == None) {
+            _secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if (_secondLevelBitmaps[firstLevel] == 0) {
+                _firstLevelBitmap &= ~(uint64_t(1) << firstLevel);
+            }
+        }
+    }
+    if (node.nextFree != None) {
+        _nodes[node.nextFree].prevFree = node.prevFree;
+    }
+    node.free = false;
+}
+
+uint32_t HeapAllocator::NewNode()
+{
+    if (!_unusedNodes.empty()) {
+        const uint32_t index = _unusedNodes.back();
+        _unusedNodes.pop_back();
+        return index;
+    }
+    _nodes.push_back(Node{});
+    return static_cast<uint32_t>(_nodes.size() - 1);
+}
+
+void HeapAllocator::ReleaseNode(uint32_t index)
+{
+    _nodes[index].block = None;
+    _unusedNodes.push_back(index);
+}
+
+uint32_t HeapAllocator::AddBlock(uint64_t size, bool dedicated)
+{
+    uint32_t block = static_cast<uint32_t>(_blocks.size());
+    if (!_releasedBlocks.empty()) {
+        block = _releasedBlocks.back();
+        _releasedBlocks.pop_back();
+    } else {
+        _blocks.push_back(Block{});
+    }
+    const uint32_t index = NewNode();
+    _nodes[index] = Node{ 0, size, block, None, None, None, None, 0, 0, false };
+    _blocks[block] = Block{ size, index, dedicated };
+    _reserved += size;
+    InsertFree(index);
+    return index;
+}
+
+HeapAllocation HeapAllocator::Allocate(uint64_t size, uint64_t alignment, uint32_t category)
+{
+    if (size == 0 || !IsPowerOfTwo(alignment) || category >= MaxCategories) {
+        throw std::invalid_argument("Heap allocations need a size, a power of two alignment and a known category");
+    }
+    alignment = std::max(alignment, _granularity);
+    const uint64_t alignedSize = AlignUp(size, _granularity);
+    // Worst case front padding, the free ranges start on granularity boundaries
+    const uint64_t searchSize = alignedSize + alignment - _granularity;
+
+    // Blocks start at offset 0, which is aligned for everything
+    uint32_t index = None;
+    if (alignedSize > _blockSize / 2) {
+        index = AddBlock(alignedSize, true);
+    } else {
+        index = FindFree(searchSize);
+        if (index == None) {
+            index = FindExact(alignedSize, alignment);
+        }
+        if (index == None) {
+            index = AddBlock(_blockSize, false);
+        }
+    }
+    RemoveFree(index);
+
+    const uint64_t padding = AlignUp(_nodes[index].offset, alignment) - _nodes[index].offset;
+    if (padding > 0) {
+        // The front stays free in the original node, the allocation is split off behind it
+        const uint32_t allocated = NewNode();
+        Node& front = _nodes[index];
+        _nodes[allocated] = Node{ front.offset + padding, front.size - padding, front.block, index, front.nextPhysical, None, None, 0, 0, false };
+        if (front.nextPhysical != None) {
+            _nodes[front.nextPhysical].prevPhysical = allocated;
+        }
+        front.nextPhysical = allocated;
+        front.size = padding;
+        InsertFree(index);
+        index = allocated;
+    }
+    if (_nodes[index].size > alignedSize) {
+        const uint32_t rest = NewNode();
+        Node& node = _nodes[index];
+        _nodes[rest] = Node{ node.offset + alignedSize, node.size - alignedSize, node.block, index, node.nextPhysical, None, None, 0, 0, false };
+        if (node.nextPhysical != None) {
+            _nodes[node.nextPhysical].prevPhysical = rest;
+        }
+        node.nextPhysical = rest;
+        node.size = alignedSize;
+        InsertFree(rest);
+    }
+
+    Node& node = _nodes[index];
+    node.category = category;
+    node.requested = size;
+    _used += node.size;
+    _peakUsed = std::max(_peakUsed, _used);
+
+    HeapCategoryStats& stats = _categories[category];
+    ++stats.allocations;
+    ++stats.totalAllocations;
+    stats.bytes += size;
+    stats.peakBytes = std::max(stats.peakBytes, stats.bytes);
+    return HeapAllocation{ node.block, node.offset, size, index };
+}
+
+bool HeapAllocator::Free(const HeapAllocation& allocation)
+{
+    if (!allocation.Valid() || allocation.node >= _nodes.size()) {
+        throw std::logic_error("Freeing a heap allocation this allocator didn't make");
+    }
+    uint32_t index = allocation.node;
+    {
+        const Node& node = _nodes[index];
+        if (node.free || node.block != allocation.block || node.offset != allocation.offset) {
+            throw std::logic_error("Heap allocation freed twice or not from this allocator");
+        }
+        HeapCategoryStats& stats = _categories[node.category];
+        --stats.allocations;
+        stats.bytes -= node.requested;
+        _used -= node.size;
+
+        Block& block = _blocks[node.block];
+        if (block.dedicated) {
+            // The allocation is all there is in it
+            _reserved -= block.capacity;
+            block = Block{ 0, None, false };
+            _releasedBlocks.push_back(node.block);
+            ReleaseNode(index);
+            return true;
+        }
+    }
+
+    const uint32_t prev = _nodes[index].prevPhysical;
+    if (prev != None && _nodes[prev].free) {
+        RemoveFree(prev);
+        _nodes[prev].size += _nodes[index].size;
+        _nodes[prev].nextPhysical = _nodes[index].nextPhysical;
+        if (_nodes[index].nextPhysical != None) {
+            _nodes[_nodes[index].nextPhysical].prevPhysical = prev;
+        }
+        ReleaseNode(index);
+        index = prev;
+    }
+    const uint32_t next = _nodes[index].nextPhysical;
+    if (next != None && _nodes[next].free) {
+        RemoveFree(next);
+        _nodes[index].size += _nodes[next].size;
+        _nodes[index].nextPhysical = _nodes[next].nextPhysical;
+        if (_nodes[next].nextPhysical != None) {
+            _nodes[_nodes[next].nextPhysical].prevPhysical = index;
+        }
+        ReleaseNode(next);
+    }
+    InsertFree(index);
+    return false;
+}
+
+uint64_t HeapAllocator::LargestFreeRange() const
+{
+    if (_firstLevelBitmap == 0) {
+        return 0;
+    }
+    const uint32_t firstLevel = HighestBit(_firstLevelBitmap);
+    const uint32_t secondLevel = HighestBit(_secondLevelBitmaps[firstLevel]);
+    uint64_t largest = 0;
+    for (uint32_t index = _freeLists[firstLevel][secondLevel]; index != None; index = _nodes[index].nextFree) {
+        largest = std::max(largest, _nodes[index].size);
+    }
+    return largest;
+}
+
+double HeapAllocator::Fragmentation() const
+{
+    const uint64_t free = _reserved - _used;
+    return free == 0 ? 0.0 : 1.0 - double(LargestFreeRange()) / free;
+}
+
+void HeapAllocator::Validate() const
+{
+    auto check = [](bool condition, const char* message)
+    {
+        if (!condition) {
+            throw std::logic_error(std::string("Heap allocator: ") + message);
+        }
+    };
+
+    uint64_t used = 0, freeNodes = 0;
+    for (uint32_t block = 0; block < _blocks.size(); ++block) {
+        if (_blocks[block].capacity == 0) {
+            continue;
+        }
+        uint64_t offset = 0;
+        uint32_t prev = None;
+        for (uint32_t index = _blocks[block].firstNode; index != None; index = _nodes[index].nextPhysical) {
+            const Node& node = _nodes[index];
+            check(node.block == block && node.offset == offset && node.prevPhysical == prev, "broken physical list");
+            check(node.size > 0 && node.size % _granularity == 0, "size not a multiple of the granularity");
+            check(!(node.free && prev != None && _nodes[prev].free), "adjacent free ranges not merged");
+            used += node.free ? 0 : node.size;
+            freeNodes += node.free;
+            offset += node.size;
+            prev = index;
+        }
+        check(offset == _blocks[block].capacity, "block not covered");
+    }
+    check(used == _used, "used bytes out of sync");
+
+    uint64_t listed = 0;
+    for (uint32_t firstLevel = 0; firstLevel < FirstLevelCount; ++firstLevel) {
+        check(((_firstLevelBitmap >> firstLevel) & 1) == (_secondLevelBitmaps[firstLevel] != 0), "first level bitmap out of sync");
+        for (uint32_t secondLevel = 0; secondLevel < SecondLevelCount; ++secondLevel) {
+            const uint32_t head = _freeLists[firstLevel][secondLevel];
+            check(((_secondLevelBitmaps[firstLevel] >> secondLevel) & 1) == (head != None), "second level bitmap out of sync");
+            uint32_t prev = None;
+            for (uint32_t index = head; index != None; index = _nodes[index].nextFree) {
+                uint32_t f, s;
+                Bin(_nodes[index].size, f, s);
+                check(_nodes[index].free && _nodes[index].prevFree == prev && f == firstLevel && s == secondLevel, "free range in the wrong list");
+                ++listed;
+                prev = index;
+            }
+        }
+    }
+    check(listed == freeNodes, "free range missing from the free lists");
+}
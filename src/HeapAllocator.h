@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct HeapAllocation
+{
+    uint32_t    block = UINT32_MAX;     // heap the range is in, UINT32_MAX when empty
+    uint64_t    offset = 0;
+    uint64_t    size = 0;
+    uint32_t    node = 0;               // allocator internal
+
+    bool Valid() const { return block != UINT32_MAX; }
+};
+
+struct HeapCategoryStats
+{
+    uint64_t    allocations = 0;        // live
+    uint64_t    bytes = 0;              // live, as asked for
+    uint64_t    peakBytes = 0;
+    uint64_t    totalAllocations = 0;
+};
+
+// Two-level segregated fit (TLSF) allocator for placing resources in large heaps. Backend
+// independent: it only hands out (block, offset) pairs, the caller keeps one heap per block, creates
+// it when an allocation lands in a block it has no heap for and drops it when Free() says so.
+//
+// Free ranges are binned by size into 64 power of two classes split into 16 linear subclasses, with
+// a bitmap per level, so allocating and freeing are O(1). A request is rounded up to the next
+// subclass boundary, so any range in the first non-empty bin that fits is good enough; only when
+// there is none the request's own bin is searched before a new block is added. Freed ranges
+// merge with free neighbours in their block right away. Allocations above half of BlockSize() get a
+// dedicated block of their own size, released again with the allocation: they would rarely find a
+// hole and leave most of a fresh block behind. Regular blocks are kept when they empty out.
+// Released block indices are reused.
+//
+// Every offset and size is a multiple of the granularity, alignments above it are placed by
+// splitting off the front of a free range.
+class HeapAllocator
+{
+public:
+    static constexpr uint32_t MaxCategories = 16;
+
+    // blockSize and granularity are powers of two, blockSize >= granularity
+    HeapAllocator(uint64_t blockSize, uint64_t granularity = 256);
+
+    // size > 0, alignment a power of two. category < MaxCategories, only used for the statistics.
+    HeapAllocation Allocate(uint64_t size, uint64_t alignment, uint32_t category = 0);
+    // True when the allocation's block was released with it
+    bool Free(const HeapAllocation& allocation);
+
+    uint64_t BlockSize() const { return _blockSize; }
+    uint32_t BlockCount() const { return static_cast<uint32_t>(_blocks.size() - _releasedBlocks.size()); }
+    uint64_t BlockCapacity(uint32_t block) const { return _blocks[block].capacity; }   // 0 once released
+
+    uint64_t ReservedBytes() const { return _reserved; }   // all blocks
+    uint64_t UsedBytes() const { return _used; }           // allocations rounded up to the granularity
+    uint64_t PeakUsedBytes() const { return _peakUsed; }
+    uint64_t LargestFreeRange() const;
+    // 1 - largest free range / free bytes: 0 when the free space is one range, towards 1 when it is scattered
+    double Fragmentation() const;
+    const HeapCategoryStats& Category(uint32_t category) const { return _categories[category]; }
+
+    // Walks every block and free list, throws std::logic_error on inconsistencies
+    void Validate() const;
+
+private:
+    static constexpr uint32_t SecondLevelBits = 4;
+    static constexpr uint32_t SecondLevelCount = 1 << SecondLevelBits;
+    static constexpr uint32_t FirstLevelCount = 64;
+    static constexpr uint32_t None = UINT32_MAX;
+
+    struct Node
+    {
+        uint64_t    offset;
+        uint64_t    size;
+        uint32_t    block;
+        uint32_t    prevPhysical;       // neighbours in the block by offset
+        uint32_t    nextPhysical;
+        uint32_t    prevFree;           // neighbours in the free list of the bin
+        uint32_t    nextFree;
+        uint32_t    category;
+        uint64_t    requested;
+        bool        free;
+    };
+
+    struct Block
+    {
+        uint64_t    capacity;
+        uint32_t    firstNode;          // the node at offset 0, merging always keeps the lower node
+        bool        dedicated;
+    };
+
+    void Bin(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel) const;
+    uint32_t FindFree(uint64_t size) const;
+    uint32_t FindExact(uint64_t size, uint64_t alignment) const;
+    void InsertFree(uint32_t node);
+    void RemoveFree(uint32_t node);
+    uint32_t NewNode();
+    void ReleaseNode(uint32_t node);
+    uint32_t AddBlock(uint64_t size, bool dedicated);
+
+    uint64_t                _blockSize;
+    uint64_t                _granularity;
+    uint32_t                _granularityShift;
+    std::vector<Block>      _blocks;
+    std::vector<uint32_t>   _releasedBlocks;
+    std::vector<Node>       _nodes;
+    std::vector<uint32_t>   _unusedNodes;
+    uint64_t                _firstLevelBitmap = 0;
+    uint32_t                _secondLevelBitmaps[FirstLevelCount] = {};
+    uint32_t                _freeLists[FirstLevelCount][SecondLevelCount];
+    uint64_t                _reserved = 0;
+    uint64_t                _used = 0;
+    uint64_t                _peakUsed = 0;
+    HeapCategoryStats       _categories[MaxCategories];
+};
@@ -0,0 +1,37 @@
+// One level of the depth pyramid from the previous one (or the depth buffer), see DepthPyramid.
+#define ROOT_SIG "RootConstants(num32BitConstants = 4, b0), DescriptorTable(SRV(t0)), DescriptorTable(UAV(u0))"
+
+struct Reduction
+{
+    uint2 SourceSize;
+    uint2 Size;
+};
+
+ConstantBuffer<Reduction>   Reduce      : register(b0);
+Texture2D<float>            Source      : register(t0);
+RWTexture2D<float>          Destination : register(u0);
+
+[RootSignature(ROOT_SIG)]
+[NumThreads(8, 8, 1)]
+void main(uint2 dtid : SV_DispatchThreadID)
+{
+    if (any(dtid >= Reduce.Size))
+    {
+        return;
+    }
+
+    // The last row and column also take the one rounding the size down drops
+    uint2 first = dtid * 2;
+    uint2 extra = (dtid == Reduce.Size - 1) ? (Reduce.SourceSize & 1) : uint2(0, 0);
+    uint2 last = min(first + 1 + extra, Reduce.SourceSize - 1);
+
+    float farthest = 0;
+    for (uint y = first.y; y <= last.y; ++y)
+    {
+        for (uint x = first.x; x <= last.x; ++x)
+        {
+            farthest = max(farthest, Source.Load(int3(x, y, 0)));
+        }
+    }
+    Destination[dtid] = farthest;
+}
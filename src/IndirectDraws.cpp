@@ -0,0 +1,58 @@
+#include "IndirectDraws.h"
+
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+
+std::vector<MeshletDraw> IndirectDraws::Build(const PackedMeshletBounds* bounds, uint32_t meshletCount, uint32_t meshletsPerDraw,
+                                              const MeshDescriptors& descriptors)
+{
+    if (meshletsPerDraw == 0 || meshletsPerDraw % MeshletCulling::GroupSize != 0
+        || meshletsPerDraw / MeshletCulling::GroupSize > MaxThreadGroups) {
+        throw std::invalid_argument("Meshlets per draw must be a non-zero multiple of the amplification group size");
+    }
+
+    std::vector<MeshletDraw> draws;
+    for (uint32_t offset = 0; offset < meshletCount; offset += meshletsPerDraw) {
+        const uint32_t count = std::min(meshletsPerDraw, meshletCount - offset);
+
+        Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+        Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (uint32_t i = offset; i < offset + count; ++i) {
+            const Float3 r = { bounds[i].radius, bounds[i].radius, bounds[i].radius };
+            lo = Min(lo, bounds[i].center - r);
+            hi = Max(hi, bounds[i].center + r);
+        }
+        const Float3 center = (lo + hi) * 0.5f;
+        float radius = 0.f;
+        for (uint32_t i = offset; i < offset + count; ++i) {
+            radius = std::max(radius, Length(bounds[i].center - center) + bounds[i].radius);
+        }
+
+        // Grown by a few ulps of the coordinates so rounding can't leave a meshlet sphere sticking out
+        const float magnitude = std::max({ radius, std::abs(center.x), std::abs(center.y), std::abs(center.z) });
+        draws.push_back(MeshletDraw{ center, radius + 8.f * FLT_EPSILON * magnitude, offset, count, descriptors, { 0, 0 } });
+    }
+    return draws;
+}
+
+DispatchMeshCommand IndirectDraws::Command(const MeshletDraw& draw)
+{
+    const uint32_t groups = (draw.meshletCount + MeshletCulling::GroupSize - 1) / MeshletCulling::GroupSize;
+    return DispatchMeshCommand{ draw.meshletOffset, draw.meshletCount, draw.descriptors, groups, 1, 1 };
+}
+
+// Keep in sync with DrawCullCS.hlsl
+uint32_t IndirectDraws::Compact(const Frustum& frustum, const MeshletDraw* draws, uint32_t drawCount, DispatchMeshCommand* commands)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < drawCount; ++i) {
+        if (MeshletCulling::SphereVisible(frustum, draws[i].center, draws[i].radius)) {
+            commands[count++] = Command(draws[i]);
+        }
+    }
+    return count;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "MeshletCulling.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bindless descriptor heap indices of a mesh's buffers (BindlessAllocator), the ones its vertex
+// format and layout don't use are BindlessAllocator::Invalid. Same order as in DrawConstants of
+// MeshletCommon.hlsli.
+struct MeshDescriptors
+{
+    uint32_t    vertices;               // Vertex, QuantizedVertex or the positions of split vertices
+    uint32_t    meshlets;
+    uint32_t    uniqueVertexIndices;
+    uint32_t    primitiveIndices;
+    uint32_t    positionBounds;
+    uint32_t    normals;
+    uint32_t    texCoords;
+    uint32_t    bounds;                 // PackedMeshletBounds
+};
+
+// Argument record of the ExecuteIndirect path: the draw's root constants, then
+// D3D12_DISPATCH_MESH_ARGUMENTS. Same layout as the command signature in main.cpp and
+// DispatchMeshCommand in DrawCullCS.hlsl.
+struct DispatchMeshCommand
+{
+    uint32_t        meshletOffset;      // DrawConstants of MeshletCommon.hlsli
+    uint32_t        meshletCount;
+    MeshDescriptors descriptors;
+    uint32_t        threadGroupCountX;  // amplification shader groups
+    uint32_t        threadGroupCountY;
+    uint32_t        threadGroupCountZ;
+};
+static_assert(sizeof(DispatchMeshCommand) == 52, "DispatchMeshCommand must match the command signature.");
+
+// A run of meshlets the draw culling pass keeps or drops as a whole, with a sphere around all of
+// their bounding spheres. Same layout as MeshletDraw in DrawCullCS.hlsl.
+struct MeshletDraw
+{
+    Float3          center;
+    float           radius;
+    uint32_t        meshletOffset;
+    uint32_t        meshletCount;
+    MeshDescriptors descriptors;
+    uint32_t        padding[2];
+};
+static_assert(sizeof(MeshletDraw) == 64, "MeshletDraw must match the structured buffer in DrawCullCS.hlsl.");
+
+// CPU reference of the GPU driven draw path. DrawCullCS.hlsl frustum culls the draws and appends
+// the commands of the visible ones, ExecuteIndirect runs as many as the count buffer says. The CPU
+// records the same two calls per pass whatever the scene holds.
+class IndirectDraws
+{
+public:
+    static constexpr uint32_t GroupSize = 64;              // DRAW_CULL_GROUP_SIZE
+    static constexpr uint32_t MaxThreadGroups = 65535;     // per DispatchMesh dimension
+    // 32-bit root constants the command signature sets per draw, everything before the dispatch arguments
+    static constexpr uint32_t DrawConstantCount = offsetof(DispatchMeshCommand, threadGroupCountX) / sizeof(uint32_t);
+
+    // Splits meshlets into draws of meshletsPerDraw, a multiple of MeshletCulling::GroupSize so every
+    // draw starts on an amplification group boundary. Every draw reads the buffers of descriptors.
+    static std::vector<MeshletDraw> Build(const PackedMeshletBounds* bounds, uint32_t meshletCount, uint32_t meshletsPerDraw,
+                                          const MeshDescriptors& descriptors);
+
+    static DispatchMeshCommand Command(const MeshletDraw& draw);
+
+    // What DrawCullCS.hlsl writes, in draw order. The shader appends a wave at a time, so on the GPU
+    // the commands come in any order. Returns the count.
+    static uint32_t Compact(const Frustum& frustum, const MeshletDraw* draws, uint32_t drawCount, DispatchMeshCommand* commands);
+};
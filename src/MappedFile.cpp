@@ -0,0 +1,134 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open file: " + path.string());
+    }
+    _file = file;
+    _open = true;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        Close();
+        throw std::runtime_error("Cannot query size of file: " + path.string());
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+    if (_size == 0) {
+        return;
+    }
+
+    _mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping == nullptr) {
+        Close();
+        throw std::runtime_error("Cannot map file: " + path.string());
+    }
+    _data = static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr) {
+        Close();
+        throw std::runtime_error("Cannot map file: " + path.string());
+    }
+#else
+    _fd = open(path.c_str(), O_RDONLY);
+    if (_fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path.string());
+    }
+    _open = true;
+
+    struct stat info;
+    if (fstat(_fd, &info) != 0) {
+        Close();
+        throw std::runtime_error("Cannot query size of file: " + path.string());
+    }
+    _size = static_cast<size_t>(info.st_size);
+    if (_size == 0) {
+        return;
+    }
+
+    void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (data == MAP_FAILED) {
+        Close();
+        throw std::runtime_error("Cannot map file: " + path.string());
+    }
+    // We walk the whole file front to back, let the kernel read ahead aggressively.
+    madvise(data, _size, MADV_SEQUENTIAL);
+    _data = static_cast<const uint8_t*>(data);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    Swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        Close();
+        Swap(other);
+    }
+    return *this;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (_data) {
+        UnmapViewOfFile(_data);
+    }
+    if (_mapping) {
+        CloseHandle(_mapping);
+    }
+    if (_file) {
+        CloseHandle(_file);
+    }
+    _mapping = nullptr;
+    _file = nullptr;
+#else
+    if (_data) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+    if (_fd >= 0) {
+        close(_fd);
+    }
+    _fd = -1;
+#endif
+    _data = nullptr;
+    _size = 0;
+    _open = false;
+}
+
+void MappedFile::Swap(MappedFile& other) noexcept
+{
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+    std::swap(_open, other._open);
+#ifdef _WIN32
+    std::swap(_file, other._file);
+    std::swap(_mapping, other._mapping);
+#else
+    std::swap(_fd, other._fd);
+#endif
+}
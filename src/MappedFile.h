@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Read-only memory mapping of a whole file. Throws std::runtime_error when the file
+// can't be opened or mapped. Empty files are valid and map to a null range.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const uint8_t* Data() const { return _data; }
+    size_t Size() const { return _size; }
+    bool IsOpen() const { return _open; }
+
+    void Close();
+
+private:
+    void Swap(MappedFile& other) noexcept;
+
+    const uint8_t*  _data = nullptr;
+    size_t          _size = 0;
+    bool            _open = false;
+#ifdef _WIN32
+    void*           _file = nullptr;
+    void*           _mapping = nullptr;
+#else
+    int             _fd = -1;
+#endif
+};
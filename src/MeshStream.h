@@ -0,0 +1,47 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "ObjLoader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// Sequential access to a mesh that may not fit in memory. Callers read vertices and
+// triangles in batches; implementations are free to generate or page them in on demand.
+class MeshStream
+{
+public:
+    virtual ~MeshStream() = default;
+
+    virtual uint64_t VertexCount() const = 0;
+    virtual uint64_t TriangleCount() const = 0;
+
+    // Copies vertices [first, first + count)
+    virtual void ReadVertices(uint64_t first, size_t count, Vertex* vertices) = 0;
+    // Copies 3 * count indices of triangles [first, first + count)
+    virtual void ReadTriangles(uint64_t first, size_t count, uint32_t* indices) = 0;
+};
+
+// Adapter for meshes that are already in memory.
+class MemoryMeshStream : public MeshStream
+{
+public:
+    explicit MemoryMeshStream(const ObjMesh& mesh) : _mesh(mesh) {}
+
+    uint64_t VertexCount() const override { return _mesh.vertices.size(); }
+    uint64_t TriangleCount() const override { return _mesh.indices.size() / 3; }
+
+    void ReadVertices(uint64_t first, size_t count, Vertex* vertices) override
+    {
+        std::memcpy(vertices, _mesh.vertices.data() + first, count * sizeof(Vertex));
+    }
+
+    void ReadTriangles(uint64_t first, size_t count, uint32_t* indices) override
+    {
+        std::memcpy(indices, _mesh.indices.data() + first * 3, count * 3 * sizeof(uint32_t));
+    }
+
+private:
+    const ObjMesh& _mesh;
+};
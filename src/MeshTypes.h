@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+// Plain geometry types shared by the asset pipeline. They deliberately don't depend on
+// DirectXMath so the pipeline can be built and run without the Windows SDK.
+
+struct Float2
+{
+    float x, y;
+};
+
+struct Float3
+{
+    float x, y, z;
+};
+
+struct Float4
+{
+    float x, y, z, w;
+};
+
+// Same layout as WaveFrontReader::Vertex and the Vertex struct read by MeshletMS.hlsl
+struct Vertex
+{
+    Float3 position;
+    Float3 normal;
+    Float2 textureCoordinate;
+};
+static_assert(sizeof(Vertex) == 32, "Vertex must match the layout expected by the mesh shader.");
+
+// MeshletVertexFormat::Quantized vertex, QuantizedVertex in MeshletMS.hlsl. Positions are 16-bit
+// steps inside the meshlet's PositionBounds, the normal is octahedral snorm8x2 and the texture
+// coordinate is half2. See VertexQuantization.
+struct QuantizedVertex
+{
+    uint16_t position[3];
+    uint16_t normal;
+    uint16_t textureCoordinate[2];
+};
+static_assert(sizeof(QuantizedVertex) == 12, "QuantizedVertex must match the layout expected by the mesh shader.");
+
+// position = offset + scale * quantized position, one per meshlet
+struct PositionBounds
+{
+    Float3 offset;
+    Float3 scale;
+};
+
+// Same layout as DirectX::Meshlet and the Meshlet struct read by MeshletMS.hlsl
+struct Meshlet
+{
+    uint32_t VertCount;
+    uint32_t VertOffset;
+    uint32_t PrimCount;
+    uint32_t PrimOffset;
+};
+
+// Primitives are stored like DirectX::MeshletTriangle: three 10-bit meshlet local indices in one uint32.
+inline uint32_t PackTriangle(uint32_t i0, uint32_t i1, uint32_t i2)
+{
+    return (i0 & 0x3FF) | ((i1 & 0x3FF) << 10) | ((i2 & 0x3FF) << 20);
+}
+
+inline void UnpackTriangle(uint32_t packed, uint32_t& i0, uint32_t& i1, uint32_t& i2)
+{
+    i0 = packed & 0x3FF;
+    i1 = (packed >> 10) & 0x3FF;
+    i2 = (packed >> 20) & 0x3FF;
+}
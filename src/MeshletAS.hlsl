@@ -0,0 +1,118 @@
+// Two pass occlusion culling, compiled once per pass:
+// OCCLUSION_PASS 1, early: draws the meshlets in view that were visible last frame.
+// OCCLUSION_PASS 2, late: tests the meshlets in view against the depth pyramid of the early pass,
+// records the result for the next frame and draws the visible ones the early pass skipped.
+#include "MeshletCommon.hlsli"
+
+#ifndef OCCLUSION_PASS
+#define OCCLUSION_PASS 1
+#endif
+
+// Same layout as PackedMeshletBounds
+struct MeshletBounds
+{
+    float3 Center;
+    float  Radius;
+    uint   Cone;    // snorm8x3 axis, cutoff in the top byte
+    uint   Apex;    // low byte
+};
+
+// No root signature here, the pipeline uses the one of the mesh shader. The meshlet bounds come
+// from the descriptor heap, DrawConstants.Bounds.
+RWStructuredBuffer<uint>        Visibility  : register(u0);     // 1 when the meshlet was visible in the late pass
+Texture2D<float>                Hzb         : register(t8);     // DepthPyramid, built by HzbCS.hlsl
+
+groupshared Payload s_Payload;
+
+// Same as MeshletCulling::ConeVisible. The constants are 1 / 127 and 1 / 254 rounded to float.
+bool ConeVisible(MeshletBounds bounds)
+{
+    uint cutoffSteps = bounds.Cone >> 24;
+    if (cutoffSteps == 255)
+    {
+        return true;
+    }
+    precise float3 axis = float3(int3(bounds.Cone << uint3(24, 16, 8)) >> 24) * 0.00787401572f;
+    precise float cutoff = float(cutoffSteps) * 0.00393700786f;
+    precise float apexDistance = float(bounds.Apex & 0xFF) * (bounds.Radius * 0.0625f);
+
+    precise float3 view = bounds.Center - axis * apexDistance - Globals.CameraPosition;
+    precise float along = view.x * axis.x + view.y * axis.y + view.z * axis.z;
+    precise float lengthSquared = view.x * view.x + view.y * view.y + view.z * view.z;
+    return !(along > 0.0 && along * along >= cutoff * cutoff * lengthSquared);
+}
+
+// Same steps as DepthPyramid::SphereVisible. sqrt and division round differently on GPUs,
+// so this can disagree with the CPU for spheres right at a texel edge or depth.
+bool OcclusionVisible(float3 center, float radius)
+{
+    float3 c = mul(float4(center, 1), Globals.WorldView).xyz;
+    c.z = -c.z;
+    if (c.z - radius < Globals.Projection.z)
+    {
+        return true;
+    }
+
+    float czr2 = c.z * c.z - radius * radius;
+    float vx = sqrt(c.x * c.x + czr2);
+    float minX = (vx * c.x - c.z * radius) / (vx * c.z + c.x * radius);
+    float maxX = (vx * c.x + c.z * radius) / (vx * c.z - c.x * radius);
+    float vy = sqrt(c.y * c.y + czr2);
+    float minY = (vy * c.y - c.z * radius) / (vy * c.z + c.y * radius);
+    float maxY = (vy * c.y + c.z * radius) / (vy * c.z - c.y * radius);
+
+    float2 size = float2(Globals.DepthWidth, Globals.DepthHeight);
+    float4 uv = float4(minX * Globals.Projection.x * 0.5 + 0.5, maxY * Globals.Projection.y * -0.5 + 0.5,
+                       maxX * Globals.Projection.x * 0.5 + 0.5, minY * Globals.Projection.y * -0.5 + 0.5);
+    int2 p0 = int2(clamp(floor(uv.xy * size), 0, size - 1));
+    int2 p1 = int2(clamp(floor(uv.zw * size), 0, size - 1));
+
+    uint level = 0;
+    while (level + 1 < Globals.HzbLevels && any((p1 >> (level + 1)) - (p0 >> (level + 1)) > 1))
+    {
+        ++level;
+    }
+    int2 levelSize = max(int2(Globals.DepthWidth, Globals.DepthHeight) >> (level + 1), 1);
+    int2 t0 = min(p0 >> (level + 1), levelSize - 1);
+    int2 t1 = min(p1 >> (level + 1), levelSize - 1);
+
+    float farthest = 0;
+    for (int y = t0.y; y <= t1.y; ++y)
+    {
+        for (int x = t0.x; x <= t1.x; ++x)
+        {
+            farthest = max(farthest, Hzb.Load(int3(x, y, level)));
+        }
+    }
+
+    float nearestDepth = Globals.Projection.w + Globals.DepthScale / (c.z - radius);
+    return nearestDepth <= farthest;
+}
+
+[NumThreads(AS_GROUP_SIZE, 1, 1)]
+void main(uint dtid : SV_DispatchThreadID)
+{
+    bool visible = false;
+    uint meshlet = Draw.MeshletOffset + dtid;
+    if (dtid < Draw.MeshletCount)
+    {
+        StructuredBuffer<MeshletBounds> meshletBounds = ResourceDescriptorHeap[Draw.Bounds];
+        MeshletBounds bounds = meshletBounds[meshlet];
+        bool inView = SphereVisible(bounds.Center, bounds.Radius) && ConeVisible(bounds);
+#if OCCLUSION_PASS == 1
+        visible = inView && Visibility[meshlet] != 0;
+#else
+        // Meshlets of draws DrawCullCS.hlsl dropped keep their last result, it is only a hint
+        bool unoccluded = inView && OcclusionVisible(bounds.Center, bounds.Radius);
+        visible = unoccluded && Visibility[meshlet] == 0;
+        Visibility[meshlet] = unoccluded ? 1 : 0;
+#endif
+    }
+
+    if (visible)
+    {
+        s_Payload.MeshletIndices[WavePrefixCountBits(visible)] = meshlet;
+    }
+
+    DispatchMesh(WaveActiveCountBits(visible), 1, 1, s_Payload);
+}
@@ -0,0 +1,296 @@
+#include "MeshletBatchCulling.h"
+#include "MeshletBatchKernels.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MESHLET_BATCH_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define MESHLET_BATCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+MeshletCullingStreams MeshletCullingStreams::FromPacked(const PackedMeshletBounds* bounds, uint32_t count)
+{
+    const size_t padded = (size_t(count) + Padding - 1) / Padding * Padding;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+
+    MeshletCullingStreams streams;
+    streams.count = count;
+    for (std::vector<float>* stream : { &streams.centerX, &streams.centerY, &streams.centerZ, &streams.radius, &streams.apexX, &streams.apexY,
+                                        &streams.apexZ, &streams.axisX, &streams.axisY, &streams.axisZ, &streams.cutoffSquared }) {
+        stream->assign(padded, 0.f);
+    }
+    std::fill(streams.centerX.begin() + count, streams.centerX.end(), nan);
+    std::fill(streams.centerY.begin() + count, streams.centerY.end(), nan);
+    std::fill(streams.centerZ.begin() + count, streams.centerZ.end(), nan);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const PackedMeshletBounds& b = bounds[i];
+        streams.centerX[i] = b.center.x;
+        streams.centerY[i] = b.center.y;
+        streams.centerZ[i] = b.center.z;
+        streams.radius[i] = b.radius;
+        streams.apexX[i] = b.center.x;
+        streams.apexY[i] = b.center.y;
+        streams.apexZ[i] = b.center.z;
+        if (b.coneCutoff == PackedMeshletBounds::OpenCone) {
+            continue;
+        }
+
+        // Same steps as MeshletCulling::ConeVisible up to the camera
+        const Float3 axis = { b.coneAxis[0] * (1.f / 127.f), b.coneAxis[1] * (1.f / 127.f), b.coneAxis[2] * (1.f / 127.f) };
+        const float cutoff = b.coneCutoff * (1.f / 254.f);
+        const float apexDistance = b.coneApex * (b.radius * (1.f / 16.f));
+        streams.apexX[i] = b.center.x - axis.x * apexDistance;
+        streams.apexY[i] = b.center.y - axis.y * apexDistance;
+        streams.apexZ[i] = b.center.z - axis.z * apexDistance;
+        streams.axisX[i] = axis.x;
+        streams.axisY[i] = axis.y;
+        streams.axisZ[i] = axis.z;
+        streams.cutoffSquared[i] = cutoff * cutoff;
+    }
+    return streams;
+}
+
+namespace {
+
+#ifdef MESHLET_BATCH_X86
+bool CpuHasSse41()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] >> 19) & 1;
+#else
+    return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+bool CpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osSavesYmm = ((info[2] >> 27) & 1) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && ((info[1] >> 5) & 1);
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+// One lane at a time over the streams. The order of operations is MeshletCulling's, this file is
+// built without FMA contraction like MeshletCulling.cpp.
+uint32_t CullBatchScalar(const BatchCullingInput& in, uint32_t* visible)
+{
+    uint32_t written = 0;
+    for (uint32_t i = in.begin; i < in.end; ++i) {
+        bool inside = true;
+        for (const float (&plane)[4] : in.planes) {
+            const float distance = plane[0] * in.centerX[i] + plane[1] * in.centerY[i] + plane[2] * in.centerZ[i] + plane[3];
+            inside = inside && distance >= -in.radius[i];
+        }
+
+        const float viewX = in.apexX[i] - in.camera.x;
+        const float viewY = in.apexY[i] - in.camera.y;
+        const float viewZ = in.apexZ[i] - in.camera.z;
+        const float along = viewX * in.axisX[i] + viewY * in.axisY[i] + viewZ * in.axisZ[i];
+        const float lengthSquared = viewX * viewX + viewY * viewY + viewZ * viewZ;
+        const bool backFacing = along > 0.f && along * along >= in.cutoffSquared[i] * lengthSquared;
+
+        visible[written] = i;
+        written += inside && !backFacing;
+    }
+    return written;
+}
+
+#ifdef MESHLET_BATCH_NEON
+uint32_t CullBatchNeon(const BatchCullingInput& in, uint32_t* visible)
+{
+    const uint32x4_t laneBits = { 1, 2, 4, 8 };
+    float32x4_t planes[6][4];
+    for (int p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[p][c] = vdupq_n_f32(in.planes[p][c]);
+        }
+    }
+    const float32x4_t cameraX = vdupq_n_f32(in.camera.x);
+    const float32x4_t cameraY = vdupq_n_f32(in.camera.y);
+    const float32x4_t cameraZ = vdupq_n_f32(in.camera.z);
+    const float32x4_t zero = vdupq_n_f32(0.f);
+
+    uint32_t written = 0;
+    for (uint32_t i = in.begin; i < in.end; i += 4) {
+        const float32x4_t x = vld1q_f32(in.centerX + i);
+        const float32x4_t y = vld1q_f32(in.centerY + i);
+        const float32x4_t z = vld1q_f32(in.centerZ + i);
+        const float32x4_t negativeRadius = vnegq_f32(vld1q_f32(in.radius + i));
+
+        // No vmlaq, it may fuse and round differently from MeshletCulling
+        uint32x4_t inside = vdupq_n_u32(~0u);
+        for (const auto& plane : planes) {
+            const float32x4_t distance = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(plane[0], x), vmulq_f32(plane[1], y)), vmulq_f32(plane[2], z)), plane[3]);
+            inside = vandq_u32(inside, vcgeq_f32(distance, negativeRadius));
+        }
+
+        const float32x4_t viewX = vsubq_f32(vld1q_f32(in.apexX + i), cameraX);
+        const float32x4_t viewY = vsubq_f32(vld1q_f32(in.apexY + i), cameraY);
+        const float32x4_t viewZ = vsubq_f32(vld1q_f32(in.apexZ + i), cameraZ);
+        const float32x4_t along = vaddq_f32(vaddq_f32(vmulq_f32(viewX, vld1q_f32(in.axisX + i)), vmulq_f32(viewY, vld1q_f32(in.axisY + i))),
+                                            vmulq_f32(viewZ, vld1q_f32(in.axisZ + i)));
+        const float32x4_t lengthSquared = vaddq_f32(vaddq_f32(vmulq_f32(viewX, viewX), vmulq_f32(viewY, viewY)), vmulq_f32(viewZ, viewZ));
+        const uint32x4_t backFacing = vandq_u32(vcgtq_f32(along, zero),
+                                                vcgeq_f32(vmulq_f32(along, along), vmulq_f32(vld1q_f32(in.cutoffSquared + i), lengthSquared)));
+
+        const uint32_t mask = vaddvq_u32(vandq_u32(vbicq_u32(inside, backFacing), laneBits));
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            visible[written] = i + lane;
+            written += (mask >> lane) & 1;
+        }
+    }
+    return written;
+}
+#endif
+
+} // namespace
+
+bool MeshletBatchCulling::Supported(CullingKernel kernel)
+{
+    switch (kernel) {
+    case CullingKernel::Scalar:
+        return true;
+#ifdef MESHLET_BATCH_X86
+    case CullingKernel::Sse41:
+        return CpuHasSse41();
+    case CullingKernel::Avx2:
+        return CpuHasAvx2();
+#endif
+#ifdef MESHLET_BATCH_NEON
+    case CullingKernel::Neon:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+CullingKernel MeshletBatchCulling::Best()
+{
+    for (const CullingKernel kernel : { CullingKernel::Avx2, CullingKernel::Neon, CullingKernel::Sse41 }) {
+        if (Supported(kernel)) {
+            return kernel;
+        }
+    }
+    return CullingKernel::Scalar;
+}
+
+const char* MeshletBatchCulling::Name(CullingKernel kernel)
+{
+    switch (kernel) {
+    case CullingKernel::Scalar: return "scalar";
+    case CullingKernel::Sse41: return "sse4.1";
+    case CullingKernel::Avx2: return "avx2";
+    case CullingKernel::Neon: return "neon";
+    default: return "unknown";
+    }
+}
+
+uint32_t MeshletBatchCulling::Cull(CullingKernel kernel, const Frustum& frustum, const Float3& camera, const MeshletCullingStreams& streams,
+                                   uint32_t begin, uint32_t end, uint32_t* visible)
+{
+    const uint32_t padding = MeshletCullingStreams::Padding;
+    if (begin > end || end > streams.count || begin % padding != 0 || (end % padding != 0 && end != streams.count)) {
+        throw std::out_of_range("Batch culling range must be padding aligned and inside the streams");
+    }
+    if (!Supported(kernel)) {
+        throw std::runtime_error(std::string("Culling kernel ") + Name(kernel) + " is not available on this CPU");
+    }
+
+    BatchCullingInput input;
+    input.centerX = streams.centerX.data();
+    input.centerY = streams.centerY.data();
+    input.centerZ = streams.centerZ.data();
+    input.radius = streams.radius.data();
+    input.apexX = streams.apexX.data();
+    input.apexY = streams.apexY.data();
+    input.apexZ = streams.apexZ.data();
+    input.axisX = streams.axisX.data();
+    input.axisY = streams.axisY.data();
+    input.axisZ = streams.axisZ.data();
+    input.cutoffSquared = streams.cutoffSquared.data();
+    for (int p = 0; p < 6; ++p) {
+        const Plane& plane = frustum.planes[p];
+        input.planes[p][0] = plane.normal.x;
+        input.planes[p][1] = plane.normal.y;
+        input.planes[p][2] = plane.normal.z;
+        input.planes[p][3] = plane.distance;
+    }
+    input.camera = camera;
+    input.begin = begin;
+    input.end = (end + padding - 1) / padding * padding;
+
+    switch (kernel) {
+#ifdef MESHLET_BATCH_X86
+    case CullingKernel::Sse41:
+        return CullBatchSse41(input, visible);
+    case CullingKernel::Avx2:
+        return CullBatchAvx2(input, visible);
+#endif
+#ifdef MESHLET_BATCH_NEON
+    case CullingKernel::Neon:
+        return CullBatchNeon(input, visible);
+#endif
+    default:
+        return CullBatchScalar(input, visible);
+    }
+}
+
+MeshletBatchCuller::MeshletBatchCuller(CullingKernel kernel, unsigned threadCount)
+    : _kernel(kernel), _threadCount(threadCount)
+{
+}
+
+const std::vector<uint32_t>& MeshletBatchCuller::Cull(const Frustum& frustum, const Float3& camera, const MeshletCullingStreams& streams)
+{
+    const size_t chunks = (size_t(streams.count) + ChunkMeshlets - 1) / ChunkMeshlets;
+    _chunkVisible.resize(streams.centerX.size());
+    _chunkCounts.resize(chunks);
+    ParallelFor(chunks, _threadCount, [&](size_t chunk)
+    {
+        const uint32_t begin = static_cast<uint32_t>(chunk * ChunkMeshlets);
+        const uint32_t end = std::min(streams.count, begin + ChunkMeshlets);
+        _chunkCounts[chunk] = MeshletBatchCulling::Cull(_kernel, frustum, camera, streams, begin, end, _chunkVisible.data() + begin);
+    });
+
+    // Exclusive prefix sum, then every chunk copies its list into place
+    uint32_t total = 0;
+    for (uint32_t& count : _chunkCounts) {
+        const uint32_t chunkCount = count;
+        count = total;
+        total += chunkCount;
+    }
+    _visible.resize(total);
+    ParallelFor(chunks, _threadCount, [&](size_t chunk)
+    {
+        const uint32_t offset = _chunkCounts[chunk];
+        const uint32_t next = chunk + 1 < chunks ? _chunkCounts[chunk + 1] : total;
+        const uint32_t* source = _chunkVisible.data() + chunk * ChunkMeshlets;
+        std::copy(source, source + (next - offset), _visible.data() + offset);
+    });
+    return _visible;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "MeshletCulling.h"
+
+#include <cstdint>
+#include <vector>
+
+// PackedMeshletBounds decoded into one array per value for the SIMD kernels. The cone is decoded the
+// way MeshletCulling::ConeVisible does it, with the apex folded into a point and open cones turned
+// into a zero axis, so every kernel agrees with MeshletCulling::Visible bit for bit.
+//
+// The arrays are padded to a multiple of Padding with NaN spheres, which no frustum accepts.
+struct MeshletCullingStreams
+{
+    static constexpr uint32_t Padding = 8;      // lanes of the widest kernel
+
+    uint32_t            count = 0;
+    std::vector<float>  centerX, centerY, centerZ, radius;
+    std::vector<float>  apexX, apexY, apexZ;
+    std::vector<float>  axisX, axisY, axisZ;
+    std::vector<float>  cutoffSquared;
+
+    static MeshletCullingStreams FromPacked(const PackedMeshletBounds* bounds, uint32_t count);
+};
+
+enum class CullingKernel : uint32_t
+{
+    Scalar  = 0,
+    Sse41   = 1,    // 4 lanes
+    Avx2    = 2,    // 8 lanes
+    Neon    = 3,    // 4 lanes
+};
+
+// CPU path of the amplification shader's frustum and cone culling, for when there is no
+// amplification shader or to debug it. Only the kernels of the build target are compiled, the
+// x86 ones are picked at runtime.
+class MeshletBatchCulling
+{
+public:
+    static bool Supported(CullingKernel kernel);
+    static CullingKernel Best();
+    static const char* Name(CullingKernel kernel);
+
+    // Appends the meshlets in [begin, end) that pass MeshletCulling::Visible to visible, ascending,
+    // and returns how many. begin is a multiple of MeshletCullingStreams::Padding and so is end unless
+    // it is streams.count. visible needs room for end - begin rounded up to the padding.
+    static uint32_t Cull(CullingKernel kernel, const Frustum& frustum, const Float3& camera, const MeshletCullingStreams& streams,
+                         uint32_t begin, uint32_t end, uint32_t* visible);
+};
+
+// Multi-threaded MeshletBatchCulling over whole streams. Keeps its buffers between frames.
+class MeshletBatchCuller
+{
+public:
+    static constexpr uint32_t ChunkMeshlets = 1 << 14;
+
+    // threadCount 0 means all cores
+    explicit MeshletBatchCuller(CullingKernel kernel = MeshletBatchCulling::Best(), unsigned threadCount = 0);
+
+    // Same list as MeshletCulling::Cull, valid until the next call. Chunks are culled independently
+    // and stitched in order, so the result doesn't depend on the thread count.
+    const std::vector<uint32_t>& Cull(const Frustum& frustum, const Float3& camera, const MeshletCullingStreams& streams);
+
+private:
+    CullingKernel           _kernel;
+    unsigned                _threadCount;
+    std::vector<uint32_t>   _chunkVisible;      // every chunk's list at the chunk's offset
+    std::vector<uint32_t>   _chunkCounts;
+    std::vector<uint32_t>   _visible;
+};
@@ -0,0 +1,54 @@
+// Built with AVX2 enabled, only called after MeshletBatchCulling::Supported checked the CPU.
+#include "MeshletBatchKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+
+uint32_t CullBatchAvx2(const BatchCullingInput& in, uint32_t* visible)
+{
+    __m256 planes[6][4];
+    for (int p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[p][c] = _mm256_set1_ps(in.planes[p][c]);
+        }
+    }
+    const __m256 cameraX = _mm256_set1_ps(in.camera.x);
+    const __m256 cameraY = _mm256_set1_ps(in.camera.y);
+    const __m256 cameraZ = _mm256_set1_ps(in.camera.z);
+    const __m256 signBit = _mm256_set1_ps(-0.f);
+    const __m256 allSet = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    const __m256 zero = _mm256_setzero_ps();
+
+    uint32_t written = 0;
+    for (uint32_t i = in.begin; i < in.end; i += 8) {
+        const __m256 x = _mm256_loadu_ps(in.centerX + i);
+        const __m256 y = _mm256_loadu_ps(in.centerY + i);
+        const __m256 z = _mm256_loadu_ps(in.centerZ + i);
+        const __m256 negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(in.radius + i), signBit);
+
+        // No FMA, it would round differently from MeshletCulling
+        __m256 inside = allSet;
+        for (const auto& plane : planes) {
+            const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane[0], x), _mm256_mul_ps(plane[1], y)),
+                                                                _mm256_mul_ps(plane[2], z)), plane[3]);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+
+        const __m256 viewX = _mm256_sub_ps(_mm256_loadu_ps(in.apexX + i), cameraX);
+        const __m256 viewY = _mm256_sub_ps(_mm256_loadu_ps(in.apexY + i), cameraY);
+        const __m256 viewZ = _mm256_sub_ps(_mm256_loadu_ps(in.apexZ + i), cameraZ);
+        const __m256 along = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(viewX, _mm256_loadu_ps(in.axisX + i)), _mm256_mul_ps(viewY, _mm256_loadu_ps(in.axisY + i))),
+                                           _mm256_mul_ps(viewZ, _mm256_loadu_ps(in.axisZ + i)));
+        const __m256 lengthSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(viewX, viewX), _mm256_mul_ps(viewY, viewY)), _mm256_mul_ps(viewZ, viewZ));
+        const __m256 backFacing = _mm256_and_ps(_mm256_cmp_ps(along, zero, _CMP_GT_OQ),
+                                                _mm256_cmp_ps(_mm256_mul_ps(along, along), _mm256_mul_ps(_mm256_loadu_ps(in.cutoffSquared + i), lengthSquared), _CMP_GE_OQ));
+
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_andnot_ps(backFacing, inside)));
+        for (uint32_t lane = 0; lane < 8; ++lane) {
+            visible[written] = i + lane;
+            written += (mask >> lane) & 1;
+        }
+    }
+    return written;
+}
+#endif
@@ -0,0 +1,52 @@
+// Built with SSE4.1 enabled, only called after MeshletBatchCulling::Supported checked the CPU.
+#include "MeshletBatchKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <smmintrin.h>
+
+uint32_t CullBatchSse41(const BatchCullingInput& in, uint32_t* visible)
+{
+    __m128 planes[6][4];
+    for (int p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[p][c] = _mm_set1_ps(in.planes[p][c]);
+        }
+    }
+    const __m128 cameraX = _mm_set1_ps(in.camera.x);
+    const __m128 cameraY = _mm_set1_ps(in.camera.y);
+    const __m128 cameraZ = _mm_set1_ps(in.camera.z);
+    const __m128 signBit = _mm_set1_ps(-0.f);
+    const __m128 allSet = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    const __m128 zero = _mm_setzero_ps();
+
+    uint32_t written = 0;
+    for (uint32_t i = in.begin; i < in.end; i += 4) {
+        const __m128 x = _mm_loadu_ps(in.centerX + i);
+        const __m128 y = _mm_loadu_ps(in.centerY + i);
+        const __m128 z = _mm_loadu_ps(in.centerZ + i);
+        const __m128 negativeRadius = _mm_xor_ps(_mm_loadu_ps(in.radius + i), signBit);
+
+        __m128 inside = allSet;
+        for (const auto& plane : planes) {
+            const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(plane[0], x), _mm_mul_ps(plane[1], y)), _mm_mul_ps(plane[2], z)), plane[3]);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        const __m128 viewX = _mm_sub_ps(_mm_loadu_ps(in.apexX + i), cameraX);
+        const __m128 viewY = _mm_sub_ps(_mm_loadu_ps(in.apexY + i), cameraY);
+        const __m128 viewZ = _mm_sub_ps(_mm_loadu_ps(in.apexZ + i), cameraZ);
+        const __m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(viewX, _mm_loadu_ps(in.axisX + i)), _mm_mul_ps(viewY, _mm_loadu_ps(in.axisY + i))),
+                                        _mm_mul_ps(viewZ, _mm_loadu_ps(in.axisZ + i)));
+        const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(viewX, viewX), _mm_mul_ps(viewY, viewY)), _mm_mul_ps(viewZ, viewZ));
+        const __m128 backFacing = _mm_and_ps(_mm_cmpgt_ps(along, zero),
+                                             _mm_cmpge_ps(_mm_mul_ps(along, along), _mm_mul_ps(_mm_loadu_ps(in.cutoffSquared + i), lengthSquared)));
+
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_andnot_ps(backFacing, inside)));
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            visible[written] = i + lane;
+            written += (mask >> lane) & 1;
+        }
+    }
+    return written;
+}
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+#include <cstdint>
+
+// Internal to MeshletBatchCulling. The SIMD kernels live in translation units built with their
+// instruction set enabled, so they only see plain data here: any inline function they instantiated
+// could be picked by the linker for the rest of the program too.
+struct BatchCullingInput
+{
+    const float*    centerX;
+    const float*    centerY;
+    const float*    centerZ;
+    const float*    radius;
+    const float*    apexX;
+    const float*    apexY;
+    const float*    apexZ;
+    const float*    axisX;
+    const float*    axisY;
+    const float*    axisZ;
+    const float*    cutoffSquared;
+    float           planes[6][4];   // normal, distance
+    Float3          camera;
+    uint32_t        begin;
+    uint32_t        end;            // multiple of MeshletCullingStreams::Padding
+};
+
+uint32_t CullBatchSse41(const BatchCullingInput& input, uint32_t* visible);
+uint32_t CullBatchAvx2(const BatchCullingInput& input, uint32_t* visible);
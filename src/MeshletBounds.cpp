@@ -0,0 +1,214 @@
+#include "MeshletBounds.h"
+
+#include "Parallel.h"
+#include "VectorMath.h"
+
+#include <cfloat>
+
+namespace {
+
+// Ritter's bounding sphere: start from the most distant pair of axis extremes, grow to cover the rest.
+void BoundingSphere(const Float3* points, size_t count, Float3& center, float& radius)
+{
+    if (count == 0) {
+        center = {};
+        radius = 0.f;
+        return;
+    }
+
+    size_t minIndex[3] = {};
+    size_t maxIndex[3] = {};
+    for (size_t i = 1; i < count; ++i) {
+        const float* p = &points[i].x;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (p[axis] < (&points[minIndex[axis]].x)[axis]) {
+                minIndex[axis] = i;
+            }
+            if (p[axis] > (&points[maxIndex[axis]].x)[axis]) {
+                maxIndex[axis] = i;
+            }
+        }
+    }
+
+    int widest = 0;
+    float widestDistance = -1.f;
+    for (int axis = 0; axis < 3; ++axis) {
+        const Float3 span = points[maxIndex[axis]] - points[minIndex[axis]];
+        if (Dot(span, span) > widestDistance) {
+            widestDistance = Dot(span, span);
+            widest = axis;
+        }
+    }
+
+    center = (points[minIndex[widest]] + points[maxIndex[widest]]) * 0.5f;
+    radius = std::sqrt(widestDistance) * 0.5f;
+
+    for (size_t i = 0; i < count; ++i) {
+        const float distance = Length(points[i] - center);
+        if (distance > radius) {
+            const float grownRadius = (radius + distance) * 0.5f;
+            center = center + (points[i] - center) * ((grownRadius - radius) / distance);
+            radius = grownRadius;
+        }
+    }
+}
+
+const Float3& MeshletPosition(const Meshlet& meshlet, const MeshletData& data, const Float3* positions, size_t positionStride, uint32_t local)
+{
+    const uint32_t vertex = data.uniqueVertexIndices[meshlet.VertOffset + local];
+    return *reinterpret_cast<const Float3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * positionStride);
+}
+
+// Unit normal and one corner of every triangle. Degenerate triangles are skipped.
+void TriangleNormals(const Meshlet& meshlet, const MeshletData& data, const Float3* positions, size_t positionStride,
+                     std::vector<Float3>& normals, std::vector<Float3>& corners)
+{
+    normals.clear();
+    corners.clear();
+    for (uint32_t p = 0; p < meshlet.PrimCount; ++p) {
+        uint32_t i0, i1, i2;
+        UnpackTriangle(data.primitiveIndices[meshlet.PrimOffset + p], i0, i1, i2);
+        const Float3& a = MeshletPosition(meshlet, data, positions, positionStride, i0);
+        const Float3 normal = Cross(MeshletPosition(meshlet, data, positions, positionStride, i1) - a,
+                                    MeshletPosition(meshlet, data, positions, positionStride, i2) - a);
+        const float area = Length(normal);
+        if (area <= FLT_MIN) {
+            continue;
+        }
+        normals.push_back(normal * (1.f / area));
+        corners.push_back(a);
+    }
+}
+
+} // namespace
+
+MeshletBounds MeshletBoundsBuilder::Compute(const Meshlet& meshlet, const MeshletData& data, const Float3* positions, size_t positionStride)
+{
+    auto position = [&](uint32_t local) -> const Float3&
+    {
+        return MeshletPosition(meshlet, data, positions, positionStride, local);
+    };
+
+    MeshletBounds bounds = {};
+
+    std::vector<Float3> points(meshlet.VertCount);
+    for (uint32_t i = 0; i < meshlet.VertCount; ++i) {
+        points[i] = position(i);
+    }
+    BoundingSphere(points.data(), points.size(), bounds.center, bounds.radius);
+
+    // Cone axis is the average triangle normal. Degenerate triangles don't vote.
+    std::vector<Float3> normals;
+    std::vector<Float3> corners;
+    TriangleNormals(meshlet, data, positions, positionStride, normals, corners);
+    const size_t normalCount = normals.size();
+    Float3 axis = {};
+    for (const Float3& normal : normals) {
+        axis = axis + normal;
+    }
+    axis = Normalize(axis);
+
+    float minDot = 1.f;
+    for (size_t i = 0; i < normalCount; ++i) {
+        minDot = std::min(minDot, Dot(axis, normals[i]));
+    }
+
+    bounds.coneAxis = axis;
+    bounds.coneApex = bounds.center;
+    if (normalCount == 0 || minDot <= 0.f) {
+        // Normals span more than a hemisphere, the cone can't reject anything
+        bounds.coneCutoff = 2.f;
+        return bounds;
+    }
+    bounds.coneCutoff = std::sqrt(1.f - minDot * minDot);
+
+    // Move the apex back along the axis until it's behind every triangle plane, so the test is
+    // conservative for cameras close to the meshlet as well.
+    float maxT = 0.f;
+    for (size_t i = 0; i < normalCount; ++i) {
+        const float t = Dot(bounds.center - corners[i], normals[i]) / Dot(axis, normals[i]);
+        maxT = std::max(maxT, t);
+    }
+    bounds.coneApex = bounds.center - axis * maxT;
+    return bounds;
+}
+
+std::vector<MeshletBounds> MeshletBoundsBuilder::Compute(const MeshletData& data, const Float3* positions, size_t positionStride, unsigned threadCount)
+{
+    std::vector<MeshletBounds> bounds(data.meshlets.size());
+    const size_t batch = 1024;
+    ParallelFor((bounds.size() + batch - 1) / batch, threadCount, [&](size_t block) {
+        const size_t end = std::min(bounds.size(), (block + 1) * batch);
+        for (size_t i = block * batch; i < end; ++i) {
+            bounds[i] = Compute(data.meshlets[i], data, positions, positionStride);
+        }
+    });
+    return bounds;
+}
+
+PackedMeshletBounds MeshletBoundsBuilder::Pack(const MeshletBounds& bounds, const Meshlet& meshlet, const MeshletData& data, const Float3* positions,
+                                               size_t positionStride)
+{
+    PackedMeshletBounds packed = {};
+    packed.center = bounds.center;
+    packed.radius = bounds.radius;
+    packed.coneCutoff = PackedMeshletBounds::OpenCone;
+    if (bounds.coneCutoff > 1.f || bounds.radius <= 0.f) {
+        return packed;
+    }
+
+    // Truncated, so the decoded axis is never longer than 1
+    const float* axis = &bounds.coneAxis.x;
+    for (int i = 0; i < 3; ++i) {
+        packed.coneAxis[i] = static_cast<int8_t>(axis[i] * 127.f);
+    }
+    const Float3 quantizedAxis = { packed.coneAxis[0] * (1.f / 127.f), packed.coneAxis[1] * (1.f / 127.f), packed.coneAxis[2] * (1.f / 127.f) };
+    const float axisLength = Length(quantizedAxis);
+    if (axisLength <= 0.f) {
+        return packed;
+    }
+
+    std::vector<Float3> normals;
+    std::vector<Float3> corners;
+    TriangleNormals(meshlet, data, positions, positionStride, normals, corners);
+
+    // Same as Compute, around the quantized axis. The test compares against the unnormalized axis,
+    // so the cutoff is scaled by its length.
+    float minDot = 1.f;
+    for (const Float3& normal : normals) {
+        minDot = std::min(minDot, Dot(quantizedAxis, normal) / axisLength);
+    }
+    if (normals.empty() || minDot <= 0.f) {
+        return packed;
+    }
+    const float cutoff = std::sqrt(1.f - minDot * minDot) * axisLength;
+
+    float maxT = 0.f;
+    for (size_t i = 0; i < normals.size(); ++i) {
+        maxT = std::max(maxT, Dot(bounds.center - corners[i], normals[i]) / Dot(quantizedAxis, normals[i]));
+    }
+
+    // Both round up: a larger cutoff culls less, an apex further back stays behind every triangle
+    const float cutoffSteps = std::floor(cutoff * 254.f) + 1.f;
+    const float apexSteps = std::floor(maxT / (bounds.radius * (1.f / 16.f))) + 1.f;
+    if (cutoffSteps >= PackedMeshletBounds::OpenCone || apexSteps > 255.f) {
+        return packed;
+    }
+    packed.coneCutoff = static_cast<uint8_t>(cutoffSteps);
+    packed.coneApex = static_cast<uint8_t>(apexSteps);
+    return packed;
+}
+
+std::vector<PackedMeshletBounds> MeshletBoundsBuilder::Pack(const std::vector<MeshletBounds>& bounds, const MeshletData& data, const Float3* positions,
+                                                            size_t positionStride, unsigned threadCount)
+{
+    std::vector<PackedMeshletBounds> packed(bounds.size());
+    const size_t batch = 1024;
+    ParallelFor((packed.size() + batch - 1) / batch, threadCount, [&](size_t block) {
+        const size_t end = std::min(packed.size(), (block + 1) * batch);
+        for (size_t i = block * batch; i < end; ++i) {
+            packed[i] = Pack(bounds[i], data.meshlets[i], data, positions, positionStride);
+        }
+    });
+    return packed;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "MeshletBuilder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Culling data of one meshlet.
+//
+// The meshlet faces away from a camera at P, and can be skipped, when
+// dot(normalize(coneApex - P), coneAxis) >= coneCutoff. The cutoff is the sine of the angle between
+// the axis and the farthest triangle normal. It's above 1 when the normals spread too far for the
+// cone to ever cull.
+struct MeshletBounds
+{
+    Float3  center;
+    float   radius;
+    Float3  coneApex;
+    Float3  coneAxis;
+    float   coneCutoff;     // sin of the normal spread angle
+};
+
+// MeshletBounds as the amplification shader reads them, 24 instead of 44 bytes. The cone is 8-bit:
+//   axis = coneAxis / 127 (not normalized), cutoff = coneCutoff / 254, apex = center - axis * coneApex * radius / 16
+// Quantization rounds toward not culling, the packed test only rejects meshlets whose triangles all
+// face away. See MeshletCulling::ConeVisible for the test itself.
+struct PackedMeshletBounds
+{
+    static constexpr uint8_t OpenCone = 255;    // coneCutoff of cones that can't cull
+
+    Float3  center;
+    float   radius;
+    int8_t  coneAxis[3];
+    uint8_t coneCutoff;
+    uint8_t coneApex;
+    uint8_t padding[3];
+};
+static_assert(sizeof(PackedMeshletBounds) == 24, "PackedMeshletBounds must match the layout expected by the amplification shader.");
+
+class MeshletBoundsBuilder
+{
+public:
+    static MeshletBounds Compute(const Meshlet& meshlet, const MeshletData& data, const Float3* positions, size_t positionStride = sizeof(Float3));
+
+    static std::vector<MeshletBounds> Compute(const MeshletData& data, const Float3* positions, size_t positionStride = sizeof(Float3), unsigned threadCount = 0);
+
+    // Quantizes the cone of bounds. Needs the triangles again, the cutoff and apex are recomputed
+    // for the quantized axis.
+    static PackedMeshletBounds Pack(const MeshletBounds& bounds, const Meshlet& meshlet, const MeshletData& data, const Float3* positions,
+                                    size_t positionStride = sizeof(Float3));
+
+    static std::vector<PackedMeshletBounds> Pack(const std::vector<MeshletBounds>& bounds, const MeshletData& data, const Float3* positions,
+                                                 size_t positionStride = sizeof(Float3), unsigned threadCount = 0);
+};
@@ -0,0 +1,426 @@
+#include "MeshletBuilder.h"
+
+#include "Parallel.h"
+#include "SpaceFillingCurve.h"
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint32_t NoIndex = ~0u;
+
+}
+
+MeshletData MeshletBuilder::Build(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t maxVertices, uint32_t maxPrimitives)
+{
+    if (maxVertices < 3 || maxVertices > 256 || maxPrimitives < 1 || maxPrimitives > 256) {
+        throw std::invalid_argument("MeshletBuilder: limits must be within [3, 256] vertices and [1, 256] primitives");
+    }
+
+    MeshletData data;
+    data.meshlets.reserve(indexCount / 3 / maxPrimitives + 1);
+    data.uniqueVertexIndices.reserve(indexCount / 3);
+    data.primitiveIndices.reserve(indexCount / 3);
+
+    // Mesh vertex -> local index in the meshlet being built
+    std::vector<uint32_t> localIndex(vertexCount, NoIndex);
+    Meshlet current = {};
+
+    auto flush = [&]()
+    {
+        if (current.PrimCount == 0) {
+            return;
+        }
+        for (uint32_t i = 0; i < current.VertCount; ++i) {
+            localIndex[data.uniqueVertexIndices[current.VertOffset + i]] = NoIndex;
+        }
+        data.meshlets.push_back(current);
+        current = {};
+        current.VertOffset = static_cast<uint32_t>(data.uniqueVertexIndices.size());
+        current.PrimOffset = static_cast<uint32_t>(data.primitiveIndices.size());
+    };
+
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        const uint32_t triangle[3] = { indices[i], indices[i + 1], indices[i + 2] };
+        if (triangle[0] >= vertexCount || triangle[1] >= vertexCount || triangle[2] >= vertexCount) {
+            throw std::out_of_range("MeshletBuilder: index out of range");
+        }
+
+        uint32_t newVertices = 0;
+        for (int corner = 0; corner < 3; ++corner) {
+            const bool repeated = (corner > 0 && triangle[corner] == triangle[0]) || (corner > 1 && triangle[corner] == triangle[1]);
+            newVertices += localIndex[triangle[corner]] == NoIndex && !repeated;
+        }
+        if (current.VertCount + newVertices > maxVertices || current.PrimCount + 1 > maxPrimitives) {
+            flush();
+        }
+
+        uint32_t local[3];
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t& slot = localIndex[triangle[corner]];
+            if (slot == NoIndex) {
+                slot = current.VertCount++;
+                data.uniqueVertexIndices.push_back(triangle[corner]);
+            }
+            local[corner] = slot;
+        }
+        data.primitiveIndices.push_back(PackTriangle(local[0], local[1], local[2]));
+        ++current.PrimCount;
+    }
+    flush();
+
+    return data;
+}
+
+MeshletData MeshletBuilder::BuildSubset(const uint32_t* indices, size_t indexCount, uint32_t maxVertices, uint32_t maxPrimitives)
+{
+    // Open addressing table: mesh vertex -> dense id in order of first use
+    size_t capacity = 64;
+    while (capacity < indexCount * 2) {
+        capacity *= 2;
+    }
+    const size_t mask = capacity - 1;
+    std::vector<uint32_t> slotVertex(capacity, NoIndex);
+    std::vector<uint32_t> slotLocal(capacity);
+
+    std::vector<uint32_t> vertices;
+    std::vector<uint32_t> localIndices(indexCount);
+    for (size_t i = 0; i < indexCount; ++i) {
+        const uint32_t vertex = indices[i];
+        size_t slot = (vertex * 0x9E3779B1u) & mask;
+        while (slotVertex[slot] != vertex && slotVertex[slot] != NoIndex) {
+            slot = (slot + 1) & mask;
+        }
+        if (slotVertex[slot] == NoIndex) {
+            slotVertex[slot] = vertex;
+            slotLocal[slot] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(vertex);
+        }
+        localIndices[i] = slotLocal[slot];
+    }
+
+    MeshletData data = Build(localIndices.data(), indexCount, vertices.size(), maxVertices, maxPrimitives);
+    for (uint32_t& index : data.uniqueVertexIndices) {
+        index = vertices[index];
+    }
+    return data;
+}
+
+MeshletData MeshletBuilder::BuildParallel(const uint32_t* indices, size_t indexCount, const Float3* positions, size_t vertexCount,
+                                          uint32_t maxVertices, uint32_t maxPrimitives, unsigned threadCount, size_t positionStride)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount >= NoIndex) {
+        throw std::out_of_range("MeshletBuilder: too many triangles");
+    }
+    auto position = [&](uint32_t vertex) -> const Float3&
+    {
+        return *reinterpret_cast<const Float3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * positionStride);
+    };
+
+    const size_t blockSize = size_t(1) << 16;
+    const size_t blockCount = (triangleCount + blockSize - 1) / blockSize;
+
+    // Bounds
+    std::vector<Float3> blockMin(blockCount);
+    std::vector<Float3> blockMax(blockCount);
+    ParallelFor(blockCount, threadCount, [&](size_t block) {
+        Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+        Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        const size_t end = std::min(triangleCount, (block + 1) * blockSize) * 3;
+        for (size_t i = block * blockSize * 3; i < end; ++i) {
+            if (indices[i] >= vertexCount) {
+                throw std::out_of_range("MeshletBuilder: index out of range");
+            }
+            const Float3& p = position(indices[i]);
+            lo = Float3{ std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z) };
+            hi = Float3{ std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z) };
+        }
+        blockMin[block] = lo;
+        blockMax[block] = hi;
+    });
+    Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (size_t block = 0; block < blockCount; ++block) {
+        lo = Float3{ std::min(lo.x, blockMin[block].x), std::min(lo.y, blockMin[block].y), std::min(lo.z, blockMin[block].z) };
+        hi = Float3{ std::max(hi.x, blockMax[block].x), std::max(hi.y, blockMax[block].y), std::max(hi.z, blockMax[block].z) };
+    }
+    const float extent = std::max({ hi.x - lo.x, hi.y - lo.y, hi.z - lo.z, 1e-20f });
+    const float scale = 1023.f / extent;
+
+    // Sort keys: 30-bit Morton code of the centroid, triangle index as tie breaker
+    std::vector<uint64_t> keys(triangleCount);
+    ParallelFor(blockCount, threadCount, [&](size_t block) {
+        const size_t end = std::min(triangleCount, (block + 1) * blockSize);
+        for (size_t t = block * blockSize; t < end; ++t) {
+            const Float3& a = position(indices[t * 3]);
+            const Float3& b = position(indices[t * 3 + 1]);
+            const Float3& c = position(indices[t * 3 + 2]);
+            const Float3 centroid = { (a.x + b.x + c.x) / 3.f, (a.y + b.y + c.y) / 3.f, (a.z + b.z + c.z) / 3.f };
+            const uint32_t morton = MortonCode(
+                static_cast<uint32_t>(std::clamp((centroid.x - lo.x) * scale, 0.f, 1023.f)),
+                static_cast<uint32_t>(std::clamp((centroid.y - lo.y) * scale, 0.f, 1023.f)),
+                static_cast<uint32_t>(std::clamp((centroid.z - lo.z) * scale, 0.f, 1023.f)));
+            keys[t] = (uint64_t(morton) << 32) | t;
+        }
+    });
+
+    // Stable LSD radix sort on the 30 Morton bits, three 10-bit digits. Every pass counts digits per
+    // block, turns the counts into scatter offsets and scatters the blocks in parallel.
+    const size_t digitCount = 1 << 10;
+    std::vector<uint64_t> sorted(triangleCount);
+    std::vector<uint32_t> offsets(blockCount * digitCount);
+    for (int shift = 32; shift < 62; shift += 10) {
+        auto digitOf = [shift](uint64_t key) { return static_cast<size_t>((key >> shift) & 0x3FF); };
+
+        std::fill(offsets.begin(), offsets.end(), 0);
+        ParallelFor(blockCount, threadCount, [&](size_t block) {
+            uint32_t* histogram = &offsets[block * digitCount];
+            const size_t end = std::min(triangleCount, (block + 1) * blockSize);
+            for (size_t t = block * blockSize; t < end; ++t) {
+                ++histogram[digitOf(keys[t])];
+            }
+        });
+        size_t offset = 0;
+        for (size_t digit = 0; digit < digitCount; ++digit) {
+            for (size_t block = 0; block < blockCount; ++block) {
+                const uint32_t count = offsets[block * digitCount + digit];
+                offsets[block * digitCount + digit] = static_cast<uint32_t>(offset);
+                offset += count;
+            }
+        }
+        ParallelFor(blockCount, threadCount, [&](size_t block) {
+            uint32_t* cursor = &offsets[block * digitCount];
+            const size_t end = std::min(triangleCount, (block + 1) * blockSize);
+            for (size_t t = block * blockSize; t < end; ++t) {
+                sorted[cursor[digitOf(keys[t])]++] = keys[t];
+            }
+        });
+        std::swap(keys, sorted);
+    }
+    sorted = std::move(keys);
+
+    // Build partitions
+    const size_t partitionCount = (triangleCount + PartitionTriangles - 1) / PartitionTriangles;
+    std::vector<MeshletData> partitions(partitionCount);
+    ParallelFor(partitionCount, threadCount, [&](size_t partition) {
+        const size_t first = partition * PartitionTriangles;
+        const size_t count = std::min(PartitionTriangles, triangleCount - first);
+        std::vector<uint32_t> partitionIndices(count * 3);
+        for (size_t t = 0; t < count; ++t) {
+            const size_t triangle = static_cast<size_t>(sorted[first + t] & 0xFFFFFFFFu);
+            std::copy_n(indices + triangle * 3, 3, &partitionIndices[t * 3]);
+        }
+        partitions[partition] = BuildSubset(partitionIndices.data(), partitionIndices.size(), maxVertices, maxPrimitives);
+    });
+    sorted = std::vector<uint64_t>();
+
+    // Stitch in partition order
+    std::vector<size_t> meshletBase(partitionCount + 1);
+    std::vector<size_t> vertexBase(partitionCount + 1);
+    std::vector<size_t> primitiveBase(partitionCount + 1);
+    for (size_t i = 0; i < partitionCount; ++i) {
+        meshletBase[i + 1] = meshletBase[i] + partitions[i].meshlets.size();
+        vertexBase[i + 1] = vertexBase[i] + partitions[i].uniqueVertexIndices.size();
+        primitiveBase[i + 1] = primitiveBase[i] + partitions[i].primitiveIndices.size();
+    }
+    if (vertexBase[partitionCount] >= NoIndex) {
+        throw std::out_of_range("MeshletBuilder: meshlet offsets exceed 32 bits");
+    }
+
+    MeshletData data;
+    data.meshlets.resize(meshletBase[partitionCount]);
+    data.uniqueVertexIndices.resize(vertexBase[partitionCount]);
+    data.primitiveIndices.resize(primitiveBase[partitionCount]);
+    ParallelFor(partitionCount, threadCount, [&](size_t i) {
+        MeshletData& partition = partitions[i];
+        for (size_t m = 0; m < partition.meshlets.size(); ++m) {
+            Meshlet meshlet = partition.meshlets[m];
+            meshlet.VertOffset += static_cast<uint32_t>(vertexBase[i]);
+            meshlet.PrimOffset += static_cast<uint32_t>(primitiveBase[i]);
+            data.meshlets[meshletBase[i] + m] = meshlet;
+        }
+        std::copy(partition.uniqueVertexIndices.begin(), partition.uniqueVertexIndices.end(), data.uniqueVertexIndices.begin() + vertexBase[i]);
+        std::copy(partition.primitiveIndices.begin(), partition.primitiveIndices.end(), data.primitiveIndices.begin() + primitiveBase[i]);
+        partition = MeshletData();
+    });
+
+    return data;
+}
+
+MeshletData MeshletBuilder::BuildClustered(const uint32_t* indices, size_t indexCount, const Float3* positions, size_t vertexCount,
+                                           uint32_t maxVertices, uint32_t maxPrimitives, float coneWeight, size_t positionStride)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount >= NoIndex || vertexCount >= NoIndex) {
+        throw std::out_of_range("MeshletBuilder: too many triangles");
+    }
+    if (maxVertices < 3 || maxVertices > 256 || maxPrimitives < 1 || maxPrimitives > 256) {
+        throw std::invalid_argument("MeshletBuilder: limits must be within [3, 256] vertices and [1, 256] primitives");
+    }
+    auto position = [&](uint32_t vertex) -> const Float3&
+    {
+        return *reinterpret_cast<const Float3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * positionStride);
+    };
+
+    // Per triangle centroid and unit normal, and the vertex -> triangle adjacency
+    std::vector<Float3> centroids(triangleCount);
+    std::vector<Float3> normals(triangleCount);
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    double totalArea = 0.0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (int corner = 0; corner < 3; ++corner) {
+            if (indices[t * 3 + corner] >= vertexCount) {
+                throw std::out_of_range("MeshletBuilder: index out of range");
+            }
+            ++adjacencyOffsets[indices[t * 3 + corner] + 1];
+        }
+        const Float3& a = position(indices[t * 3]);
+        const Float3& b = position(indices[t * 3 + 1]);
+        const Float3& c = position(indices[t * 3 + 2]);
+        const Float3 normal = Cross(b - a, c - a);
+        totalArea += Length(normal) * 0.5;
+        centroids[t] = (a + b + c) * (1.f / 3.f);
+        normals[t] = Normalize(normal);
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    }
+    std::vector<uint32_t> adjacency(adjacencyOffsets[vertexCount]);
+    {
+        std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i) {
+            adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    // Radius of a full meshlet on an evenly tessellated surface, makes distances mesh scale independent
+    const double averageArea = triangleCount ? totalArea / triangleCount : 0.0;
+    const float expectedRadius = std::max(1e-20f, static_cast<float>(std::sqrt(averageArea * maxPrimitives / 3.14159265)));
+    const float reuseWeight = 1.f - std::clamp(coneWeight, 0.f, 1.f);
+    const float normalWeight = 3.f * std::clamp(coneWeight, 0.f, 1.f);
+
+    MeshletData data;
+    std::vector<uint8_t> used(triangleCount);
+    std::vector<uint32_t> liveTriangles(vertexCount);                // unused triangles around the vertex
+    for (size_t v = 0; v < vertexCount; ++v) {
+        liveTriangles[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+    }
+    std::vector<uint32_t> vertexMeshlet(vertexCount, NoIndex);     // meshlet the vertex was last added to
+    std::vector<uint32_t> vertexLocal(vertexCount);
+    std::vector<uint32_t> candidateMeshlet(triangleCount, NoIndex);
+    std::vector<uint32_t> candidates;
+    size_t seedCursor = 0;
+    size_t remaining = triangleCount;
+
+    while (remaining > 0) {
+        const uint32_t meshletIndex = static_cast<uint32_t>(data.meshlets.size());
+        Meshlet meshlet = {};
+        meshlet.VertOffset = static_cast<uint32_t>(data.uniqueVertexIndices.size());
+        meshlet.PrimOffset = static_cast<uint32_t>(data.primitiveIndices.size());
+        Float3 centroidSum = {};
+        Float3 normalSum = {};
+
+        // Seed next to the previous meshlet when it left unused neighbours, so meshlets stay in
+        // spatial order. Among those, the one with the fewest unused neighbours, growing from the
+        // corners of the remaining surface leaves fewer isolated slivers behind.
+        uint32_t seed = NoIndex;
+        uint32_t seedLive = NoIndex;
+        for (uint32_t triangle : candidates) {
+            if (used[triangle]) {
+                continue;
+            }
+            const uint32_t live = liveTriangles[indices[triangle * 3]] + liveTriangles[indices[triangle * 3 + 1]] + liveTriangles[indices[triangle * 3 + 2]];
+            if (live < seedLive || (live == seedLive && triangle < seed)) {
+                seed = triangle;
+                seedLive = live;
+            }
+        }
+        if (seed == NoIndex) {
+            while (used[seedCursor]) {
+                ++seedCursor;
+            }
+            seed = static_cast<uint32_t>(seedCursor);
+        }
+        candidates.clear();
+
+        auto addTriangle = [&](uint32_t triangle)
+        {
+            uint32_t local[3];
+            for (int corner = 0; corner < 3; ++corner) {
+                const uint32_t vertex = indices[triangle * 3 + corner];
+                if (vertexMeshlet[vertex] != meshletIndex) {
+                    vertexMeshlet[vertex] = meshletIndex;
+                    vertexLocal[vertex] = meshlet.VertCount++;
+                    data.uniqueVertexIndices.push_back(vertex);
+                    for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; ++a) {
+                        const uint32_t neighbour = adjacency[a];
+                        if (!used[neighbour] && candidateMeshlet[neighbour] != meshletIndex) {
+                            candidateMeshlet[neighbour] = meshletIndex;
+                            candidates.push_back(neighbour);
+                        }
+                    }
+                }
+                local[corner] = vertexLocal[vertex];
+            }
+            data.primitiveIndices.push_back(PackTriangle(local[0], local[1], local[2]));
+            ++meshlet.PrimCount;
+            used[triangle] = 1;
+            --remaining;
+            for (int corner = 0; corner < 3; ++corner) {
+                --liveTriangles[indices[triangle * 3 + corner]];
+            }
+            centroidSum = centroidSum + centroids[triangle];
+            normalSum = normalSum + normals[triangle];
+        };
+        addTriangle(seed);
+
+        while (meshlet.PrimCount < maxPrimitives) {
+            const Float3 center = centroidSum * (1.f / meshlet.PrimCount);
+            const Float3 axis = Normalize(normalSum);
+
+            uint32_t best = NoIndex;
+            float bestCost = FLT_MAX;
+            for (size_t i = 0; i < candidates.size();) {
+                const uint32_t triangle = candidates[i];
+                if (used[triangle]) {
+                    candidates[i] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+                ++i;
+
+                uint32_t extra = 0;
+                uint32_t finished = 0;
+                for (int corner = 0; corner < 3; ++corner) {
+                    const uint32_t vertex = indices[triangle * 3 + corner];
+                    extra += vertexMeshlet[vertex] != meshletIndex;
+                    finished += liveTriangles[vertex] == 1;
+                }
+                if (meshlet.VertCount + extra > maxVertices) {
+                    continue;
+                }
+                // Triangles that are the last user of a vertex go first, they'd be stranded otherwise
+                const float cost = reuseWeight * extra - 0.5f * finished
+                                 + normalWeight * (1.f - Dot(normals[triangle], axis))
+                                 + Length(centroids[triangle] - center) / expectedRadius;
+                if (cost < bestCost || (cost == bestCost && triangle < best)) {
+                    best = triangle;
+                    bestCost = cost;
+                }
+            }
+            if (best == NoIndex) {
+                break;
+            }
+            addTriangle(best);
+        }
+
+        data.meshlets.push_back(meshlet);
+    }
+
+    return data;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Meshlet buffers in the layout MeshletMS.hlsl reads.
+struct MeshletData
+{
+    std::vector<Meshlet>    meshlets;
+    std::vector<uint32_t>   uniqueVertexIndices;    // Meshlet local -> mesh vertex index
+    std::vector<uint32_t>   primitiveIndices;       // PackTriangle encoded, meshlet local indices
+};
+
+enum class MeshletBuilderKind : uint32_t
+{
+    DirectXMesh = 0,    // DirectX::ComputeMeshlets, only available on Windows
+    Greedy      = 1,    // MeshletBuilder::Build
+    Streaming   = 2,    // StreamingMeshletBuilder::Build
+    Parallel    = 3,    // MeshletBuilder::BuildParallel
+    Clustered   = 4,    // MeshletBuilder::BuildClustered
+};
+
+// Post-process order of meshlets and vertices, see MeshletReorder.
+enum class MeshletOrdering : uint32_t
+{
+    Builder = 0,        // as built
+    Morton  = 1,
+    Hilbert = 2,
+};
+
+// How mesh shader threads find their vertex.
+enum class MeshletVertexLayout : uint32_t
+{
+    Indexed = 0,        // Vertices[UniqueVertexIndices[VertOffset + gtid]]
+    Flat    = 1,        // Vertices[VertOffset + gtid], boundary vertices are stored once per meshlet
+};
+
+// How PrimitiveIndices stores the meshlet local triangles, see PrimitiveEncoding.
+enum class MeshletPrimitiveFormat : uint32_t
+{
+    Packed10 = 0,       // PackTriangle, one uint32 per triangle
+    Bytes    = 1,       // three uint8 per triangle
+};
+
+// What the Vertices buffer holds
+enum class MeshletVertexFormat : uint32_t
+{
+    Full      = 0,      // Vertex, 32 bytes
+    Quantized = 1,      // QuantizedVertex, 12 bytes, plus PositionBounds per meshlet
+    Split     = 2,      // Vertex attributes in separate position, normal and texture coordinate streams
+};
+
+// Everything that changes the output of a builder. Part of the meshlet pack cache key.
+struct MeshletBuildParams
+{
+    MeshletBuilderKind      builder = MeshletBuilderKind::DirectXMesh;
+    uint32_t                maxVertices = 128;
+    uint32_t                maxPrimitives = 128;
+    float                   coneWeight = 0.5f;      // Clustered only
+    MeshletOrdering         ordering = MeshletOrdering::Builder;
+    MeshletVertexLayout     vertexLayout = MeshletVertexLayout::Indexed;
+    MeshletPrimitiveFormat  primitiveFormat = MeshletPrimitiveFormat::Packed10;
+    MeshletVertexFormat     vertexFormat = MeshletVertexFormat::Full;
+};
+
+class MeshletBuilder
+{
+public:
+    // Portable greedy builder. Walks the triangles in index buffer order and starts a new meshlet
+    // whenever the next triangle would exceed one of the limits.
+    static MeshletData Build(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t maxVertices = 128, uint32_t maxPrimitives = 128);
+
+    // Same as Build for a subset of a larger mesh. Vertex ids are compacted first, so memory
+    // depends on the subset only. uniqueVertexIndices still refer to the original vertices.
+    static MeshletData BuildSubset(const uint32_t* indices, size_t indexCount, uint32_t maxVertices = 128, uint32_t maxPrimitives = 128);
+
+    // Multi-threaded builder. Triangles are sorted along a Morton curve of their centroids and cut
+    // into fixed size partitions that are built independently and stitched in partition order,
+    // so the output is identical for any threadCount (0 means all cores).
+    static MeshletData BuildParallel(const uint32_t* indices, size_t indexCount, const Float3* positions, size_t vertexCount,
+                                     uint32_t maxVertices = 128, uint32_t maxPrimitives = 128, unsigned threadCount = 0,
+                                     size_t positionStride = sizeof(Float3));
+
+    // Bounds-aware builder. Grows every meshlet from a seed triangle by adding the neighbouring
+    // triangle with the lowest cost, which mixes the number of new vertices (reuse), the distance to
+    // the meshlet center (compactness) and the deviation from the meshlet's average normal (cone
+    // width). coneWeight in [0, 1] trades vertex reuse for tighter normal cones. Single threaded.
+    static MeshletData BuildClustered(const uint32_t* indices, size_t indexCount, const Float3* positions, size_t vertexCount,
+                                      uint32_t maxVertices = 128, uint32_t maxPrimitives = 128, float coneWeight = 0.5f,
+                                      size_t positionStride = sizeof(Float3));
+
+    static constexpr size_t PartitionTriangles = 1 << 14;
+};
@@ -0,0 +1,70 @@
+// Shared by MeshletAS.hlsl, MeshletMS.hlsl and DrawCullCS.hlsl
+
+// The draw's DrawConstants, which ExecuteIndirect sets from its DispatchMeshCommand
+#define DRAW_ROOT_PARAMS "RootConstants(num32BitConstants = 10, b1)"
+
+// Root parameters MeshletAS.hlsl needs on top of the mesh shader's: per meshlet visibility of the
+// last frame and the depth pyramid. Appended to every ROOT_SIG.
+#define CULLING_ROOT_PARAMS "UAV(u0), DescriptorTable(SRV(t8, flags = DATA_VOLATILE))"
+
+// Meshlets one amplification shader group tests, MeshletCulling::GroupSize on the CPU.
+// One wave per group, so the payload can be compacted with wave intrinsics.
+#define AS_GROUP_SIZE 32
+
+struct Constants
+{
+    float4x4 World;
+    float4x4 WorldView;
+    float4x4 WorldViewProj;
+    uint     DrawMeshlets;
+    uint     IndicesCount;
+    uint     VerticesCount;
+    uint     MeshletCount;
+    float4   FrustumPlanes[6];  // object space, Frustum::FromMatrix(WorldViewProj)
+    float3   CameraPosition;    // object space
+    uint     HzbLevels;
+    float4   Projection;        // DepthProjection: p00, p11, zNear, depthOffset
+    float    DepthScale;        // DepthProjection::depthScale
+    uint     DepthWidth;        // render target size, also the viewport of the primitive culling in MeshletMS.hlsl
+    uint     DepthHeight;
+};
+
+// One draw: its meshlet range and the bindless descriptor heap indices of the mesh's buffers,
+// MeshDescriptors on the CPU. Flat, a nested struct would start a new constant register.
+struct DrawConstants
+{
+    uint MeshletOffset;
+    uint MeshletCount;
+    uint Vertices;
+    uint Meshlets;
+    uint UniqueVertexIndices;
+    uint PrimitiveIndices;
+    uint PositionBounds;
+    uint Normals;
+    uint TexCoords;
+    uint Bounds;
+};
+
+// Meshlets that survived culling, one per mesh shader group
+struct Payload
+{
+    uint MeshletIndices[AS_GROUP_SIZE];
+};
+
+ConstantBuffer<Constants>       Globals     : register(b0);
+ConstantBuffer<DrawConstants>   Draw        : register(b1);
+
+// Same operations in the same order as MeshletCulling::SphereVisible, precise keeps them from being
+// fused into mads so the result matches the CPU reference.
+bool SphereVisible(float3 center, float radius)
+{
+    bool visible = true;
+    [unroll]
+    for (uint i = 0; i < 6; ++i)
+    {
+        float4 plane = Globals.FrustumPlanes[i];
+        precise float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        visible = visible && distance >= -radius;
+    }
+    return visible;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+// Meshlet limits, expressed once. A configuration drives the builder (BuildParams), the cache
+// file and shader variant names, and the MAX_VERTS / MAX_PRIMS / GROUP_SIZE_X defines the mesh
+// shader is compiled with, so the CPU and GPU side can't disagree.
+template<uint32_t MaxVerts, uint32_t MaxPrims>
+struct MeshletConfig
+{
+    static_assert(MaxVerts >= 3 && MaxVerts <= 256, "Mesh shaders output at most 256 vertices.");
+    static_assert(MaxPrims >= 1 && MaxPrims <= 256, "Mesh shaders output at most 256 primitives.");
+
+    static constexpr uint32_t MaxVertices = MaxVerts;
+    static constexpr uint32_t MaxPrimitives = MaxPrims;
+
+    // One thread per output vertex and primitive, rounded up to whole 32 lane waves.
+    static constexpr uint32_t WaveSize = 32;
+    static constexpr uint32_t GroupSize = (std::max(MaxVerts, MaxPrims) + WaveSize - 1) / WaveSize * WaveSize;
+    static_assert(GroupSize <= 128, "Mesh shader thread groups are limited to 128 threads.");
+
+    static MeshletBuildParams BuildParams(MeshletBuilderKind builder)
+    {
+        MeshletBuildParams params;
+        params.builder = builder;
+        params.maxVertices = MaxVertices;
+        params.maxPrimitives = MaxPrimitives;
+        return params;
+    }
+
+    // "64v126p", used to tell cache files and shader variants apart
+    static std::string Name()
+    {
+        return std::to_string(MaxVertices) + "v" + std::to_string(MaxPrimitives) + "p";
+    }
+
+    static std::string ShaderDefines()
+    {
+        return "-D MAX_VERTS=" + std::to_string(MaxVertices) + " -D MAX_PRIMS=" + std::to_string(MaxPrimitives) + " -D GROUP_SIZE_X=" + std::to_string(GroupSize);
+    }
+};
+
+using MeshletConfig128x128 = MeshletConfig<128, 128>;  // DirectXMesh defaults
+using MeshletConfig64x126 = MeshletConfig<64, 126>;
+using MeshletConfig64x84 = MeshletConfig<64, 84>;
+
+// Every configuration BuildShaders.bat compiles a mesh shader variant for.
+using MeshletConfigs = std::tuple<MeshletConfig128x128, MeshletConfig64x126, MeshletConfig64x84>;
+
+template<class Config, class List>
+struct ContainsMeshletConfig;
+
+template<class Config, class... Configs>
+struct ContainsMeshletConfig<Config, std::tuple<Configs...>> : std::disjunction<std::is_same<Config, Configs>...> {};
+
+template<class Func>
+void ForEachMeshletConfig(Func&& func)
+{
+    std::apply([&](auto... configs) { (func(configs), ...); }, MeshletConfigs{});
+}
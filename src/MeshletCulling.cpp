@@ -0,0 +1,73 @@
+#include "MeshletCulling.h"
+
+#include <cmath>
+
+Frustum Frustum::FromMatrix(const float (&m)[4][4])
+{
+    // Gribb/Hartmann: clip = p * m, so every clip coordinate is the dot with a column
+    auto plane = [&](int c, float sign) {
+        return Plane{ { m[0][3] + sign * m[0][c], m[1][3] + sign * m[1][c], m[2][3] + sign * m[2][c] }, m[3][3] + sign * m[3][c] };
+    };
+
+    Frustum frustum;
+    frustum.planes[0] = plane(0, 1.f);      // -w <= x
+    frustum.planes[1] = plane(0, -1.f);     // x <= w
+    frustum.planes[2] = plane(1, 1.f);      // -w <= y
+    frustum.planes[3] = plane(1, -1.f);     // y <= w
+    frustum.planes[4] = { { m[0][2], m[1][2], m[2][2] }, m[3][2] };     // 0 <= z
+    frustum.planes[5] = plane(2, -1.f);     // z <= w
+
+    // Unit normals, so the plane distance compares against the radius
+    for (Plane& p : frustum.planes) {
+        const float length = std::sqrt(p.normal.x * p.normal.x + p.normal.y * p.normal.y + p.normal.z * p.normal.z);
+        if (length > 0.f) {
+            const float scale = 1.f / length;
+            p.normal = { p.normal.x * scale, p.normal.y * scale, p.normal.z * scale };
+            p.distance *= scale;
+        }
+    }
+    return frustum;
+}
+
+// Keep in sync with SphereVisible in MeshletCommon.hlsli. No FMA contraction (see CMakeLists.txt),
+// the shader's precise does the same on the GPU side.
+bool MeshletCulling::SphereVisible(const Frustum& frustum, const Float3& center, float radius)
+{
+    bool visible = true;
+    for (const Plane& plane : frustum.planes) {
+        const float distance = plane.normal.x * center.x + plane.normal.y * center.y + plane.normal.z * center.z + plane.distance;
+        visible = visible && distance >= -radius;
+    }
+    return visible;
+}
+
+// Keep in sync with ConeVisible in MeshletAS.hlsl
+bool MeshletCulling::ConeVisible(const PackedMeshletBounds& bounds, const Float3& camera)
+{
+    if (bounds.coneCutoff == PackedMeshletBounds::OpenCone) {
+        return true;
+    }
+    const Float3 axis = { bounds.coneAxis[0] * (1.f / 127.f), bounds.coneAxis[1] * (1.f / 127.f), bounds.coneAxis[2] * (1.f / 127.f) };
+    const float cutoff = bounds.coneCutoff * (1.f / 254.f);
+    const float apexDistance = bounds.coneApex * (bounds.radius * (1.f / 16.f));
+
+    const Float3 view = {
+        bounds.center.x - axis.x * apexDistance - camera.x,
+        bounds.center.y - axis.y * apexDistance - camera.y,
+        bounds.center.z - axis.z * apexDistance - camera.z,
+    };
+    const float along = view.x * axis.x + view.y * axis.y + view.z * axis.z;
+    const float lengthSquared = view.x * view.x + view.y * view.y + view.z * view.z;
+    return !(along > 0.f && along * along >= cutoff * cutoff * lengthSquared);
+}
+
+std::vector<uint32_t> MeshletCulling::Cull(const Frustum& frustum, const Float3& camera, const PackedMeshletBounds* bounds, uint32_t meshletCount)
+{
+    std::vector<uint32_t> visible;
+    for (uint32_t i = 0; i < meshletCount; ++i) {
+        if (Visible(frustum, camera, bounds[i])) {
+            visible.push_back(i);
+        }
+    }
+    return visible;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "MeshletBounds.h"
+
+#include <cstdint>
+#include <vector>
+
+// dot(normal, p) + distance >= 0 inside. Same layout as a float4 in the constant buffer.
+struct Plane
+{
+    Float3  normal;
+    float   distance;
+};
+static_assert(sizeof(Plane) == 16, "Plane must match float4.");
+
+// Left, right, bottom, top, near, far. The planes live in whatever space the matrix transforms
+// from, so planes of WorldViewProj cull object space bounds directly.
+struct Frustum
+{
+    Plane   planes[6];
+
+    // matrix maps row vectors to D3D clip space (mul(float4(p, 1), matrix), 0 <= z <= w),
+    // i.e. a DirectX::XMFLOAT4X4 before it is transposed for the shader.
+    static Frustum FromMatrix(const float (&matrix)[4][4]);
+};
+
+// CPU reference of the culling in MeshletAS.hlsl. The shader evaluates the same float operations in
+// the same order and marks them precise, so both sides agree bit for bit on the same planes and camera.
+class MeshletCulling
+{
+public:
+    static constexpr uint32_t GroupSize = 32;   // AS_GROUP_SIZE
+
+    static bool SphereVisible(const Frustum& frustum, const Float3& center, float radius);
+
+    // False when the camera sees the back of every triangle, decodes the 8-bit cone on the fly.
+    // Squared instead of normalized, so there's no sqrt (which GPUs don't round exactly).
+    static bool ConeVisible(const PackedMeshletBounds& bounds, const Float3& camera);
+
+    static bool Visible(const Frustum& frustum, const Float3& camera, const PackedMeshletBounds& bounds)
+    {
+        return SphereVisible(frustum, bounds.center, bounds.radius) && ConeVisible(bounds, camera);
+    }
+
+    // Indices of the meshlets that pass, in the order the amplification shader hands them to DispatchMesh:
+    // group after group, lanes in order. camera is in the same space as the frustum.
+    static std::vector<uint32_t> Cull(const Frustum& frustum, const Float3& camera, const PackedMeshletBounds* bounds, uint32_t meshletCount);
+};
@@ -0,0 +1,10 @@
+#include "MeshletLayout.h"
+
+MeshletLayoutCost MeshletLayout::Cost(const MeshletData& data, size_t vertexCount, size_t vertexSize)
+{
+    MeshletLayoutCost cost;
+    cost.indexedVertexBytes = uint64_t(vertexCount) * vertexSize;
+    cost.indexBytes = uint64_t(data.uniqueVertexIndices.size()) * sizeof(uint32_t);
+    cost.flatVertexBytes = uint64_t(data.uniqueVertexIndices.size()) * vertexSize;
+    return cost;
+}
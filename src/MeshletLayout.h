@@ -0,0 +1,37 @@
+#pragma once
+
+#include "MeshletBuilder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// GPU memory of both MeshletVertexLayouts for one asset.
+struct MeshletLayoutCost
+{
+    uint64_t    indexedVertexBytes = 0;     // shared vertex buffer
+    uint64_t    indexBytes = 0;             // UniqueVertexIndices
+    uint64_t    flatVertexBytes = 0;        // one copy of every vertex per meshlet using it
+
+    uint64_t IndexedBytes() const { return indexedVertexBytes + indexBytes; }
+    uint64_t FlatBytes() const { return flatVertexBytes; }
+};
+
+class MeshletLayout
+{
+public:
+    static MeshletLayoutCost Cost(const MeshletData& data, size_t vertexCount, size_t vertexSize);
+
+    // Switches to MeshletVertexLayout::Flat. vertices become one contiguous run per meshlet, so
+    // meshlet.VertOffset + local index addresses them directly, and uniqueVertexIndices is cleared.
+    template<class T>
+    static void Flatten(std::vector<T>& vertices, MeshletData& data)
+    {
+        std::vector<T> flat(data.uniqueVertexIndices.size());
+        for (size_t i = 0; i < flat.size(); ++i) {
+            flat[i] = vertices.at(data.uniqueVertexIndices[i]);
+        }
+        vertices = std::move(flat);
+        data.uniqueVertexIndices = std::vector<uint32_t>();
+    }
+};
@@ -1,20 +1,12 @@
+// FLAT_VERTICES: vertices are stored per meshlet (MeshletVertexLayout::Flat), no UniqueVertexIndices.
+// QUANTIZED_VERTICES: QuantizedVertex (MeshletVertexFormat::Quantized) plus PositionBounds per meshlet.
+// SPLIT_VERTICES: positions, normals and texture coordinates in separate buffers (MeshletVertexFormat::Split).
+// Every variant runs behind MeshletAS.hlsl, which adds CULLING_ROOT_PARAMS, and reads the mesh's
+// buffers from the descriptor heap at the indices in DrawConstants, so they all share one root
+// signature whatever they read.
+#include "MeshletCommon.hlsli"
 
-
-#define ROOT_SIG "CBV(b0),\
-                  SRV(t0),\
-                  SRV(t1),\
-                  SRV(t2),\
-                  SRV(t3)"
-
-struct Constants
-{
-    float4x4 World;
-    float4x4 WorldView;
-    float4x4 WorldViewProj;
-    uint     DrawMeshlets;
-    uint     IndicesCount;
-    uint     VerticesCount;
-};
+#define ROOT_SIG "RootFlags(CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED), CBV(b0), " DRAW_ROOT_PARAMS ", " CULLING_ROOT_PARAMS
 
 struct Meshlet
 {
@@ -44,14 +36,134 @@ uint3 DecodePrimitiveIndices(uint primitive)
     return uint3(primitive & 0x3FF, (primitive >> 10) & 0x3FF, (primitive >> 20) & 0x3FF);
 }
 
-ConstantBuffer<Constants>   Globals     : register(b0);
+#ifdef QUANTIZED_VERTICES
+struct QuantizedVertex
+{
+    uint PositionXY;
+    uint PositionZNormal;   // normal in the high half, octahedral snorm8x2
+    uint TexCoord;          // half2
+};
+
+struct PositionBounds
+{
+    float3 Offset;
+    float3 Scale;
+};
+
+float3 DecodeOctahedral(uint packed)
+{
+    float2 e = max(float2(int(packed << 24) >> 24, int(packed << 16) >> 24) / 127.0, -1.0);
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += (n.xy >= 0.0) ? -t : t;
+    return normalize(n);
+}
+
+// Same as VertexQuantization::Decode
+Vertex LoadVertex(uint index, uint meshletIndex)
+{
+    StructuredBuffer<QuantizedVertex> vertices = ResourceDescriptorHeap[Draw.Vertices];
+    StructuredBuffer<PositionBounds> positionBounds = ResourceDescriptorHeap[Draw.PositionBounds];
+    QuantizedVertex q = vertices[index];
+    PositionBounds bounds = positionBounds[meshletIndex];
+
+    Vertex v;
+    v.Position = bounds.Offset + bounds.Scale * float3(q.PositionXY & 0xFFFF, q.PositionXY >> 16, q.PositionZNormal & 0xFFFF);
+    v.Normal = DecodeOctahedral(q.PositionZNormal >> 16);
+    v.TexCoord = float2(f16tof32(q.TexCoord), f16tof32(q.TexCoord >> 16));
+    return v;
+}
+#elif defined(SPLIT_VERTICES)
+Vertex LoadVertex(uint index, uint meshletIndex)
+{
+    StructuredBuffer<float3> positions = ResourceDescriptorHeap[Draw.Vertices];
+    StructuredBuffer<float3> normals = ResourceDescriptorHeap[Draw.Normals];
+    StructuredBuffer<float2> texCoords = ResourceDescriptorHeap[Draw.TexCoords];
+
+    Vertex v;
+    v.Position = positions[index];
+    v.Normal = normals[index];
+    v.TexCoord = texCoords[index];
+    return v;
+}
+#else
+Vertex LoadVertex(uint index, uint meshletIndex)
+{
+    StructuredBuffer<Vertex> vertices = ResourceDescriptorHeap[Draw.Vertices];
+    return vertices[index];
+}
+#endif
+// BYTE_PRIMITIVES: three uint8 per triangle (MeshletPrimitiveFormat::Bytes), see PrimitiveEncoding.h.
+#ifdef BYTE_PRIMITIVES
+uint3 LoadPrimitive(uint primitive)
+{
+    ByteAddressBuffer primitiveIndices = ResourceDescriptorHeap[Draw.PrimitiveIndices];
+    uint byteOffset = primitive * 3;
+    uint2 words = primitiveIndices.Load2(byteOffset & ~3);
+    uint shift = (byteOffset & 3) * 8;
+    uint packed = shift ? (words.x >> shift) | (words.y << (32 - shift)) : words.x;
+    return uint3(packed & 0xFF, (packed >> 8) & 0xFF, (packed >> 16) & 0xFF);
+}
+#else
+uint3 LoadPrimitive(uint primitive)
+{
+    StructuredBuffer<uint> primitiveIndices = ResourceDescriptorHeap[Draw.PrimitiveIndices];
+    return DecodePrimitiveIndices(primitiveIndices[primitive]);
+}
+#endif
 
-StructuredBuffer<Vertex>    Vertices            : register(t0);
-StructuredBuffer<Meshlet>   Meshlets            : register(t1);
-ByteAddressBuffer           UniqueVertexIndices : register(t2);
-StructuredBuffer<uint>      PrimitiveIndices    : register(t3);
+// Meshlet limits come from MeshletConfig.h through BuildShaders.bat, defaults match MeshletConfig128x128.
+#ifndef MAX_VERTS
+#define MAX_VERTS 128
+#endif
 
+#ifndef MAX_PRIMS
+#define MAX_PRIMS 128
+#endif
+
+#ifndef GROUP_SIZE_X
 #define GROUP_SIZE_X 128
+#endif
+
+// PRIMITIVE_CULLING: drop triangles that can't produce a fragment before they reach the rasterizer,
+// see PrimitiveCulling for the tests. 0 emits every triangle of the meshlet.
+#ifndef PRIMITIVE_CULLING
+#define PRIMITIVE_CULLING 1
+#endif
+
+// Waves are at least 4 lanes wide
+#define MAX_WAVES ((GROUP_SIZE_X + 3) / 4)
+
+groupshared float4 ClipPositions[MAX_VERTS];
+groupshared uint WavePrimitiveCounts[MAX_WAVES];
+
+// Same as PrimitiveCulling::Classify != Visible, uses the render target size
+bool CullPrimitive(float4 c0, float4 c1, float4 c2)
+{
+    if (c0.w <= 0 || c1.w <= 0 || c2.w <= 0)
+        return false;
+
+    // Frustum: all vertices outside the same clip plane
+    if ((c0.x < -c0.w && c1.x < -c1.w && c2.x < -c2.w) || (c0.x > c0.w && c1.x > c1.w && c2.x > c2.w)
+        || (c0.y < -c0.w && c1.y < -c1.w && c2.y < -c2.w) || (c0.y > c0.w && c1.y > c1.w && c2.y > c2.w)
+        || (c0.z < 0 && c1.z < 0 && c2.z < 0) || (c0.z > c0.w && c1.z > c1.w && c2.z > c2.w))
+        return true;
+
+    const float2 viewport = float2(Globals.DepthWidth, Globals.DepthHeight);
+    const float2 p0 = (c0.xy / c0.w * float2(0.5, -0.5) + 0.5) * viewport;
+    const float2 p1 = (c1.xy / c1.w * float2(0.5, -0.5) + 0.5) * viewport;
+    const float2 p2 = (c2.xy / c2.w * float2(0.5, -0.5) + 0.5) * viewport;
+
+    // Backface (y down, counterclockwise is negative) and degenerate
+    const float area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+    if (area >= 0)
+        return true;
+
+    // Small primitive: the bounding box misses every pixel center, PrimitiveCulling::SubpixelMargin wider
+    const float2 boxMin = min(p0, min(p1, p2)) - 1.0 / 256.0;
+    const float2 boxMax = max(p0, max(p1, p2)) + 1.0 / 256.0;
+    return any(ceil(boxMin - 0.5) > floor(boxMax - 0.5));
+}
 
 [RootSignature(ROOT_SIG)]
 [NumThreads(GROUP_SIZE_X, 1, 1)]
@@ -59,31 +171,81 @@ StructuredBuffer<uint>      PrimitiveIndices    : register(t3);
 void main(
     uint gtid : SV_GroupThreadID,
     uint gid : SV_GroupID,
-    out indices uint3 tris[GROUP_SIZE_X],
-    out vertices VertexOut verts[GROUP_SIZE_X]
+    in payload Payload payload,
+    out indices uint3 tris[MAX_PRIMS],
+    out vertices VertexOut verts[MAX_VERTS]
 )
 {
-    const Meshlet meshlet = Meshlets[gid];
-    SetMeshOutputCounts(meshlet.VertCount, meshlet.PrimCount);
-
-    if (gtid < meshlet.PrimCount)
-    {
-        tris[gtid] = DecodePrimitiveIndices(PrimitiveIndices[meshlet.PrimOffset + gtid]);
-    }
+    const uint meshletIndex = payload.MeshletIndices[gid];
+    StructuredBuffer<Meshlet> meshlets = ResourceDescriptorHeap[Draw.Meshlets];
+    const Meshlet meshlet = meshlets[meshletIndex];
 
+    VertexOut vout = (VertexOut)0;
     if (gtid < meshlet.VertCount) 
     {
         uint localIndex = meshlet.VertOffset + gtid;
-        uint vertexIndex = UniqueVertexIndices.Load(localIndex * 4); // 4 because we assume uint_32 indices
+#ifdef FLAT_VERTICES
+        Vertex v = LoadVertex(localIndex, meshletIndex);
+#else
+        ByteAddressBuffer uniqueVertexIndices = ResourceDescriptorHeap[Draw.UniqueVertexIndices];
+        uint vertexIndex = uniqueVertexIndices.Load(localIndex * 4); // 4 because we assume uint_32 indices
 
-        Vertex v = Vertices[vertexIndex];
+        Vertex v = LoadVertex(vertexIndex, meshletIndex);
+#endif
 
-        VertexOut vout;
         vout.PositionVS = mul(float4(v.Position, 1), Globals.WorldView).xyz;
         vout.PositionHS = mul(float4(v.Position, 1), Globals.WorldViewProj);
         vout.Normal = mul(float4(v.Normal, 0), Globals.World).xyz;
-        vout.GroupIndex = gid;
+        vout.GroupIndex = meshletIndex;
+        ClipPositions[gtid] = vout.PositionHS;
+    }
+
+    uint3 tri = uint3(0, 0, 0);
+    bool keep = gtid < meshlet.PrimCount;
+    if (keep)
+    {
+        tri = LoadPrimitive(meshlet.PrimOffset + gtid);
+    }
+
+#if PRIMITIVE_CULLING
+    GroupMemoryBarrierWithGroupSync();
+    if (keep)
+    {
+        keep = !CullPrimitive(ClipPositions[tri.x], ClipPositions[tri.y], ClipPositions[tri.z]);
+    }
+
+    // Compact the survivors: lanes in order within a wave, waves in order within the group
+    const uint waveIndex = gtid / WaveGetLaneCount();
+    const uint waveCount = (GROUP_SIZE_X + WaveGetLaneCount() - 1) / WaveGetLaneCount();
+    const uint kept = WaveActiveCountBits(keep);
+    if (WaveIsFirstLane())
+    {
+        WavePrimitiveCounts[waveIndex] = kept;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    uint primitiveOffset = 0;
+    uint primitiveCount = 0;
+    for (uint w = 0; w < waveCount; ++w)
+    {
+        primitiveOffset += w < waveIndex ? WavePrimitiveCounts[w] : 0;
+        primitiveCount += WavePrimitiveCounts[w];
+    }
+    const uint primitiveSlot = primitiveOffset + WavePrefixCountBits(keep);
+#else
+    const uint primitiveCount = meshlet.PrimCount;
+    const uint primitiveSlot = gtid;
+#endif
 
+    SetMeshOutputCounts(meshlet.VertCount, primitiveCount);
+
+    if (keep)
+    {
+        tris[primitiveSlot] = tri;
+    }
+
+    if (gtid < meshlet.VertCount)
+    {
         verts[gtid] = vout;
     }
-}
\ No newline at end of file
+}
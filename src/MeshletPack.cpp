@@ -0,0 +1,341 @@
+#include "MeshletPack.h"
+
+#include "MeshletLayout.h"
+#include "MeshletReorder.h"
+#include "PrimitiveEncoding.h"
+#include "VertexStreams.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+const char PackMagic[8] = { 'M', 'S', 'H', 'L', 'P', 'A', 'C', 'K' };
+
+const size_t StreamElementSizes[] = {
+    sizeof(Vertex),
+    sizeof(Meshlet),
+    sizeof(uint32_t),
+    sizeof(uint32_t),
+    sizeof(QuantizedVertex),
+    sizeof(PositionBounds),
+    sizeof(Float3),
+    sizeof(Float3),
+    sizeof(Float2),
+    sizeof(PackedMeshletBounds),
+};
+static_assert(sizeof(StreamElementSizes) / sizeof(StreamElementSizes[0]) == static_cast<size_t>(MeshletPackStream::Count), "Missing stream element size.");
+
+constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+
+inline uint64_t RotateLeft(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t Read64(const uint8_t* p)
+{
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Split packs keep positions in a stream of their own, so the builder and the bounds read that
+// instead of striding over whole vertices
+const Float3* CookPositions(const ObjMesh& mesh, MeshletVertexFormat format, std::vector<Float3>& splitPositions)
+{
+    if (format != MeshletVertexFormat::Split) {
+        return &mesh.vertices[0].position;
+    }
+    splitPositions.resize(mesh.vertices.size());
+    std::transform(mesh.vertices.begin(), mesh.vertices.end(), splitPositions.begin(), [](const Vertex& vertex) { return vertex.position; });
+    return splitPositions.data();
+}
+
+} // namespace
+
+MeshletPackWriter::MeshletPackWriter(const std::filesystem::path& path, uint64_t key, const MeshletBuildParams& params)
+    : _path(path)
+{
+    _tempPath = path;
+    _tempPath += ".tmp";
+
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+#ifdef _WIN32
+    _file = _wfopen(_tempPath.c_str(), L"wb");
+#else
+    _file = std::fopen(_tempPath.c_str(), "wb");
+#endif
+    if (!_file) {
+        throw std::runtime_error("Cannot create meshlet pack: " + _tempPath.string());
+    }
+
+    std::memcpy(_header.magic, PackMagic, sizeof(PackMagic));
+    _header.version = MeshletPack::Version;
+    _header.headerSize = sizeof(MeshletPackHeader);
+    _header.key = key;
+    _header.maxVertices = params.maxVertices;
+    _header.maxPrimitives = params.maxPrimitives;
+
+    // Real header is written by Finish()
+    Write(&_header, sizeof(_header));
+}
+
+MeshletPackWriter::~MeshletPackWriter()
+{
+    if (_file) {
+        std::fclose(_file);
+        std::error_code ignored;
+        std::filesystem::remove(_tempPath, ignored);
+    }
+}
+
+void MeshletPackWriter::BeginStream(MeshletPackStream stream, size_t elementSize)
+{
+    if (static_cast<int>(stream) <= _stream || elementSize != StreamElementSizes[static_cast<size_t>(stream)]) {
+        throw std::logic_error("MeshletPackWriter: streams must be written in order with matching element types");
+    }
+    while (_stream + 1 < static_cast<int>(stream)) {
+        BeginStream(static_cast<MeshletPackStream>(_stream + 1), StreamElementSizes[_stream + 1]);
+    }
+    Pad();
+    _stream = static_cast<int>(stream);
+    _elementSize = elementSize;
+    _header.streams[_stream].offset = _offset;
+}
+
+void MeshletPackWriter::Append(const void* data, size_t size)
+{
+    if (_stream < 0 || size % _elementSize != 0) {
+        throw std::logic_error("MeshletPackWriter: append outside of a stream or of partial elements");
+    }
+    Write(data, size);
+    _header.streams[_stream].size += size;
+    _header.streams[_stream].count += size / _elementSize;
+}
+
+void MeshletPackWriter::Finish()
+{
+    while (_stream + 1 < static_cast<int>(MeshletPackStream::Count)) {
+        BeginStream(static_cast<MeshletPackStream>(_stream + 1), StreamElementSizes[_stream + 1]);
+    }
+    Pad();
+
+    if (std::fseek(_file, 0, SEEK_SET) != 0 || std::fwrite(&_header, sizeof(_header), 1, _file) != 1) {
+        throw std::runtime_error("Failed writing meshlet pack: " + _tempPath.string());
+    }
+    const bool failed = std::fclose(_file) != 0;
+    _file = nullptr;
+    if (failed) {
+        throw std::runtime_error("Failed writing meshlet pack: " + _tempPath.string());
+    }
+    std::filesystem::rename(_tempPath, _path);
+}
+
+void MeshletPackWriter::Write(const void* data, size_t size)
+{
+    if (size != 0 && std::fwrite(data, 1, size, _file) != size) {
+        throw std::runtime_error("Failed writing meshlet pack: " + _tempPath.string());
+    }
+    _offset += size;
+}
+
+void MeshletPackWriter::Pad()
+{
+    static const uint8_t zeros[MeshletPack::Alignment] = {};
+    const uint64_t padding = (MeshletPack::Alignment - _offset % MeshletPack::Alignment) % MeshletPack::Alignment;
+    Write(zeros, static_cast<size_t>(padding));
+}
+
+uint64_t MeshletPack::HashBytes(const void* data, size_t size, uint64_t seed)
+{
+    // xxHash64 style: four independent lanes over 32 byte blocks, then the tail.
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+
+    uint64_t hash;
+    if (size >= 32) {
+        uint64_t lanes[4] = { seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1 };
+        for (; p + 32 <= end; p += 32) {
+            for (int lane = 0; lane < 4; ++lane) {
+                lanes[lane] = RotateLeft(lanes[lane] + Read64(p + lane * 8) * Prime2, 31) * Prime1;
+            }
+        }
+        hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+        for (uint64_t lane : lanes) {
+            hash = (hash ^ (RotateLeft(lane * Prime2, 31) * Prime1)) * Prime1 + Prime3;
+        }
+    } else {
+        hash = seed + Prime3;
+    }
+
+    hash += size;
+    for (; p + 8 <= end; p += 8) {
+        hash ^= RotateLeft(Read64(p) * Prime2, 31) * Prime1;
+        hash = RotateLeft(hash, 27) * Prime1 + Prime3;
+    }
+    for (; p < end; ++p) {
+        hash ^= *p * Prime3;
+        hash = RotateLeft(hash, 11) * Prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t MeshletPack::ComputeKey(const std::filesystem::path& source, const MeshletBuildParams& params)
+{
+    uint32_t coneWeight = 0;
+    if (params.builder == MeshletBuilderKind::Clustered) {
+        std::memcpy(&coneWeight, &params.coneWeight, sizeof(coneWeight));
+    }
+    const uint32_t settings[] = {
+        Version, static_cast<uint32_t>(params.builder), params.maxVertices, params.maxPrimitives, coneWeight,
+        static_cast<uint32_t>(params.ordering), static_cast<uint32_t>(params.vertexLayout),
+        static_cast<uint32_t>(params.primitiveFormat), static_cast<uint32_t>(params.vertexFormat),
+    };
+    const uint64_t settingsHash = HashBytes(settings, sizeof(settings));
+
+    MappedFile file(source);
+    return HashBytes(file.Data(), file.Size(), settingsHash);
+}
+
+void MeshletPack::Write(const std::filesystem::path& path, uint64_t key, const MeshletBuildParams& params,
+                        const std::vector<Vertex>& vertices, const MeshletData& meshlets, const std::vector<PackedMeshletBounds>& bounds,
+                        const QuantizedMesh* quantized)
+{
+    if ((params.vertexFormat == MeshletVertexFormat::Quantized) != (quantized != nullptr)) {
+        throw std::invalid_argument("MeshletPack: quantized vertices are required exactly for quantized packs");
+    }
+    if (bounds.size() != meshlets.meshlets.size()) {
+        throw std::invalid_argument("MeshletPack: expected one PackedMeshletBounds per meshlet");
+    }
+
+    MeshletPackWriter writer(path, key, params);
+    writer.BeginStream(MeshletPackStream::Vertices, sizeof(Vertex));
+    if (params.vertexFormat == MeshletVertexFormat::Full) {
+        writer.Append(vertices.data(), vertices.size() * sizeof(Vertex));
+    }
+    writer.BeginStream(MeshletPackStream::Meshlets, sizeof(Meshlet));
+    writer.Append(meshlets.meshlets.data(), meshlets.meshlets.size() * sizeof(Meshlet));
+    writer.BeginStream(MeshletPackStream::UniqueVertexIndices, sizeof(uint32_t));
+    writer.Append(meshlets.uniqueVertexIndices.data(), meshlets.uniqueVertexIndices.size() * sizeof(uint32_t));
+    writer.BeginStream(MeshletPackStream::PrimitiveIndices, sizeof(uint32_t));
+    writer.Append(meshlets.primitiveIndices.data(), meshlets.primitiveIndices.size() * sizeof(uint32_t));
+    if (quantized) {
+        writer.BeginStream(MeshletPackStream::QuantizedVertices, sizeof(QuantizedVertex));
+        writer.Append(quantized->vertices.data(), quantized->vertices.size() * sizeof(QuantizedVertex));
+        writer.BeginStream(MeshletPackStream::PositionBounds, sizeof(PositionBounds));
+        writer.Append(quantized->bounds.data(), quantized->bounds.size() * sizeof(PositionBounds));
+    }
+    if (params.vertexFormat == MeshletVertexFormat::Split) {
+        const VertexStreams streams = VertexStreams::FromVertices(vertices);
+        writer.BeginStream(MeshletPackStream::Positions, sizeof(Float3));
+        writer.Append(streams.positions.data(), streams.positions.size() * sizeof(Float3));
+        writer.BeginStream(MeshletPackStream::Normals, sizeof(Float3));
+        writer.Append(streams.normals.data(), streams.normals.size() * sizeof(Float3));
+        writer.BeginStream(MeshletPackStream::TextureCoordinates, sizeof(Float2));
+        writer.Append(streams.textureCoordinates.data(), streams.textureCoordinates.size() * sizeof(Float2));
+    }
+    writer.BeginStream(MeshletPackStream::Bounds, sizeof(PackedMeshletBounds));
+    writer.Append(bounds.data(), bounds.size() * sizeof(PackedMeshletBounds));
+    writer.Finish();
+}
+
+MeshletPack MeshletPack::LoadOrCook(const std::filesystem::path& source, const std::filesystem::path& pack,
+                                    const MeshletBuildParams& params, const BuildFunction& build, bool* cacheHit)
+{
+    const uint64_t key = ComputeKey(source, params);
+
+    MeshletPack result;
+    const bool hit = result.Open(pack, key);
+    if (cacheHit) {
+        *cacheHit = hit;
+    }
+    if (hit) {
+        return result;
+    }
+
+    {
+        ObjMesh mesh = ObjLoader::Load(source);
+        if (mesh.vertices.empty() || mesh.indices.empty()) {
+            throw std::runtime_error("No triangles to cook in " + source.string());
+        }
+        std::vector<Float3> splitPositions;
+        const size_t positionStride = params.vertexFormat == MeshletVertexFormat::Split ? sizeof(Float3) : sizeof(Vertex);
+        const Float3* positions = CookPositions(mesh, params.vertexFormat, splitPositions);
+        MeshletData meshlets = build(mesh, positions, positionStride);
+        if (params.ordering != MeshletOrdering::Builder) {
+            MeshletReorder::Apply(mesh, meshlets, params.ordering);
+            positions = CookPositions(mesh, params.vertexFormat, splitPositions);
+        }
+        // Before Flatten, both need UniqueVertexIndices
+        std::vector<PackedMeshletBounds> bounds = MeshletBoundsBuilder::Pack(MeshletBoundsBuilder::Compute(meshlets, positions, positionStride),
+                                                                             meshlets, positions, positionStride);
+        if (params.vertexLayout == MeshletVertexLayout::Flat) {
+            MeshletLayout::Flatten(mesh.vertices, meshlets);
+        }
+        PrimitiveEncoding::Encode(meshlets, params.primitiveFormat);
+        if (params.vertexFormat == MeshletVertexFormat::Quantized) {
+            const QuantizedMesh quantized = VertexQuantization::Encode(mesh.vertices, meshlets, params.vertexLayout);
+            // Also moves the cone apex further back, which keeps it conservative
+            for (PackedMeshletBounds& meshletBounds : bounds) {
+                meshletBounds.radius += quantized.error.position;
+            }
+            Write(pack, key, params, mesh.vertices, meshlets, bounds, &quantized);
+        } else {
+            Write(pack, key, params, mesh.vertices, meshlets, bounds);
+        }
+    }
+    if (!result.Open(pack, key)) {
+        throw std::runtime_error("Freshly cooked meshlet pack is unreadable: " + pack.string());
+    }
+    return result;
+}
+
+bool MeshletPack::Open(const std::filesystem::path& path, uint64_t expectedKey)
+{
+    _file.Close();
+
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error)) {
+        return false;
+    }
+    try {
+        _file = MappedFile(path);
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+
+    bool valid = _file.Size() >= sizeof(MeshletPackHeader);
+    if (valid) {
+        const MeshletPackHeader& header = Header();
+        valid = std::memcmp(header.magic, PackMagic, sizeof(PackMagic)) == 0
+             && header.version == Version
+             && header.headerSize == sizeof(MeshletPackHeader)
+             && header.key == expectedKey;
+
+        for (size_t i = 0; valid && i < static_cast<size_t>(MeshletPackStream::Count); ++i) {
+            const auto& stream = header.streams[i];
+            valid = stream.offset % Alignment == 0
+                 && stream.offset <= _file.Size()
+                 && stream.size <= _file.Size() - stream.offset
+                 && stream.size == stream.count * StreamElementSizes[i];
+        }
+    }
+
+    if (!valid) {
+        _file.Close();
+    }
+    return valid;
+}
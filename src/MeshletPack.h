@@ -0,0 +1,137 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "MeshTypes.h"
+#include "MeshletBounds.h"
+#include "MeshletBuilder.h"
+#include "ObjLoader.h"
+#include "VertexQuantization.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+
+// Cooked meshlet cache file.
+//
+// Layout: a header followed by the vertex, meshlet, unique vertex index and primitive index streams,
+// then the quantized vertex and position bounds streams (MeshletVertexFormat::Quantized) and the
+// position, normal and texture coordinate streams (MeshletVertexFormat::Split). Only the streams
+// of the pack's vertex format are filled, the others are empty. Every pack ends with the
+// PackedMeshletBounds of its meshlets for culling.
+// Every stream starts on a MeshletPack::Alignment boundary, so a mapped pack can be memcpy'd
+// stream by stream straight into upload heaps. Packs are keyed by a hash of the source file
+// contents and the builder parameters; a pack with a different key or version is ignored.
+
+enum class MeshletPackStream : uint32_t
+{
+    Vertices = 0,
+    Meshlets,
+    UniqueVertexIndices,
+    PrimitiveIndices,
+    QuantizedVertices,
+    PositionBounds,
+    Positions,
+    Normals,
+    TextureCoordinates,
+    Bounds,
+    Count
+};
+
+struct MeshletPackHeader
+{
+    struct Stream
+    {
+        uint64_t offset;
+        uint64_t size;      // In bytes
+        uint64_t count;     // In elements
+    };
+
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    headerSize;
+    uint64_t    key;
+    uint32_t    maxVertices;
+    uint32_t    maxPrimitives;
+    Stream      streams[static_cast<size_t>(MeshletPackStream::Count)];
+};
+
+// Writes a pack stream by stream into a temporary file and moves it in place on Finish(),
+// so readers never see a half written pack. Streams have to be written in MeshletPackStream order,
+// skipped ones stay empty.
+class MeshletPackWriter
+{
+public:
+    MeshletPackWriter(const std::filesystem::path& path, uint64_t key, const MeshletBuildParams& params);
+    ~MeshletPackWriter();
+
+    MeshletPackWriter(const MeshletPackWriter&) = delete;
+    MeshletPackWriter& operator=(const MeshletPackWriter&) = delete;
+
+    void BeginStream(MeshletPackStream stream, size_t elementSize);
+    void Append(const void* data, size_t size);
+    void Finish();
+
+    uint64_t BytesWritten() const { return _offset; }
+
+private:
+    void Write(const void* data, size_t size);
+    void Pad();
+
+    std::filesystem::path   _path;
+    std::filesystem::path   _tempPath;
+    FILE*                   _file = nullptr;
+    MeshletPackHeader       _header = {};
+    int                     _stream = -1;
+    size_t                  _elementSize = 0;
+    uint64_t                _offset = 0;
+};
+
+class MeshletPack
+{
+public:
+    static constexpr uint32_t Version = 5;
+    static constexpr uint64_t Alignment = 4096;
+
+    // Hash of the file contents combined with everything in params.
+    static uint64_t ComputeKey(const std::filesystem::path& source, const MeshletBuildParams& params);
+    static uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+    // vertices are written in params.vertexFormat, Quantized packs take them from quantized
+    static void Write(const std::filesystem::path& path, uint64_t key, const MeshletBuildParams& params,
+                      const std::vector<Vertex>& vertices, const MeshletData& meshlets, const std::vector<PackedMeshletBounds>& bounds,
+                      const QuantizedMesh* quantized = nullptr);
+
+    // positions has positionStride bytes between vertices: the mesh's vertices, or the position stream for Split packs
+    using BuildFunction = std::function<MeshletData(const ObjMesh& mesh, const Float3* positions, size_t positionStride)>;
+
+    // Maps the pack for source if it's up to date. Otherwise loads the OBJ, runs build, applies
+    // params.ordering (MeshletReorder::Apply), params.vertexLayout (MeshletLayout::Flatten) and
+    // params.primitiveFormat (PrimitiveEncoding::Encode) and params.vertexFormat
+    // (VertexQuantization::Encode) and writes a fresh pack first. Flat packs have an empty
+    // UniqueVertexIndices stream. Bounds are computed and packed after reordering, and quantized
+    // packs grow the bounds by the position error. Throws when the OBJ has no triangles.
+    static MeshletPack LoadOrCook(const std::filesystem::path& source, const std::filesystem::path& pack,
+                                  const MeshletBuildParams& params, const BuildFunction& build, bool* cacheHit = nullptr);
+
+    // Returns false when the file is missing, truncated, from another version or has a different key.
+    bool Open(const std::filesystem::path& path, uint64_t expectedKey);
+
+    const MeshletPackHeader& Header() const { return *reinterpret_cast<const MeshletPackHeader*>(_file.Data()); }
+
+    const void* StreamData(MeshletPackStream stream) const { return _file.Data() + Header().streams[static_cast<size_t>(stream)].offset; }
+    uint64_t StreamSize(MeshletPackStream stream) const { return Header().streams[static_cast<size_t>(stream)].size; }
+    uint64_t StreamCount(MeshletPackStream stream) const { return Header().streams[static_cast<size_t>(stream)].count; }
+
+    const Vertex* Vertices() const { return static_cast<const Vertex*>(StreamData(MeshletPackStream::Vertices)); }
+    const Float3* Positions() const { return static_cast<const Float3*>(StreamData(MeshletPackStream::Positions)); }
+    const QuantizedVertex* QuantizedVertices() const { return static_cast<const QuantizedVertex*>(StreamData(MeshletPackStream::QuantizedVertices)); }
+    const PositionBounds* QuantizationBounds() const { return static_cast<const PositionBounds*>(StreamData(MeshletPackStream::PositionBounds)); }
+    const Meshlet* Meshlets() const { return static_cast<const Meshlet*>(StreamData(MeshletPackStream::Meshlets)); }
+    const uint32_t* UniqueVertexIndices() const { return static_cast<const uint32_t*>(StreamData(MeshletPackStream::UniqueVertexIndices)); }
+    const uint32_t* PrimitiveIndices() const { return static_cast<const uint32_t*>(StreamData(MeshletPackStream::PrimitiveIndices)); }
+    const PackedMeshletBounds* Bounds() const { return static_cast<const PackedMeshletBounds*>(StreamData(MeshletPackStream::Bounds)); }
+
+private:
+    MappedFile _file;
+};
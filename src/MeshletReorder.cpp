@@ -0,0 +1,104 @@
+#include "MeshletReorder.h"
+
+#include "SpaceFillingCurve.h"
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <stdexcept>
+
+void MeshletReorder::SortMeshlets(MeshletData& data, const Float3* positions, size_t vertexCount, MeshletOrdering ordering, size_t positionStride)
+{
+    if (ordering == MeshletOrdering::Builder || data.meshlets.empty()) {
+        return;
+    }
+    auto position = [&](uint32_t vertex) -> const Float3&
+    {
+        if (vertex >= vertexCount) {
+            throw std::out_of_range("MeshletReorder: vertex index out of range");
+        }
+        return *reinterpret_cast<const Float3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * positionStride);
+    };
+
+    std::vector<Float3> centers(data.meshlets.size());
+    Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (size_t m = 0; m < data.meshlets.size(); ++m) {
+        const Meshlet& meshlet = data.meshlets[m];
+        Float3 sum = {};
+        for (uint32_t i = 0; i < meshlet.VertCount; ++i) {
+            sum = sum + position(data.uniqueVertexIndices[meshlet.VertOffset + i]);
+        }
+        centers[m] = sum * (1.f / std::max(1u, meshlet.VertCount));
+        lo = Min(lo, centers[m]);
+        hi = Max(hi, centers[m]);
+    }
+    const float extent = std::max({ hi.x - lo.x, hi.y - lo.y, hi.z - lo.z, 1e-20f });
+    const float scale = 1023.f / extent;
+
+    std::vector<uint64_t> keys(data.meshlets.size());
+    for (size_t m = 0; m < data.meshlets.size(); ++m) {
+        const uint32_t x = static_cast<uint32_t>(std::clamp((centers[m].x - lo.x) * scale, 0.f, 1023.f));
+        const uint32_t y = static_cast<uint32_t>(std::clamp((centers[m].y - lo.y) * scale, 0.f, 1023.f));
+        const uint32_t z = static_cast<uint32_t>(std::clamp((centers[m].z - lo.z) * scale, 0.f, 1023.f));
+        const uint32_t code = ordering == MeshletOrdering::Hilbert ? HilbertCode(x, y, z) : MortonCode(x, y, z);
+        keys[m] = (uint64_t(code) << 32) | m;
+    }
+    std::sort(keys.begin(), keys.end());
+
+    MeshletData sorted;
+    sorted.meshlets.reserve(data.meshlets.size());
+    sorted.uniqueVertexIndices.reserve(data.uniqueVertexIndices.size());
+    sorted.primitiveIndices.reserve(data.primitiveIndices.size());
+    for (uint64_t key : keys) {
+        Meshlet meshlet = data.meshlets[key & 0xFFFFFFFFu];
+        const auto vertices = data.uniqueVertexIndices.begin() + meshlet.VertOffset;
+        const auto primitives = data.primitiveIndices.begin() + meshlet.PrimOffset;
+        meshlet.VertOffset = static_cast<uint32_t>(sorted.uniqueVertexIndices.size());
+        meshlet.PrimOffset = static_cast<uint32_t>(sorted.primitiveIndices.size());
+        sorted.uniqueVertexIndices.insert(sorted.uniqueVertexIndices.end(), vertices, vertices + meshlet.VertCount);
+        sorted.primitiveIndices.insert(sorted.primitiveIndices.end(), primitives, primitives + meshlet.PrimCount);
+        sorted.meshlets.push_back(meshlet);
+    }
+    data = std::move(sorted);
+}
+
+std::vector<uint32_t> MeshletReorder::FirstUseVertexOrder(MeshletData& data, size_t vertexCount)
+{
+    const uint32_t unassigned = ~0u;
+    std::vector<uint32_t> remap(vertexCount, unassigned);
+    std::vector<uint32_t> order;
+    order.reserve(vertexCount);
+
+    for (uint32_t& vertex : data.uniqueVertexIndices) {
+        if (vertex >= vertexCount) {
+            throw std::out_of_range("MeshletReorder: vertex index out of range");
+        }
+        if (remap[vertex] == unassigned) {
+            remap[vertex] = static_cast<uint32_t>(order.size());
+            order.push_back(vertex);
+        }
+        vertex = remap[vertex];
+    }
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+        if (remap[vertex] == unassigned) {
+            order.push_back(static_cast<uint32_t>(vertex));
+        }
+    }
+    return order;
+}
+
+void MeshletReorder::Apply(ObjMesh& mesh, MeshletData& data, MeshletOrdering ordering)
+{
+    SortMeshlets(data, &mesh.vertices[0].position, mesh.vertices.size(), ordering, sizeof(Vertex));
+
+    const std::vector<uint32_t> order = FirstUseVertexOrder(data, mesh.vertices.size());
+    std::vector<uint32_t> remap(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        remap[order[i]] = static_cast<uint32_t>(i);
+    }
+    for (uint32_t& index : mesh.indices) {
+        index = remap[index];
+    }
+    PermuteVertices(mesh.vertices, order);
+}
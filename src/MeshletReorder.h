@@ -0,0 +1,38 @@
+#pragma once
+
+#include "MeshletBuilder.h"
+#include "ObjLoader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Memory locality post-process for built meshlets. DispatchMesh walks meshlets in buffer order, so
+// sorting them along a space filling curve makes neighbouring groups work on neighbouring surface,
+// and renumbering vertices in first-use order makes their Vertices[] fetches neighbouring memory.
+class MeshletReorder
+{
+public:
+    // Sorts meshlets by the curve code of their center and rewrites uniqueVertexIndices and
+    // primitiveIndices so offsets grow with the meshlet index again. Builder ordering is a no-op.
+    static void SortMeshlets(MeshletData& data, const Float3* positions, size_t vertexCount, MeshletOrdering ordering,
+                             size_t positionStride = sizeof(Float3));
+
+    // Renumbers vertices in the order the meshlets first reference them, unreferenced ones go last.
+    // uniqueVertexIndices are rewritten, the result lists the old index of every new vertex.
+    static std::vector<uint32_t> FirstUseVertexOrder(MeshletData& data, size_t vertexCount);
+
+    // SortMeshlets followed by FirstUseVertexOrder, applied to the mesh vertices and indices as well.
+    // Vertices are renumbered for Builder ordering too.
+    static void Apply(ObjMesh& mesh, MeshletData& data, MeshletOrdering ordering);
+
+    template<class T>
+    static void PermuteVertices(std::vector<T>& vertices, const std::vector<uint32_t>& order)
+    {
+        std::vector<T> permuted(order.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            permuted[i] = vertices[order[i]];
+        }
+        vertices = std::move(permuted);
+    }
+};
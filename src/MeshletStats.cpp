@@ -0,0 +1,187 @@
+#include "MeshletStats.h"
+
+#include "PrimitiveEncoding.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace {
+
+const double Pi = 3.14159265358979323846;
+
+const Float3& PositionAt(const Float3* positions, size_t stride, size_t index)
+{
+    return *reinterpret_cast<const Float3*>(reinterpret_cast<const uint8_t*>(positions) + index * stride);
+}
+
+void MeshSphere(const Float3* positions, size_t vertexCount, size_t stride, Float3& center, float& radius)
+{
+    Float3 low = { 0.f, 0.f, 0.f };
+    Float3 high = { 0.f, 0.f, 0.f };
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const Float3& p = PositionAt(positions, stride, i);
+        low = i ? Min(low, p) : p;
+        high = i ? Max(high, p) : p;
+    }
+    center = (low + high) * 0.5f;
+    radius = Length(high - low) * 0.5f;
+}
+
+void WriteDistribution(std::ostream& out, const char* name, const Distribution& d)
+{
+    out << "  \"" << name << "\": { \"min\": " << d.min << ", \"mean\": " << d.mean << ", \"p50\": " << d.p50
+        << ", \"p90\": " << d.p90 << ", \"p99\": " << d.p99 << ", \"max\": " << d.max << " },\n";
+}
+
+void WriteHistogram(std::ostream& out, const char* name, const std::vector<uint64_t>& histogram)
+{
+    out << "  \"" << name << "\": [";
+    for (size_t i = 0; i < histogram.size(); ++i) {
+        out << (i ? ", " : "") << histogram[i];
+    }
+    out << "],\n";
+}
+
+} // namespace
+
+Distribution Distribution::Of(std::vector<double> values)
+{
+    Distribution d;
+    if (values.empty()) {
+        return d;
+    }
+    std::sort(values.begin(), values.end());
+    auto percentile = [&](double p) { return values[std::min(values.size() - 1, size_t(p * values.size()))]; };
+
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    d.min = values.front();
+    d.max = values.back();
+    d.mean = sum / values.size();
+    d.p50 = percentile(0.5);
+    d.p90 = percentile(0.9);
+    d.p99 = percentile(0.99);
+    return d;
+}
+
+std::vector<Float3> CullingViews(const Float3* positions, size_t vertexCount, size_t positionStride, uint32_t viewCount, float distance)
+{
+    Float3 center;
+    float radius;
+    MeshSphere(positions, vertexCount, positionStride, center, radius);
+
+    // Fibonacci sphere, deterministic and close to uniform for any count
+    std::vector<Float3> views(viewCount);
+    const double goldenAngle = Pi * (3.0 - std::sqrt(5.0));
+    for (uint32_t i = 0; i < viewCount; ++i) {
+        const double y = 1.0 - 2.0 * (i + 0.5) / viewCount;
+        const double ring = std::sqrt(1.0 - y * y);
+        const double phi = goldenAngle * i;
+        const Float3 direction = { float(ring * std::cos(phi)), float(y), float(ring * std::sin(phi)) };
+        views[i] = center + direction * (radius * distance);
+    }
+    return views;
+}
+
+MeshletStats MeshletStats::Analyze(const MeshletData& data, const std::vector<MeshletBounds>& bounds, const Float3* positions, size_t vertexCount,
+                                   size_t positionStride, uint32_t viewCount)
+{
+    MeshletStats stats;
+    stats.meshlets = data.meshlets.size();
+    stats.vertices = vertexCount;
+    stats.uniqueVertexIndices = data.uniqueVertexIndices.size();
+    stats.duplicationRatio = vertexCount ? double(data.uniqueVertexIndices.size()) / vertexCount : 0.0;
+    stats.layout = MeshletLayout::Cost(data, vertexCount, sizeof(Vertex));
+    if (data.meshlets.empty()) {
+        return stats;
+    }
+
+    uint64_t vertices = 0;
+    for (const Meshlet& meshlet : data.meshlets) {
+        vertices += meshlet.VertCount;
+        stats.triangles += meshlet.PrimCount;
+
+        const size_t vertexBucket = meshlet.VertCount / HistogramBucket;
+        const size_t primitiveBucket = meshlet.PrimCount / HistogramBucket;
+        stats.vertexHistogram.resize(std::max(stats.vertexHistogram.size(), vertexBucket + 1));
+        stats.primitiveHistogram.resize(std::max(stats.primitiveHistogram.size(), primitiveBucket + 1));
+        ++stats.vertexHistogram[vertexBucket];
+        ++stats.primitiveHistogram[primitiveBucket];
+    }
+    stats.averageVertices = double(vertices) / stats.meshlets;
+    stats.averagePrimitives = double(stats.triangles) / stats.meshlets;
+
+    Float3 meshCenter;
+    float meshRadius;
+    MeshSphere(positions, vertexCount, positionStride, meshCenter, meshRadius);
+    const double radiusScale = meshRadius > 0.f ? 1.0 / meshRadius : 1.0;
+
+    std::vector<double> radii;
+    std::vector<double> angles;
+    radii.reserve(bounds.size());
+    angles.reserve(bounds.size());
+    for (const MeshletBounds& b : bounds) {
+        radii.push_back(b.radius * radiusScale);
+        if (b.coneCutoff > 1.f) {
+            ++stats.openCones;
+        } else {
+            angles.push_back(std::asin(std::min(1.0, double(b.coneCutoff))) * 180.0 / Pi);
+        }
+    }
+    stats.boundingRadius = Distribution::Of(std::move(radii));
+    stats.coneAngle = Distribution::Of(std::move(angles));
+
+    const std::vector<Float3> views = CullingViews(positions, vertexCount, positionStride, viewCount);
+    uint64_t culledMeshlets = 0;
+    uint64_t culledTriangles = 0;
+    for (const Float3& camera : views) {
+        for (size_t i = 0; i < bounds.size(); ++i) {
+            if (ConeCulled(bounds[i], camera)) {
+                ++culledMeshlets;
+                culledTriangles += data.meshlets[i].PrimCount;
+            }
+        }
+    }
+    stats.cullViews = viewCount;
+    if (viewCount) {
+        stats.coneCullMeshlets = double(culledMeshlets) / (double(stats.meshlets) * viewCount);
+        stats.coneCullTriangles = double(culledTriangles) / (double(stats.triangles) * viewCount);
+    }
+    return stats;
+}
+
+void MeshletStats::WriteJson(std::ostream& out) const
+{
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::setprecision(6);
+
+    out << "{\n";
+    out << "  \"meshlets\": " << meshlets << ",\n";
+    out << "  \"triangles\": " << triangles << ",\n";
+    out << "  \"vertices\": " << vertices << ",\n";
+    out << "  \"uniqueVertexIndices\": " << uniqueVertexIndices << ",\n";
+    out << "  \"duplicationRatio\": " << duplicationRatio << ",\n";
+    out << "  \"indexedLayoutBytes\": " << layout.IndexedBytes() << ",\n";
+    out << "  \"flatLayoutBytes\": " << layout.FlatBytes() << ",\n";
+    out << "  \"packedPrimitiveBytes\": " << PrimitiveEncoding::EncodedBytes(triangles, MeshletPrimitiveFormat::Packed10) << ",\n";
+    out << "  \"bytePrimitiveBytes\": " << PrimitiveEncoding::EncodedBytes(triangles, MeshletPrimitiveFormat::Bytes) << ",\n";
+    out << "  \"averageVertices\": " << averageVertices << ",\n";
+    out << "  \"averagePrimitives\": " << averagePrimitives << ",\n";
+    out << "  \"histogramBucket\": " << HistogramBucket << ",\n";
+    WriteHistogram(out, "vertexHistogram", vertexHistogram);
+    WriteHistogram(out, "primitiveHistogram", primitiveHistogram);
+    WriteDistribution(out, "boundingRadius", boundingRadius);
+    WriteDistribution(out, "coneAngle", coneAngle);
+    out << "  \"openCones\": " << openCones << ",\n";
+    out << "  \"cullViews\": " << cullViews << ",\n";
+    out << "  \"coneCullMeshlets\": " << coneCullMeshlets << ",\n";
+    out << "  \"coneCullTriangles\": " << coneCullTriangles << "\n";
+    out << "}\n";
+
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "MeshletBounds.h"
+#include "MeshletBuilder.h"
+#include "MeshletLayout.h"
+#include "VectorMath.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+struct Distribution
+{
+    double  min = 0.0;
+    double  mean = 0.0;
+    double  p50 = 0.0;
+    double  p90 = 0.0;
+    double  p99 = 0.0;
+    double  max = 0.0;
+
+    static Distribution Of(std::vector<double> values);
+};
+
+// Quality numbers of one meshlet build, see MeshletStats::Analyze.
+struct MeshletStats
+{
+    static constexpr uint32_t HistogramBucket = 8;
+
+    uint64_t                meshlets = 0;
+    uint64_t                triangles = 0;
+    uint64_t                vertices = 0;
+    uint64_t                uniqueVertexIndices = 0;
+
+    double                  averageVertices = 0.0;
+    double                  averagePrimitives = 0.0;
+    std::vector<uint64_t>   vertexHistogram;        // meshlets with [i * HistogramBucket, (i + 1) * HistogramBucket) vertices
+    std::vector<uint64_t>   primitiveHistogram;
+
+    double                  duplicationRatio = 0.0; // uniqueVertexIndices / vertices, 1 means no vertex is shared between meshlets
+    MeshletLayoutCost       layout;                 // Vertex sized vertices
+
+    Distribution            boundingRadius;         // in mesh radii, so numbers compare between meshes
+    Distribution            coneAngle;              // degrees, cones that can cull only
+    uint64_t                openCones = 0;          // normals spread over more than a hemisphere
+
+    uint32_t                cullViews = 0;
+    double                  coneCullMeshlets = 0.0; // fraction of meshlets rejected by the cone test, averaged over the views
+    double                  coneCullTriangles = 0.0;
+
+    static MeshletStats Analyze(const MeshletData& data, const std::vector<MeshletBounds>& bounds, const Float3* positions, size_t vertexCount,
+                                size_t positionStride = sizeof(Float3), uint32_t viewCount = 64);
+
+    void WriteJson(std::ostream& out) const;
+};
+
+// Fixed set of camera positions evenly spread on a sphere of distance * radius around the mesh bounds,
+// used wherever culling rates are estimated on the CPU.
+std::vector<Float3> CullingViews(const Float3* positions, size_t vertexCount, size_t positionStride, uint32_t viewCount, float distance = 3.f);
+
+// True when the whole meshlet faces away from the camera.
+inline bool ConeCulled(const MeshletBounds& bounds, const Float3& camera)
+{
+    const Float3 view = bounds.coneApex - camera;
+    const float length = Length(view);
+    return length > 0.f && Dot(view, bounds.coneAxis) >= bounds.coneCutoff * length;
+}
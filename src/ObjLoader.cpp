@@ -0,0 +1,544 @@
+#include "ObjLoader.h"
+
+#include "MappedFile.h"
+#include "Parallel.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t NoIndex = ~0u;
+constexpr size_t MinChunkSize = size_t(1) << 20;
+constexpr size_t ChunksPerThread = 8;
+
+struct Corner
+{
+    uint32_t position;
+    uint32_t texCoord;
+    uint32_t normal;
+
+    bool operator==(const Corner& other) const
+    {
+        return position == other.position && texCoord == other.texCoord && normal == other.normal;
+    }
+};
+
+struct CornerHash
+{
+    size_t operator()(const Corner& corner) const
+    {
+        uint64_t hash = corner.position;
+        hash = hash * 0x9E3779B97F4A7C15ull ^ corner.texCoord;
+        hash = hash * 0x9E3779B97F4A7C15ull ^ corner.normal;
+        return static_cast<size_t>(hash ^ (hash >> 29));
+    }
+};
+
+struct Chunk
+{
+    const char* begin;
+    const char* end;
+
+    // First pass
+    uint32_t positionCount = 0;
+    uint32_t texCoordCount = 0;
+    uint32_t normalCount = 0;
+
+    // Second pass
+    uint32_t positionBase = 0;
+    uint32_t texCoordBase = 0;
+    uint32_t normalBase = 0;
+    std::vector<Corner> corners;        // Three per triangle, already in output winding
+    std::vector<uint32_t> splitCorners; // Corners that don't match the first use of their position
+    size_t cornerBase = 0;
+};
+
+enum class LineType { Other, Position, TexCoord, Normal, Face };
+
+inline bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+inline bool IsDigit(char c)
+{
+    return static_cast<unsigned>(c - '0') < 10u;
+}
+
+inline const char* SkipSpaces(const char* p, const char* end)
+{
+    while (p < end && IsSpace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* NextLine(const char* p, const char* end)
+{
+    const void* newLine = std::memchr(p, '\n', end - p);
+    return newLine ? static_cast<const char*>(newLine) + 1 : end;
+}
+
+// Leaves p right after the keyword.
+inline LineType Classify(const char*& p, const char* end)
+{
+    p = SkipSpaces(p, end);
+    if (end - p < 2) {
+        return LineType::Other;
+    }
+    if (p[0] == 'v') {
+        if (IsSpace(p[1])) {
+            p += 1;
+            return LineType::Position;
+        }
+        if (end - p >= 3 && IsSpace(p[2])) {
+            if (p[1] == 't') {
+                p += 2;
+                return LineType::TexCoord;
+            }
+            if (p[1] == 'n') {
+                p += 2;
+                return LineType::Normal;
+            }
+        }
+        return LineType::Other;
+    }
+    if (p[0] == 'f' && IsSpace(p[1])) {
+        p += 1;
+        return LineType::Face;
+    }
+    return LineType::Other;
+}
+
+const double PowersOf10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Decimal float parser for the common OBJ case: up to 19 significant digits and small exponents
+// are converted with a single multiply or divide by an exact power of ten. Anything unusual
+// (long mantissas, huge exponents, inf/nan) falls back to strtod. Returns nullptr on garbage.
+const char* ParseFloat(const char* p, const char* end, float& value)
+{
+    p = SkipSpaces(p, end);
+    const char* start = p;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int significantDigits = 0;
+    int exponent = 0;
+    bool anyDigits = false;
+
+    for (; p < end && IsDigit(*p); ++p) {
+        anyDigits = true;
+        if (significantDigits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            significantDigits += mantissa != 0;
+        } else {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && IsDigit(*p); ++p) {
+            anyDigits = true;
+            if (significantDigits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                significantDigits += mantissa != 0;
+                --exponent;
+            }
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E') && anyDigits) {
+        const char* exponentStart = p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            ++p;
+        }
+        if (p < end && IsDigit(*p)) {
+            int explicitExponent = 0;
+            for (; p < end && IsDigit(*p); ++p) {
+                explicitExponent = std::min(explicitExponent * 10 + (*p - '0'), 100000);
+            }
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+        } else {
+            p = exponentStart;
+        }
+    }
+
+    if (anyDigits && significantDigits < 16 && exponent >= -22 && exponent <= 22) {
+        double result = static_cast<double>(mantissa);
+        result = exponent < 0 ? result / PowersOf10[-exponent] : result * PowersOf10[exponent];
+        value = static_cast<float>(negative ? -result : result);
+        return p;
+    }
+
+    // Slow path
+    const char* tokenEnd = start;
+    while (tokenEnd < end && !IsSpace(*tokenEnd) && *tokenEnd != '\r' && *tokenEnd != '\n') {
+        ++tokenEnd;
+    }
+    if (tokenEnd == start) {
+        return nullptr;
+    }
+    const std::string token(start, tokenEnd);
+    char* parsedEnd = nullptr;
+    value = std::strtof(token.c_str(), &parsedEnd);
+    if (parsedEnd == token.c_str()) {
+        return nullptr;
+    }
+    return start + (parsedEnd - token.c_str());
+}
+
+const char* ParseInt(const char* p, const char* end, int64_t& value)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p >= end || !IsDigit(*p)) {
+        return nullptr;
+    }
+    int64_t result = 0;
+    for (; p < end && IsDigit(*p); ++p) {
+        result = std::min<int64_t>(result * 10 + (*p - '0'), int64_t(1) << 40);
+    }
+    value = negative ? -result : result;
+    return p;
+}
+
+[[noreturn]] void ThrowParseError(const char* what, const char* text, const char* where)
+{
+    throw std::runtime_error(std::string("ObjLoader: ") + what + " at byte " + std::to_string(where - text));
+}
+
+void CountChunk(Chunk& chunk)
+{
+    for (const char* line = chunk.begin; line < chunk.end; line = NextLine(line, chunk.end)) {
+        const char* p = line;
+        switch (Classify(p, chunk.end)) {
+        case LineType::Position:    ++chunk.positionCount; break;
+        case LineType::TexCoord:    ++chunk.texCoordCount; break;
+        case LineType::Normal:      ++chunk.normalCount; break;
+        default: break;
+        }
+    }
+}
+
+struct Totals
+{
+    uint32_t positions;
+    uint32_t texCoords;
+    uint32_t normals;
+};
+
+uint32_t ResolveIndex(int64_t index, uint32_t chunkBase, uint32_t definedInChunk, uint32_t total)
+{
+    // OBJ indices are 1-based, negative values are relative to the last element defined so far.
+    const int64_t resolved = index > 0 ? index - 1 : int64_t(chunkBase) + definedInChunk + index;
+    return (index != 0 && resolved >= 0 && resolved < total) ? static_cast<uint32_t>(resolved) : NoIndex;
+}
+
+void ParseChunk(Chunk& chunk, const Totals& totals, bool ccw, const char* text,
+                Float3* positions, Float2* texCoords, Float3* normals)
+{
+    uint32_t positionCount = 0;
+    uint32_t texCoordCount = 0;
+    uint32_t normalCount = 0;
+    std::vector<Corner> polygon;
+
+    for (const char* line = chunk.begin; line < chunk.end; line = NextLine(line, chunk.end)) {
+        const char* p = line;
+        const char* end = chunk.end;
+
+        switch (Classify(p, end)) {
+        case LineType::Position: {
+            Float3& position = positions[chunk.positionBase + positionCount++];
+            if (!(p = ParseFloat(p, end, position.x)) || !(p = ParseFloat(p, end, position.y)) || !(p = ParseFloat(p, end, position.z))) {
+                ThrowParseError("malformed vertex position", text, line);
+            }
+            break;
+        }
+        case LineType::TexCoord: {
+            float u = 0.f;
+            float v = 0.f;
+            if (!(p = ParseFloat(p, end, u))) {
+                ThrowParseError("malformed texture coordinate", text, line);
+            }
+            // The second component is optional
+            const char* next = SkipSpaces(p, end);
+            if (next < end && (IsDigit(*next) || *next == '-' || *next == '+' || *next == '.')) {
+                if (!ParseFloat(next, end, v)) {
+                    ThrowParseError("malformed texture coordinate", text, line);
+                }
+            }
+            texCoords[chunk.texCoordBase + texCoordCount++] = Float2{ u, 1.f - v };
+            break;
+        }
+        case LineType::Normal: {
+            Float3& normal = normals[chunk.normalBase + normalCount++];
+            if (!(p = ParseFloat(p, end, normal.x)) || !(p = ParseFloat(p, end, normal.y)) || !(p = ParseFloat(p, end, normal.z))) {
+                ThrowParseError("malformed vertex normal", text, line);
+            }
+            break;
+        }
+        case LineType::Face: {
+            polygon.clear();
+            for (;;) {
+                p = SkipSpaces(p, end);
+                if (p >= end || *p == '\r' || *p == '\n' || *p == '#') {
+                    break;
+                }
+
+                int64_t position = 0;
+                int64_t texCoord = 0;
+                int64_t normal = 0;
+                bool hasTexCoord = false;
+                bool hasNormal = false;
+
+                if (!(p = ParseInt(p, end, position))) {
+                    ThrowParseError("malformed face", text, line);
+                }
+                if (p < end && *p == '/') {
+                    ++p;
+                    if (p < end && *p != '/') {
+                        if (!(p = ParseInt(p, end, texCoord))) {
+                            ThrowParseError("malformed face", text, line);
+                        }
+                        hasTexCoord = true;
+                    }
+                    if (p < end && *p == '/') {
+                        if (!(p = ParseInt(p + 1, end, normal))) {
+                            ThrowParseError("malformed face", text, line);
+                        }
+                        hasNormal = true;
+                    }
+                }
+
+                Corner corner;
+                corner.position = ResolveIndex(position, chunk.positionBase, positionCount, totals.positions);
+                corner.texCoord = hasTexCoord ? ResolveIndex(texCoord, chunk.texCoordBase, texCoordCount, totals.texCoords) : NoIndex;
+                corner.normal = hasNormal ? ResolveIndex(normal, chunk.normalBase, normalCount, totals.normals) : NoIndex;
+                if (corner.position == NoIndex || (hasTexCoord && corner.texCoord == NoIndex) || (hasNormal && corner.normal == NoIndex)) {
+                    ThrowParseError("face index out of range", text, line);
+                }
+                polygon.push_back(corner);
+            }
+
+            if (polygon.size() < 3) {
+                ThrowParseError("face with less than 3 vertices", text, line);
+            }
+
+            // Fan triangulation, same winding rules as WaveFrontReader
+            for (size_t i = 2; i < polygon.size(); ++i) {
+                chunk.corners.push_back(polygon[0]);
+                if (ccw) {
+                    chunk.corners.push_back(polygon[i - 1]);
+                    chunk.corners.push_back(polygon[i]);
+                } else {
+                    chunk.corners.push_back(polygon[i]);
+                    chunk.corners.push_back(polygon[i - 1]);
+                }
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+} // namespace
+
+ObjMesh ObjLoader::Load(const std::filesystem::path& path, bool ccw, unsigned threadCount)
+{
+    MappedFile file(path);
+    return Parse(reinterpret_cast<const char*>(file.Data()), file.Size(), ccw, threadCount);
+}
+
+ObjMesh ObjLoader::Parse(const char* text, size_t size, bool ccw, unsigned threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = DefaultThreadCount();
+    }
+
+    // Split into line aligned chunks. More chunks than threads keeps the cores busy when
+    // some parts of the file (faces vs vertices) are more expensive to parse than others.
+    std::vector<Chunk> chunks;
+    {
+        const size_t chunkCount = std::max<size_t>(1, std::min(size / MinChunkSize, size_t(threadCount) * ChunksPerThread));
+        const size_t chunkSize = size / chunkCount + 1;
+        const char* end = text + size;
+        for (const char* begin = text; begin < end;) {
+            const char* chunkEnd = begin + std::min<size_t>(chunkSize, end - begin);
+            chunkEnd = chunkEnd < end ? NextLine(chunkEnd, end) : end;
+            Chunk chunk;
+            chunk.begin = begin;
+            chunk.end = chunkEnd;
+            chunks.push_back(std::move(chunk));
+            begin = chunkEnd;
+        }
+    }
+
+    // First pass only counts elements, so each chunk knows where its positions, normals and
+    // texture coordinates start and relative indices can be resolved while parsing.
+    ParallelFor(chunks.size(), threadCount, [&](size_t i) { CountChunk(chunks[i]); });
+
+    Totals totals{};
+    {
+        uint64_t positions = 0;
+        uint64_t texCoords = 0;
+        uint64_t normals = 0;
+        for (auto& chunk : chunks) {
+            chunk.positionBase = static_cast<uint32_t>(positions);
+            chunk.texCoordBase = static_cast<uint32_t>(texCoords);
+            chunk.normalBase = static_cast<uint32_t>(normals);
+            positions += chunk.positionCount;
+            texCoords += chunk.texCoordCount;
+            normals += chunk.normalCount;
+        }
+        if (std::max({ positions, texCoords, normals }) >= NoIndex) {
+            throw std::runtime_error("ObjLoader: too many elements for 32-bit indices");
+        }
+        totals = Totals{ static_cast<uint32_t>(positions), static_cast<uint32_t>(texCoords), static_cast<uint32_t>(normals) };
+    }
+
+    std::vector<Float3> positions(totals.positions);
+    std::vector<Float2> texCoords(totals.texCoords);
+    std::vector<Float3> normals(totals.normals);
+
+    ParallelFor(chunks.size(), threadCount, [&](size_t i) {
+        ParseChunk(chunks[i], totals, ccw, text, positions.data(), texCoords.data(), normals.data());
+    });
+
+    size_t cornerCount = 0;
+    for (auto& chunk : chunks) {
+        chunk.cornerBase = cornerCount;
+        cornerCount += chunk.corners.size();
+    }
+    if (cornerCount >= NoIndex) {
+        throw std::runtime_error("ObjLoader: too many triangles for 32-bit indices");
+    }
+
+    // Deduplicate corners into vertices. The first corner (in file order) that references a position
+    // decides the "primary" texcoord/normal pair of that position; every corner matching it shares
+    // one vertex. Corners with a different pair are rare (UV seams, hard edges) and get deduplicated
+    // through a hash map.
+    std::unique_ptr<std::atomic<uint32_t>[]> firstCorner(new std::atomic<uint32_t>[totals.positions]);
+    for (uint32_t i = 0; i < totals.positions; ++i) {
+        firstCorner[i].store(NoIndex, std::memory_order_relaxed);
+    }
+
+    ParallelFor(chunks.size(), threadCount, [&](size_t i) {
+        const Chunk& chunk = chunks[i];
+        for (size_t c = 0; c < chunk.corners.size(); ++c) {
+            const uint32_t cornerIndex = static_cast<uint32_t>(chunk.cornerBase + c);
+            std::atomic<uint32_t>& first = firstCorner[chunk.corners[c].position];
+            uint32_t current = first.load(std::memory_order_relaxed);
+            while (cornerIndex < current && !first.compare_exchange_weak(current, cornerIndex, std::memory_order_relaxed)) {
+            }
+        }
+    });
+
+    std::vector<uint32_t> primaryTexCoord(totals.positions, NoIndex);
+    std::vector<uint32_t> primaryNormal(totals.positions, NoIndex);
+    ParallelFor(chunks.size(), threadCount, [&](size_t i) {
+        const Chunk& chunk = chunks[i];
+        for (size_t c = 0; c < chunk.corners.size(); ++c) {
+            const Corner& corner = chunk.corners[c];
+            if (firstCorner[corner.position].load(std::memory_order_relaxed) == chunk.cornerBase + c) {
+                primaryTexCoord[corner.position] = corner.texCoord;
+                primaryNormal[corner.position] = corner.normal;
+            }
+        }
+    });
+
+    ParallelFor(chunks.size(), threadCount, [&](size_t i) {
+        Chunk& chunk = chunks[i];
+        for (size_t c = 0; c < chunk.corners.size(); ++c) {
+            const Corner& corner = chunk.corners[c];
+            if (primaryTexCoord[corner.position] != corner.texCoord || primaryNormal[corner.position] != corner.normal) {
+                chunk.splitCorners.push_back(static_cast<uint32_t>(c));
+            }
+        }
+    });
+
+    // Assign vertex ids: primary vertices in position order, split vertices after them in file order.
+    std::vector<uint32_t> positionVertex(totals.positions, NoIndex);
+    uint32_t vertexCount = 0;
+    for (uint32_t i = 0; i < totals.positions; ++i) {
+        if (firstCorner[i].load(std::memory_order_relaxed) != NoIndex) {
+            positionVertex[i] = vertexCount++;
+        }
+    }
+    firstCorner.reset();
+
+    std::unordered_map<Corner, uint32_t, CornerHash> splitVertices;
+    std::vector<Corner> splitVertexCorners;
+    for (const auto& chunk : chunks) {
+        for (uint32_t c : chunk.splitCorners) {
+            if (splitVertices.emplace(chunk.corners[c], vertexCount + static_cast<uint32_t>(splitVertexCorners.size())).second) {
+                splitVertexCorners.push_back(chunk.corners[c]);
+            }
+        }
+    }
+
+    ObjMesh mesh;
+    mesh.vertices.resize(vertexCount + splitVertexCorners.size());
+    mesh.indices.resize(cornerCount);
+
+    auto makeVertex = [&](uint32_t position, uint32_t texCoord, uint32_t normal)
+    {
+        Vertex vertex = {};
+        vertex.position = positions[position];
+        if (normal != NoIndex) {
+            vertex.normal = normals[normal];
+        }
+        if (texCoord != NoIndex) {
+            vertex.textureCoordinate = texCoords[texCoord];
+        }
+        return vertex;
+    };
+
+    const size_t positionBlock = 1 << 16;
+    ParallelFor((totals.positions + positionBlock - 1) / positionBlock, threadCount, [&](size_t block) {
+        const size_t end = std::min<size_t>((block + 1) * positionBlock, totals.positions);
+        for (size_t i = block * positionBlock; i < end; ++i) {
+            if (positionVertex[i] != NoIndex) {
+                mesh.vertices[positionVertex[i]] = makeVertex(static_cast<uint32_t>(i), primaryTexCoord[i], primaryNormal[i]);
+            }
+        }
+    });
+    for (size_t i = 0; i < splitVertexCorners.size(); ++i) {
+        const Corner& corner = splitVertexCorners[i];
+        mesh.vertices[vertexCount + i] = makeVertex(corner.position, corner.texCoord, corner.normal);
+    }
+
+    ParallelFor(chunks.size(), threadCount, [&](size_t i) {
+        const Chunk& chunk = chunks[i];
+        uint32_t* indices = mesh.indices.data() + chunk.cornerBase;
+        size_t nextSplit = 0;
+        for (size_t c = 0; c < chunk.corners.size(); ++c) {
+            if (nextSplit < chunk.splitCorners.size() && chunk.splitCorners[nextSplit] == c) {
+                indices[c] = splitVertices.at(chunk.corners[c]);
+                ++nextSplit;
+            } else {
+                indices[c] = positionVertex[chunk.corners[c].position];
+            }
+        }
+    });
+
+    return mesh;
+}
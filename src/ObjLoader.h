@@ -0,0 +1,29 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+struct ObjMesh
+{
+    std::vector<Vertex>     vertices;
+    std::vector<uint32_t>   indices;
+};
+
+// Multi-threaded Wavefront OBJ reader producing the same layout as WaveFrontReader<uint32_t>:
+// v/vt/vn triplets become unique vertices, polygons are fan-triangulated and texture V is flipped.
+// The file is memory mapped, split into line aligned chunks and every chunk is parsed on its own
+// thread. Materials, groups and smoothing groups are ignored.
+//
+// The output doesn't depend on the number of threads. Vertices are ordered by position index,
+// so a mesh that only has positions keeps its original vertex order.
+class ObjLoader
+{
+public:
+    // threadCount == 0 uses all cores. Throws std::runtime_error on I/O or syntax errors.
+    static ObjMesh Load(const std::filesystem::path& path, bool ccw = true, unsigned threadCount = 0);
+    static ObjMesh Parse(const char* text, size_t size, bool ccw = true, unsigned threadCount = 0);
+};
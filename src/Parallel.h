@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+inline unsigned DefaultThreadCount()
+{
+    const unsigned count = std::thread::hardware_concurrency();
+    return count ? count : 1;
+}
+
+// Calls func(i) for every i in [0, count) using up to threadCount threads (0 means all cores).
+// Items are handed out dynamically, so func must not care which thread runs it.
+// The first exception thrown by any item is rethrown on the calling thread.
+template<class Func>
+void ParallelFor(size_t count, unsigned threadCount, Func&& func)
+{
+    if (threadCount == 0) {
+        threadCount = DefaultThreadCount();
+    }
+    threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, count));
+
+    if (threadCount <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            func(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextItem{ 0 };
+    std::exception_ptr error;
+    std::mutex errorLock;
+
+    auto worker = [&]()
+    {
+        try {
+            for (size_t i = nextItem++; i < count; i = nextItem++) {
+                func(i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorLock);
+            if (!error) {
+                error = std::current_exception();
+            }
+            nextItem = count;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (unsigned i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,46 @@
+#include "PrimitiveCulling.h"
+
+#include <algorithm>
+#include <cmath>
+
+Float2 PrimitiveCulling::ToPixels(const Float4& clip, float viewportWidth, float viewportHeight)
+{
+    return Float2{ (clip.x / clip.w * 0.5f + 0.5f) * viewportWidth, (clip.y / clip.w * -0.5f + 0.5f) * viewportHeight };
+}
+
+// Keep in sync with CullPrimitive in MeshletMS.hlsl
+PrimitiveCullResult PrimitiveCulling::Classify(const Float4& c0, const Float4& c1, const Float4& c2, float viewportWidth, float viewportHeight)
+{
+    if (c0.w <= 0.f || c1.w <= 0.f || c2.w <= 0.f) {
+        return PrimitiveCullResult::Visible;
+    }
+
+    if ((c0.x < -c0.w && c1.x < -c1.w && c2.x < -c2.w) || (c0.x > c0.w && c1.x > c1.w && c2.x > c2.w)
+        || (c0.y < -c0.w && c1.y < -c1.w && c2.y < -c2.w) || (c0.y > c0.w && c1.y > c1.w && c2.y > c2.w)
+        || (c0.z < 0.f && c1.z < 0.f && c2.z < 0.f) || (c0.z > c0.w && c1.z > c1.w && c2.z > c2.w)) {
+        return PrimitiveCullResult::Frustum;
+    }
+
+    const Float2 p0 = ToPixels(c0, viewportWidth, viewportHeight);
+    const Float2 p1 = ToPixels(c1, viewportWidth, viewportHeight);
+    const Float2 p2 = ToPixels(c2, viewportWidth, viewportHeight);
+
+    // y points down, so counterclockwise on screen is negative
+    const float area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+    if (area > 0.f) {
+        return PrimitiveCullResult::Backface;
+    }
+    if (area == 0.f) {
+        return PrimitiveCullResult::Degenerate;
+    }
+
+    // Pixel centers sit at k + 0.5, a box misses all of them in x when no integer lies in [min - 0.5, max - 0.5]
+    const float minX = std::min({ p0.x, p1.x, p2.x }) - SubpixelMargin;
+    const float maxX = std::max({ p0.x, p1.x, p2.x }) + SubpixelMargin;
+    const float minY = std::min({ p0.y, p1.y, p2.y }) - SubpixelMargin;
+    const float maxY = std::max({ p0.y, p1.y, p2.y }) + SubpixelMargin;
+    if (std::ceil(minX - 0.5f) > std::floor(maxX - 0.5f) || std::ceil(minY - 0.5f) > std::floor(maxY - 0.5f)) {
+        return PrimitiveCullResult::SmallPrimitive;
+    }
+    return PrimitiveCullResult::Visible;
+}
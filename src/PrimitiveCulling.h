@@ -0,0 +1,34 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+#include <cstdint>
+
+// First test that rejects a triangle, in the order PrimitiveCulling::Classify runs them.
+enum class PrimitiveCullResult : uint32_t
+{
+    Visible         = 0,
+    Frustum         = 1,    // every vertex outside the same clip plane
+    Backface        = 2,    // clockwise on screen, the rasterizer culls it (CULL_MODE_BACK, FrontCounterClockwise)
+    Degenerate      = 3,    // zero area on screen
+    SmallPrimitive  = 4,    // bounding box between pixel centers, covers no sample
+    Count
+};
+
+// CPU reference of the per-primitive culling in MeshletMS.hlsl. Only rejects triangles the rasterizer
+// wouldn't produce a fragment for with one sample per pixel at the pixel center.
+//
+// Unlike MeshletCulling this is not bit exact with the shader, GPU division rounds differently and the
+// rasterizer snaps vertices to 1/256 pixel. The small primitive test widens the bounding box by
+// SubpixelMargin to stay conservative.
+class PrimitiveCulling
+{
+public:
+    static constexpr float SubpixelMargin = 1.f / 256.f;
+
+    // Clip space (mul(float4(p, 1), WorldViewProj)) to render target pixels, y down
+    static Float2 ToPixels(const Float4& clip, float viewportWidth, float viewportHeight);
+
+    // Triangles with a vertex at or behind the camera plane are always visible, their projection is meaningless.
+    static PrimitiveCullResult Classify(const Float4& c0, const Float4& c1, const Float4& c2, float viewportWidth, float viewportHeight);
+};
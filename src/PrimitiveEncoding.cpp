@@ -0,0 +1,36 @@
+#include "PrimitiveEncoding.h"
+
+#include <stdexcept>
+
+uint64_t PrimitiveEncoding::EncodedBytes(uint64_t triangleCount, MeshletPrimitiveFormat format)
+{
+    if (format == MeshletPrimitiveFormat::Bytes) {
+        // Whole words plus one so the last triangle's Load2 doesn't run off the end
+        return ((triangleCount * 3 + 3) / 4 + 1) * sizeof(uint32_t);
+    }
+    return triangleCount * sizeof(uint32_t);
+}
+
+std::vector<uint32_t> PrimitiveEncoding::EncodeBytes(const uint32_t* packedTriangles, size_t triangleCount)
+{
+    std::vector<uint32_t> words(EncodedBytes(triangleCount, MeshletPrimitiveFormat::Bytes) / sizeof(uint32_t));
+    for (size_t t = 0; t < triangleCount; ++t) {
+        uint32_t indices[3];
+        UnpackTriangle(packedTriangles[t], indices[0], indices[1], indices[2]);
+        for (int corner = 0; corner < 3; ++corner) {
+            if (indices[corner] > 0xFF) {
+                throw std::out_of_range("PrimitiveEncoding: meshlet local index doesn't fit a byte");
+            }
+            const size_t byte = t * 3 + corner;
+            words[byte / 4] |= indices[corner] << ((byte & 3) * 8);
+        }
+    }
+    return words;
+}
+
+void PrimitiveEncoding::Encode(MeshletData& data, MeshletPrimitiveFormat format)
+{
+    if (format == MeshletPrimitiveFormat::Bytes) {
+        data.primitiveIndices = EncodeBytes(data.primitiveIndices.data(), data.primitiveIndices.size());
+    }
+}
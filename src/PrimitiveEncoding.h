@@ -0,0 +1,37 @@
+#pragma once
+
+#include "MeshletBuilder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Meshlet local indices never exceed 255 (MeshletConfig caps meshlets at 256 vertices), so the
+// Bytes format stores each triangle as three consecutive bytes instead of 10 bits in a uint32.
+// The byte stream is kept in little endian uint32 words, the way ByteAddressBuffer loads it, and
+// padded so a Load2 at any triangle stays inside the buffer. PrimOffset still counts triangles.
+class PrimitiveEncoding
+{
+public:
+    // Encoded size of triangleCount triangles
+    static uint64_t EncodedBytes(uint64_t triangleCount, MeshletPrimitiveFormat format);
+
+    // PackTriangle encoded triangles -> Bytes format words
+    static std::vector<uint32_t> EncodeBytes(const uint32_t* packedTriangles, size_t triangleCount);
+
+    // Reference decoder, the same arithmetic as LoadPrimitive in MeshletMS.hlsl
+    static void DecodeBytes(const uint32_t* words, uint32_t triangle, uint32_t& i0, uint32_t& i1, uint32_t& i2)
+    {
+        const uint32_t byteOffset = triangle * 3;
+        const uint32_t low = words[byteOffset / 4];
+        const uint32_t high = words[byteOffset / 4 + 1];
+        const uint32_t shift = (byteOffset & 3) * 8;
+        const uint32_t packed = shift ? (low >> shift) | (high << (32 - shift)) : low;
+        i0 = packed & 0xFF;
+        i1 = (packed >> 8) & 0xFF;
+        i2 = (packed >> 16) & 0xFF;
+    }
+
+    // Re-encodes data.primitiveIndices in format. Packed10 is a no-op.
+    static void Encode(MeshletData& data, MeshletPrimitiveFormat format);
+};
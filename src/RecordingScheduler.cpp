@@ -0,0 +1,35 @@
+#include "RecordingScheduler.h"
+
+#include <stdexcept>
+
+RecordingScheduler::RecordingScheduler(CommandListBackend& backend, WorkStealingPool& pool, uint32_t framesInFlight)
+    : _backend(backend), _pool(pool), _allocatorFrames(size_t(framesInFlight) * pool.WorkerCount(), 0)
+{
+    if (framesInFlight == 0) {
+        throw std::invalid_argument("At least one frame has to be in flight");
+    }
+}
+
+void RecordingScheduler::RecordFrame(uint32_t frameSlot, uint32_t jobCount, const RecordJob& record)
+{
+    const uint32_t workers = _pool.WorkerCount();
+    if (frameSlot >= _allocatorFrames.size() / workers) {
+        throw std::out_of_range("Frame slot out of range");
+    }
+    const uint64_t frame = ++_frameIndex;
+    _backend.PrepareLists(frameSlot, jobCount);
+
+    _pool.Run(jobCount, [&](uint32_t job, uint32_t worker)
+    {
+        uint64_t& allocatorFrame = _allocatorFrames[size_t(frameSlot) * workers + worker];
+        if (allocatorFrame != frame) {
+            _backend.ResetAllocator(frameSlot, worker);
+            allocatorFrame = frame;
+        }
+        _backend.OpenList(frameSlot, worker, job);
+        record(job, worker);
+        _backend.CloseList(frameSlot, job);
+    });
+
+    _backend.Submit(frameSlot, jobCount);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "WorkStealingPool.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// The part of a graphics API multi-threaded recording needs. Every (frame slot, worker) pair owns a
+// command allocator, every frame slot a growing set of command lists. D3D12Recording in main.cpp
+// wraps ID3D12CommandAllocator and ID3D12GraphicsCommandList6, MeshletTool's record-bench records
+// into a mock that checks the rules.
+class CommandListBackend
+{
+public:
+    virtual ~CommandListBackend() = default;
+
+    // On the recording thread, before any job: frameSlot needs at least listCount lists
+    virtual void PrepareLists(uint32_t frameSlot, uint32_t listCount) = 0;
+    // The GPU is done with what the allocator of (frameSlot, worker) holds
+    virtual void ResetAllocator(uint32_t frameSlot, uint32_t worker) = 0;
+    // Starts list of frameSlot recording into the allocator of (frameSlot, worker)
+    virtual void OpenList(uint32_t frameSlot, uint32_t worker, uint32_t list) = 0;
+    virtual void CloseList(uint32_t frameSlot, uint32_t list) = 0;
+    // Lists [0, listCount) of frameSlot, in that order, in one submission
+    virtual void Submit(uint32_t frameSlot, uint32_t listCount) = 0;
+};
+
+// Records a frame as independent jobs on a WorkStealingPool, job i into list i, and submits the
+// lists in job order however the jobs were spread over the threads. Each worker resets its
+// allocator of the frame slot before its first list of the frame, so allocators are only ever used
+// by one thread and only reset once the caller made sure the slot is free (FrameScheduler).
+class RecordingScheduler
+{
+public:
+    using RecordJob = std::function<void(uint32_t job, uint32_t worker)>;
+
+    RecordingScheduler(CommandListBackend& backend, WorkStealingPool& pool, uint32_t framesInFlight);
+
+    // record(job, worker) fills list job of frameSlot, which is open when it runs
+    void RecordFrame(uint32_t frameSlot, uint32_t jobCount, const RecordJob& record);
+
+    uint32_t WorkerCount() const { return _pool.WorkerCount(); }
+    uint64_t FrameIndex() const { return _frameIndex; }
+
+private:
+    CommandListBackend&     _backend;
+    WorkStealingPool&       _pool;
+    uint64_t                _frameIndex = 0;
+    // Last frame every (frame slot, worker) allocator was reset for, only touched by its worker
+    std::vector<uint64_t>   _allocatorFrames;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+// 30-bit codes of points on a 1024^3 grid. Nearby codes are nearby points, so sorting by them
+// gives spatially coherent orders.
+
+// Spreads the low 10 bits so there are two zero bits between each of them
+inline uint32_t SpreadBits(uint32_t value)
+{
+    value &= 0x3FF;
+    value = (value | (value << 16)) & 0x030000FF;
+    value = (value | (value << 8)) & 0x0300F00F;
+    value = (value | (value << 4)) & 0x030C30C3;
+    value = (value | (value << 2)) & 0x09249249;
+    return value;
+}
+
+inline uint32_t MortonCode(uint32_t x, uint32_t y, uint32_t z)
+{
+    return SpreadBits(x) | (SpreadBits(y) << 1) | (SpreadBits(z) << 2);
+}
+
+// Hilbert curves never jump, consecutive codes are always neighbouring cells. Skilling's
+// "Programming the Hilbert curve" transpose, interleaved like MortonCode.
+inline uint32_t HilbertCode(uint32_t x, uint32_t y, uint32_t z)
+{
+    uint32_t axes[3] = { x & 0x3FF, y & 0x3FF, z & 0x3FF };
+
+    for (uint32_t q = 1u << 9; q > 1; q >>= 1) {
+        const uint32_t p = q - 1;
+        for (int i = 0; i < 3; ++i) {
+            if (axes[i] & q) {
+                axes[0] ^= p;
+            } else {
+                const uint32_t t = (axes[0] ^ axes[i]) & p;
+                axes[0] ^= t;
+                axes[i] ^= t;
+            }
+        }
+    }
+
+    axes[1] ^= axes[0];
+    axes[2] ^= axes[1];
+    uint32_t t = 0;
+    for (uint32_t q = 1u << 9; q > 1; q >>= 1) {
+        if (axes[2] & q) {
+            t ^= q - 1;
+        }
+    }
+    for (uint32_t& axis : axes) {
+        axis ^= t;
+    }
+
+    return SpreadBits(axes[2]) | (SpreadBits(axes[1]) << 1) | (SpreadBits(axes[0]) << 2);
+}
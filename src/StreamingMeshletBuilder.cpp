@@ -0,0 +1,370 @@
+#include "StreamingMeshletBuilder.h"
+
+#include "MeshletBuilder.h"
+#include "MeshletPack.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t MaxBins = 4096;
+constexpr size_t BlockTriangles = 1024;
+constexpr uint64_t MinTrianglesPerBin = 1 << 16;
+// Working set of one triangle while a bin is being built: input, reordered copy, sort keys,
+// BuildSubset's hash table and local indices, builder output.
+constexpr uint64_t BuildBytesPerTriangle = 128;
+
+template<class T>
+uint64_t CapacityBytes(const std::vector<T>& v)
+{
+    return v.capacity() * sizeof(T);
+}
+
+// Scratch file removed on destruction.
+class TempFile
+{
+public:
+    explicit TempFile(const std::filesystem::path& path) : _path(path)
+    {
+#ifdef _WIN32
+        _file = _wfopen(path.c_str(), L"w+b");
+#else
+        _file = std::fopen(path.c_str(), "w+b");
+#endif
+        if (!_file) {
+            throw std::runtime_error("Cannot create temporary file: " + path.string());
+        }
+    }
+
+    ~TempFile()
+    {
+        std::fclose(_file);
+        std::error_code ignored;
+        std::filesystem::remove(_path, ignored);
+    }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    uint64_t Size() const { return _size; }
+
+    void Append(const void* data, size_t size)
+    {
+        if (size == 0) {
+            return;
+        }
+        if (_reading) {
+            Seek(_size);
+            _reading = false;
+        }
+        if (std::fwrite(data, 1, size, _file) != size) {
+            throw std::runtime_error("Failed writing temporary file: " + _path.string());
+        }
+        _size += size;
+    }
+
+    void Read(uint64_t offset, void* data, size_t size)
+    {
+        Seek(offset);
+        _reading = true;
+        if (std::fread(data, 1, size, _file) != size) {
+            throw std::runtime_error("Failed reading temporary file: " + _path.string());
+        }
+    }
+
+    // Streams the whole file into the pack
+    void CopyTo(MeshletPackWriter& writer, std::vector<uint8_t>& buffer)
+    {
+        for (uint64_t offset = 0; offset < _size; offset += buffer.size()) {
+            const size_t size = static_cast<size_t>(std::min<uint64_t>(buffer.size(), _size - offset));
+            Read(offset, buffer.data(), size);
+            writer.Append(buffer.data(), size);
+        }
+    }
+
+private:
+    void Seek(uint64_t offset)
+    {
+#ifdef _WIN32
+        const int result = _fseeki64(_file, static_cast<__int64>(offset), SEEK_SET);
+#else
+        const int result = fseeko(_file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+        if (result != 0) {
+            throw std::runtime_error("Failed seeking temporary file: " + _path.string());
+        }
+    }
+
+    std::filesystem::path   _path;
+    FILE*                   _file = nullptr;
+    uint64_t                _size = 0;
+    bool                    _reading = false;
+};
+
+struct SpillBlock
+{
+    uint32_t bin;
+    uint32_t triangles;
+    uint64_t offset;
+};
+
+struct Grid
+{
+    Float3      origin;
+    float       inverseCellSize;
+    uint32_t    dims[3];
+
+    uint32_t CellCount() const { return dims[0] * dims[1] * dims[2]; }
+
+    uint16_t Cell(const Float3& p) const
+    {
+        auto axis = [&](float value, float origin, uint32_t dim)
+        {
+            const float cell = (value - origin) * inverseCellSize;
+            return std::min<uint32_t>(static_cast<uint32_t>(std::max(cell, 0.f)), dim - 1);
+        };
+        const uint32_t x = axis(p.x, origin.x, dims[0]);
+        const uint32_t y = axis(p.y, origin.y, dims[1]);
+        const uint32_t z = axis(p.z, origin.z, dims[2]);
+        return static_cast<uint16_t>((z * dims[1] + y) * dims[0] + x);
+    }
+};
+
+// Roughly cubic cells, about targetCells of them over the bounding box.
+Grid MakeGrid(const Float3& minimum, const Float3& maximum, uint32_t targetCells)
+{
+    const float extents[3] = { maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z };
+    const float largest = std::max({ extents[0], extents[1], extents[2], 1e-20f });
+
+    // Flat meshes would otherwise collapse the cell volume to zero
+    float clamped[3];
+    for (int i = 0; i < 3; ++i) {
+        clamped[i] = std::max(extents[i], largest / targetCells);
+    }
+    float cellSize = std::cbrt(clamped[0] * clamped[1] * clamped[2] / targetCells);
+
+    Grid grid;
+    grid.origin = minimum;
+    for (;;) {
+        for (int i = 0; i < 3; ++i) {
+            grid.dims[i] = std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(extents[i] / cellSize)));
+        }
+        if (uint64_t(grid.dims[0]) * grid.dims[1] * grid.dims[2] <= MaxBins) {
+            break;
+        }
+        cellSize *= 1.1f;
+    }
+    grid.inverseCellSize = 1.f / cellSize;
+    return grid;
+}
+
+} // namespace
+
+StreamingBuildStats StreamingMeshletBuilder::Build(MeshStream& source, const std::filesystem::path& output, uint64_t key, const StreamingBuildOptions& options)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    StreamingBuildStats stats;
+    const uint64_t vertexCount = source.VertexCount();
+    const uint64_t triangleCount = source.TriangleCount();
+    if (vertexCount >= std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("StreamingMeshletBuilder: too many vertices for 32-bit indices");
+    }
+
+    // Split the budget. Bin ids of all vertices are the only allocation that grows with the mesh.
+    const uint64_t binIdBytes = vertexCount * sizeof(uint16_t);
+    if (binIdBytes * 2 > options.memoryBudget) {
+        throw std::runtime_error("StreamingMeshletBuilder: memory budget too small, need at least " + std::to_string(binIdBytes * 2 / (1024 * 1024) + 1) + " MB for this mesh");
+    }
+    const uint64_t workingBytes = options.memoryBudget - binIdBytes;
+    const size_t batchVertices = static_cast<size_t>(std::clamp<uint64_t>(workingBytes / 8 / sizeof(Vertex), 4096, 1 << 20));
+    const size_t batchTriangles = static_cast<size_t>(std::clamp<uint64_t>(workingBytes / 8 / (3 * sizeof(uint32_t)), 4096, 1 << 20));
+    const uint32_t binBudget = static_cast<uint32_t>(std::clamp<uint64_t>(workingBytes / 4 / (BlockTriangles * 3 * sizeof(uint32_t)), 1, MaxBins));
+    const uint32_t targetBins = static_cast<uint32_t>(std::clamp<uint64_t>(triangleCount / MinTrianglesPerBin, 1, binBudget));
+    const size_t buildTriangles = static_cast<size_t>(std::max<uint64_t>(workingBytes / 2 / BuildBytesPerTriangle, 4096));
+
+    const std::filesystem::path tempDirectory = !options.tempDirectory.empty() ? options.tempDirectory
+                                              : output.has_parent_path() ? output.parent_path()
+                                              : std::filesystem::current_path();
+    const std::string tempStem = output.filename().string();
+
+    MeshletBuildParams params;
+    params.builder = MeshletBuilderKind::Streaming;
+    params.maxVertices = options.maxVertices;
+    params.maxPrimitives = options.maxPrimitives;
+    MeshletPackWriter writer(output, key, params);
+
+    // Pass 1: bounds
+    std::vector<Vertex> vertices(batchVertices);
+    Float3 minimum = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    Float3 maximum = { -minimum.x, -minimum.y, -minimum.z };
+    for (uint64_t first = 0; first < vertexCount; first += batchVertices) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(batchVertices, vertexCount - first));
+        source.ReadVertices(first, count, vertices.data());
+        for (size_t i = 0; i < count; ++i) {
+            const Float3& p = vertices[i].position;
+            minimum = Float3{ std::min(minimum.x, p.x), std::min(minimum.y, p.y), std::min(minimum.z, p.z) };
+            maximum = Float3{ std::max(maximum.x, p.x), std::max(maximum.y, p.y), std::max(maximum.z, p.z) };
+        }
+    }
+    const Grid grid = MakeGrid(minimum, maximum, targetBins);
+    stats.bins = grid.CellCount();
+
+    // Pass 2: bin id per vertex, vertices go straight to the pack
+    std::vector<uint16_t> vertexBins(static_cast<size_t>(vertexCount));
+    writer.BeginStream(MeshletPackStream::Vertices, sizeof(Vertex));
+    for (uint64_t first = 0; first < vertexCount; first += batchVertices) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(batchVertices, vertexCount - first));
+        source.ReadVertices(first, count, vertices.data());
+        for (size_t i = 0; i < count; ++i) {
+            vertexBins[static_cast<size_t>(first + i)] = grid.Cell(vertices[i].position);
+        }
+        writer.Append(vertices.data(), count * sizeof(Vertex));
+    }
+    stats.plannedPeakBytes = CapacityBytes(vertexBins) + CapacityBytes(vertices);
+    vertices = std::vector<Vertex>();
+
+    // Pass 3: spill triangles to disk, grouped in blocks per bin. A triangle belongs to the bin
+    // of its first vertex.
+    TempFile spill(tempDirectory / (tempStem + ".spill"));
+    std::vector<SpillBlock> blocks;
+    {
+        std::vector<std::vector<uint32_t>> binTriangles(stats.bins);
+        std::vector<uint32_t> triangles(batchTriangles * 3);
+        uint64_t binBytes = 0;
+
+        auto flush = [&](uint32_t bin)
+        {
+            std::vector<uint32_t>& pending = binTriangles[bin];
+            blocks.push_back(SpillBlock{ bin, static_cast<uint32_t>(pending.size() / 3), spill.Size() });
+            spill.Append(pending.data(), pending.size() * sizeof(uint32_t));
+            pending.clear();
+        };
+
+        for (uint64_t first = 0; first < triangleCount; first += batchTriangles) {
+            const size_t count = static_cast<size_t>(std::min<uint64_t>(batchTriangles, triangleCount - first));
+            source.ReadTriangles(first, count, triangles.data());
+            for (size_t i = 0; i < count; ++i) {
+                const uint32_t* triangle = &triangles[i * 3];
+                if (triangle[0] >= vertexCount || triangle[1] >= vertexCount || triangle[2] >= vertexCount) {
+                    throw std::out_of_range("StreamingMeshletBuilder: index out of range");
+                }
+                const uint32_t bin = vertexBins[triangle[0]];
+                std::vector<uint32_t>& pending = binTriangles[bin];
+                if (pending.capacity() == 0) {
+                    pending.reserve(BlockTriangles * 3);
+                    binBytes += CapacityBytes(pending);
+                }
+                pending.insert(pending.end(), triangle, triangle + 3);
+                if (pending.size() == BlockTriangles * 3) {
+                    flush(bin);
+                }
+            }
+        }
+        for (uint32_t bin = 0; bin < stats.bins; ++bin) {
+            if (!binTriangles[bin].empty()) {
+                flush(bin);
+            }
+        }
+        stats.plannedPeakBytes = std::max(stats.plannedPeakBytes, CapacityBytes(vertexBins) + CapacityBytes(triangles) + binBytes);
+    }
+    vertexBins = std::vector<uint16_t>();
+    std::stable_sort(blocks.begin(), blocks.end(), [](const SpillBlock& a, const SpillBlock& b) { return a.bin < b.bin; });
+
+    // Pass 4: build bins, bounded by buildTriangles at a time
+    TempFile meshletFile(tempDirectory / (tempStem + ".meshlets"));
+    TempFile uniqueVertexFile(tempDirectory / (tempStem + ".vertices"));
+    TempFile primitiveFile(tempDirectory / (tempStem + ".primitives"));
+    uint64_t uniqueVertexBase = 0;
+    uint64_t primitiveBase = 0;
+
+    std::vector<uint32_t> pieceIndices;
+    std::vector<uint32_t> pieceScratch;
+    std::vector<uint64_t> pieceOrder;
+    pieceIndices.reserve(std::min<uint64_t>(buildTriangles, triangleCount) * 3);
+
+    auto buildPiece = [&]()
+    {
+        if (pieceIndices.empty()) {
+            return;
+        }
+        // Vertex ids usually carry some spatial coherence. Walking the triangles by their lowest
+        // vertex gives the greedy builder much better reuse than spill order does.
+        pieceOrder.resize(pieceIndices.size() / 3);
+        for (size_t t = 0; t < pieceOrder.size(); ++t) {
+            const uint32_t* triangle = &pieceIndices[t * 3];
+            pieceOrder[t] = (uint64_t(std::min({ triangle[0], triangle[1], triangle[2] })) << 32) | t;
+        }
+        std::sort(pieceOrder.begin(), pieceOrder.end());
+        pieceScratch.resize(pieceIndices.size());
+        for (size_t t = 0; t < pieceOrder.size(); ++t) {
+            std::copy_n(&pieceIndices[(pieceOrder[t] & 0xFFFFFFFFu) * 3], 3, &pieceScratch[t * 3]);
+        }
+
+        MeshletData data = MeshletBuilder::BuildSubset(pieceScratch.data(), pieceScratch.size(), options.maxVertices, options.maxPrimitives);
+        if (uniqueVertexBase + data.uniqueVertexIndices.size() > std::numeric_limits<uint32_t>::max()
+            || primitiveBase + data.primitiveIndices.size() > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("StreamingMeshletBuilder: meshlet offsets exceed 32 bits");
+        }
+        for (Meshlet& meshlet : data.meshlets) {
+            meshlet.VertOffset += static_cast<uint32_t>(uniqueVertexBase);
+            meshlet.PrimOffset += static_cast<uint32_t>(primitiveBase);
+        }
+
+        meshletFile.Append(data.meshlets.data(), data.meshlets.size() * sizeof(Meshlet));
+        uniqueVertexFile.Append(data.uniqueVertexIndices.data(), data.uniqueVertexIndices.size() * sizeof(uint32_t));
+        primitiveFile.Append(data.primitiveIndices.data(), data.primitiveIndices.size() * sizeof(uint32_t));
+        uniqueVertexBase += data.uniqueVertexIndices.size();
+        primitiveBase += data.primitiveIndices.size();
+        stats.meshlets += data.meshlets.size();
+        stats.triangles += data.primitiveIndices.size();
+
+        // BuildSubset keeps a hash table, a vertex list and local indices while it runs
+        stats.plannedPeakBytes = std::max(stats.plannedPeakBytes, CapacityBytes(pieceIndices) + CapacityBytes(pieceScratch) + CapacityBytes(pieceOrder)
+            + CapacityBytes(data.meshlets) + CapacityBytes(data.uniqueVertexIndices) + CapacityBytes(data.primitiveIndices)
+            + 6 * pieceScratch.size() * sizeof(uint32_t));
+        pieceIndices.clear();
+    };
+
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        const SpillBlock& block = blocks[i];
+        if (pieceIndices.size() / 3 + block.triangles > buildTriangles) {
+            buildPiece();
+        }
+        const size_t offset = pieceIndices.size();
+        pieceIndices.resize(offset + block.triangles * 3);
+        spill.Read(block.offset, pieceIndices.data() + offset, block.triangles * 3 * sizeof(uint32_t));
+
+        const bool lastOfBin = i + 1 == blocks.size() || blocks[i + 1].bin != block.bin;
+        if (lastOfBin) {
+            buildPiece();
+        }
+    }
+    stats.spillBytes = spill.Size() + meshletFile.Size() + uniqueVertexFile.Size() + primitiveFile.Size();
+    pieceIndices = std::vector<uint32_t>();
+    pieceScratch = std::vector<uint32_t>();
+    pieceOrder = std::vector<uint64_t>();
+
+    // Pass 5: move the temporary streams into the pack
+    // Whole 64 KiB pages, so copies never split an element
+    std::vector<uint8_t> copyBuffer(static_cast<size_t>(std::clamp<uint64_t>(workingBytes / 8, 1 << 16, 64 << 20) & ~uint64_t(0xFFFF)));
+    writer.BeginStream(MeshletPackStream::Meshlets, sizeof(Meshlet));
+    meshletFile.CopyTo(writer, copyBuffer);
+    writer.BeginStream(MeshletPackStream::UniqueVertexIndices, sizeof(uint32_t));
+    uniqueVertexFile.CopyTo(writer, copyBuffer);
+    writer.BeginStream(MeshletPackStream::PrimitiveIndices, sizeof(uint32_t));
+    primitiveFile.CopyTo(writer, copyBuffer);
+    writer.Finish();
+    stats.outputBytes = std::filesystem::file_size(output);
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "MeshStream.h"
+
+#include <cstdint>
+#include <filesystem>
+
+struct StreamingBuildOptions
+{
+    uint64_t                memoryBudget = uint64_t(1) << 30;  // Bytes of working memory the builder may use
+    uint32_t                maxVertices = 128;
+    uint32_t                maxPrimitives = 128;
+    std::filesystem::path   tempDirectory;                      // Defaults to the output directory
+};
+
+struct StreamingBuildStats
+{
+    uint64_t    triangles = 0;
+    uint64_t    meshlets = 0;
+    uint32_t    bins = 0;
+    uint64_t    spillBytes = 0;         // Temporary data written to disk
+    uint64_t    outputBytes = 0;
+    uint64_t    plannedPeakBytes = 0;   // Largest working set the builder allocated
+    double      seconds = 0.0;
+};
+
+// Out-of-core meshlet builder writing a MeshletPack.
+//
+// Vertices are bucketed into a coarse spatial grid, triangles are spilled to disk per grid cell
+// (bin) and every bin is then built on its own with MeshletBuilder. Bin boundaries are locked:
+// meshlets never cross them, but vertices on a boundary stay shared through their global index.
+// Results are appended to the pack as bins complete, so memory use depends on the budget and
+// not on the mesh size, except for 2 bytes of bin id per vertex.
+class StreamingMeshletBuilder
+{
+public:
+    static StreamingBuildStats Build(MeshStream& source, const std::filesystem::path& output, uint64_t key, const StreamingBuildOptions& options);
+};
@@ -0,0 +1,59 @@
+#include "UploadArena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+uint64_t UploadArena::Allocate(uint64_t size, uint64_t alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        throw std::invalid_argument("Upload arena alignment must be a power of two");
+    }
+    const uint64_t offset = (_size + alignment - 1) & ~(alignment - 1);
+    _size = offset + size;
+    ++_allocations;
+    return offset;
+}
+
+uint64_t UploadArena::Stage(const void* data, uint64_t size, void* destination, uint64_t destinationOffset, uint64_t alignment)
+{
+    const uint64_t offset = Allocate(size, alignment);
+    _stagedBytes += size;
+
+    if (!_copies.empty()) {
+        Copy& last = _copies.back();
+        if (last.destination == destination && last.destinationOffset + last.size == destinationOffset
+            && last.sourceOffset + last.size == offset && static_cast<const uint8_t*>(last.data) + last.size == data) {
+            last.size += size;
+            return offset;
+        }
+    }
+    _copies.push_back(Copy{ destination, destinationOffset, offset, size, data });
+    return offset;
+}
+
+void UploadArena::Write(void* mapped) const
+{
+    for (const Copy& copy : _copies) {
+        std::memcpy(static_cast<uint8_t*>(mapped) + copy.sourceOffset, copy.data, copy.size);
+    }
+}
+
+std::vector<void*> UploadArena::Destinations() const
+{
+    std::vector<void*> destinations;
+    for (const Copy& copy : _copies) {
+        if (std::find(destinations.begin(), destinations.end(), copy.destination) == destinations.end()) {
+            destinations.push_back(copy.destination);
+        }
+    }
+    return destinations;
+}
+
+void UploadArena::Reset()
+{
+    _copies.clear();
+    _size = 0;
+    _allocations = 0;
+    _stagedBytes = 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Bump allocator for one-off uploads, like the asset streams at startup. Every Stage() takes the
+// next aligned range of a single upload buffer and records the copy from there into its
+// destination, so the whole batch is one buffer, one Map, one CopyBufferRegion per destination
+// range and one barrier batch. Staging only plans: size the upload buffer with Size() once
+// everything is staged, then Write() the data into its mapped memory.
+//
+// Destinations are opaque to the arena (main.cpp passes ID3D12Resource pointers). The data passed
+// to Stage() has to stay alive until Write().
+class UploadArena
+{
+public:
+    static constexpr uint64_t DefaultAlignment = 256;      // D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT
+
+    struct Copy
+    {
+        void*       destination;
+        uint64_t    destinationOffset;
+        uint64_t    sourceOffset;       // in the upload buffer
+        uint64_t    size;
+        const void* data;
+    };
+
+    // Offset of size bytes aligned to alignment (a power of two) in the upload buffer
+    uint64_t Allocate(uint64_t size, uint64_t alignment = DefaultAlignment);
+
+    // Allocates size bytes for data and records their copy to destinationOffset in destination.
+    // A copy that continues the previous one in the upload buffer, the data and the destination is
+    // merged into it. Returns the offset in the upload buffer.
+    uint64_t Stage(const void* data, uint64_t size, void* destination, uint64_t destinationOffset = 0, uint64_t alignment = DefaultAlignment);
+
+    // Copies the staged data to their offsets, mapped has to hold Size() bytes
+    void Write(void* mapped) const;
+
+    // Every destination once, in the order they were first staged, for the barrier batch
+    std::vector<void*> Destinations() const;
+
+    const std::vector<Copy>& Copies() const { return _copies; }
+    uint64_t Size() const { return _size; }
+    uint64_t Allocations() const { return _allocations; }
+    uint64_t StagedBytes() const { return _stagedBytes; }
+
+    void Reset();
+
+private:
+    std::vector<Copy>   _copies;
+    uint64_t            _size = 0;
+    uint64_t            _allocations = 0;
+    uint64_t            _stagedBytes = 0;
+};
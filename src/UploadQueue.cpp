@@ -0,0 +1,130 @@
+#include "UploadQueue.h"
+
+#include "UploadArena.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+UploadQueue::UploadQueue(UploadQueueBackend& backend, uint64_t batchBytes, uint64_t maxInFlightBytes)
+    : _backend(backend), _batchBytes(batchBytes), _maxInFlightBytes(maxInFlightBytes)
+{
+    if (maxInFlightBytes == 0) {
+        throw std::invalid_argument("Uploads need some memory in flight");
+    }
+}
+
+uint64_t UploadQueue::Enqueue(const void* data, uint64_t size, void* destination, uint64_t destinationOffset)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    PendingUpload upload{ std::vector<uint8_t>(bytes, bytes + size), destination, destinationOffset };
+
+    uint64_t ticket;
+    bool flush;
+    {
+        std::lock_guard<std::mutex> lock(_pendingMutex);
+        _pending.push_back(std::move(upload));
+        _pendingBytes += size;
+        ticket = _nextBatch;
+        flush = _batchBytes != 0 && _pendingBytes >= _batchBytes;
+    }
+    if (flush) {
+        Flush();
+    }
+    return ticket;
+}
+
+uint64_t UploadQueue::Flush()
+{
+    std::lock_guard<std::mutex> submitLock(_submitMutex);
+    std::vector<PendingUpload> uploads;
+    uint64_t batch;
+    {
+        std::lock_guard<std::mutex> lock(_pendingMutex);
+        if (_pending.empty()) {
+            return 0;
+        }
+        uploads.swap(_pending);
+        _pendingBytes = 0;
+        batch = _nextBatch++;
+    }
+
+    UploadArena arena;
+    uint64_t bytes = 0;
+    for (const PendingUpload& upload : uploads) {
+        arena.Stage(upload.data.data(), upload.data.size(), upload.destination, upload.destinationOffset);
+        bytes += upload.data.size();
+    }
+
+    // Make room for the upload memory, a batch larger than the budget only waits for the queue to drain
+    Retire(_backend.CompletedValue());
+    while (!_inFlight.empty() && _inFlightBytes + arena.Size() > _maxInFlightBytes) {
+        ++_budgetWaits;
+        _backend.WaitFor(_inFlight.front().batch);
+        Retire(_backend.CompletedValue());
+    }
+
+    arena.Write(_backend.BeginBatch(batch, arena.Size()));
+    for (const UploadArena::Copy& copy : arena.Copies()) {
+        _backend.RecordCopy(batch, copy.destination, copy.destinationOffset, copy.sourceOffset, copy.size);
+    }
+    _backend.Submit(batch);
+
+    _inFlight.push_back(InFlightBatch{ batch, arena.Size() });
+    _inFlightBytes += arena.Size();
+    _peakInFlightBytes = std::max<uint64_t>(_peakInFlightBytes, _inFlightBytes);
+    _uploads += uploads.size();
+    _uploadedBytes += bytes;
+    _submitted = batch;
+    return batch;
+}
+
+void UploadQueue::HandOff(uint64_t ticket)
+{
+    if (ticket > _submitted) {
+        Flush();
+    }
+    std::lock_guard<std::mutex> lock(_handOffMutex);
+    if (ticket > _queueWaited) {
+        _backend.QueueWait(ticket);
+        _queueWaited = ticket;
+        ++_queueWaits;
+    }
+}
+
+bool UploadQueue::IsComplete(uint64_t ticket)
+{
+    return _backend.CompletedValue() >= ticket;
+}
+
+void UploadQueue::Wait(uint64_t ticket)
+{
+    if (ticket > _submitted) {
+        Flush();
+    }
+    _backend.WaitFor(ticket);
+}
+
+void UploadQueue::Collect()
+{
+    std::lock_guard<std::mutex> lock(_submitMutex);
+    Retire(_backend.CompletedValue());
+}
+
+void UploadQueue::WaitIdle()
+{
+    Flush();
+    std::lock_guard<std::mutex> lock(_submitMutex);
+    if (!_inFlight.empty()) {
+        _backend.WaitFor(_inFlight.back().batch);
+    }
+    Retire(_backend.CompletedValue());
+}
+
+void UploadQueue::Retire(uint64_t completed)
+{
+    while (!_inFlight.empty() && _inFlight.front().batch <= completed) {
+        _backend.Retire(_inFlight.front().batch);
+        _inFlightBytes -= _inFlight.front().size;
+        _inFlight.pop_front();
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// The part of a copy queue UploadQueue needs. Batches are numbered by the copy fence value they
+// signal, 1, 2, 3, ... in submission order. D3D12CopyQueue in main.cpp wraps a copy queue and its
+// fence, MeshletTool's upload-queue-stress command simulates one.
+class UploadQueueBackend
+{
+public:
+    virtual ~UploadQueueBackend() = default;
+
+    // Opens the copy list of batch and returns size bytes of mapped upload memory for it
+    virtual void* BeginBatch(uint64_t batch, uint64_t size) = 0;
+    // Copies size bytes from sourceOffset in the batch's upload memory to the destination
+    virtual void RecordCopy(uint64_t batch, void* destination, uint64_t destinationOffset, uint64_t sourceOffset, uint64_t size) = 0;
+    // Closes and executes the copy list, then signals the copy fence with batch
+    virtual void Submit(uint64_t batch) = 0;
+    // The copy queue is done with batch, its upload memory and copy list can go
+    virtual void Retire(uint64_t batch) = 0;
+
+    // Copy fence, callable from any thread
+    virtual uint64_t CompletedValue() = 0;
+    virtual void WaitFor(uint64_t value) = 0;
+    // Makes the consuming (direct) queue wait on the GPU until the copy fence reaches value
+    virtual void QueueWait(uint64_t value) = 0;
+};
+
+// Uploads from any thread through a copy queue. Enqueue() copies the data aside and returns a
+// ticket, the copy fence value of the batch the upload goes out in. Flush() stages everything
+// pending in one UploadArena and submits it as one copy list, so rendering never waits for uploads
+// unless it uses them: before submitting work that reads an upload, the consuming queue's thread
+// calls HandOff(ticket), which makes that queue wait for the copy fence on the GPU. One wait covers
+// every older ticket, so waits already made are skipped.
+//
+// Submitted batches keep their upload memory until the copy fence passes them. Flush() waits for the
+// oldest ones when more than maxInFlightBytes would be in flight. Buffers leave a copy queue in the
+// COMMON state, the consuming queue transitions them from there.
+class UploadQueue
+{
+public:
+    // Enqueue() flushes once batchBytes are pending, 0 leaves flushing to the caller
+    UploadQueue(UploadQueueBackend& backend, uint64_t batchBytes, uint64_t maxInFlightBytes);
+
+    UploadQueue(const UploadQueue&) = delete;
+    UploadQueue& operator=(const UploadQueue&) = delete;
+
+    // Copies size bytes of data for destinationOffset in destination. Returns the ticket.
+    uint64_t Enqueue(const void* data, uint64_t size, void* destination, uint64_t destinationOffset = 0);
+    // Submits the pending uploads as one batch and returns its ticket, 0 when nothing was pending
+    uint64_t Flush();
+
+    // On the thread submitting to the consuming queue, before the work using the uploads of ticket
+    void HandOff(uint64_t ticket);
+    bool IsComplete(uint64_t ticket);
+    // Blocks until the uploads of ticket are done, flushing them first if needed
+    void Wait(uint64_t ticket);
+    // Retires the batches the copy queue is done with
+    void Collect();
+    void WaitIdle();
+
+    uint64_t Batches() const { return _submitted; }
+    uint64_t Uploads() const { return _uploads; }
+    uint64_t UploadedBytes() const { return _uploadedBytes; }
+    uint64_t InFlightBytes() const { return _inFlightBytes; }
+    uint64_t PeakInFlightBytes() const { return _peakInFlightBytes; }
+    uint64_t BudgetWaits() const { return _budgetWaits; }      // Flush calls that waited for older batches
+    uint64_t QueueWaits() const { return _queueWaits; }        // GPU waits HandOff inserted
+
+private:
+    struct PendingUpload
+    {
+        std::vector<uint8_t>    data;
+        void*                   destination;
+        uint64_t                destinationOffset;
+    };
+
+    struct InFlightBatch
+    {
+        uint64_t    batch;
+        uint64_t    size;
+    };
+
+    void Retire(uint64_t completed);    // with _submitMutex held
+
+    UploadQueueBackend&         _backend;
+    const uint64_t              _batchBytes;
+    const uint64_t              _maxInFlightBytes;
+
+    std::mutex                  _pendingMutex;
+    std::vector<PendingUpload>  _pending;
+    uint64_t                    _pendingBytes = 0;
+    uint64_t                    _nextBatch = 1;
+
+    // Taking the pending uploads and submitting them happens under one lock, so batches reach the
+    // copy queue in fence order
+    std::mutex                  _submitMutex;
+    std::deque<InFlightBatch>   _inFlight;
+    std::atomic<uint64_t>       _submitted{ 0 };
+    std::atomic<uint64_t>       _uploads{ 0 };
+    std::atomic<uint64_t>       _uploadedBytes{ 0 };
+    std::atomic<uint64_t>       _inFlightBytes{ 0 };
+    uint64_t                    _peakInFlightBytes = 0;
+    uint64_t                    _budgetWaits = 0;
+
+    std::mutex                  _handOffMutex;
+    uint64_t                    _queueWaited = 0;   // highest value the consuming queue waits for
+    uint64_t                    _queueWaits = 0;
+};
@@ -0,0 +1,48 @@
+#include "UploadRing.h"
+
+#include <stdexcept>
+
+UploadRing::UploadRing(uint64_t capacity)
+    : _capacity(capacity)
+{
+    if (capacity == 0 || capacity % ConstantAlignment != 0) {
+        throw std::invalid_argument("Upload ring capacity must be a non-zero multiple of 256 bytes");
+    }
+}
+
+uint64_t UploadRing::Allocate(uint64_t size, uint64_t alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || _capacity % alignment != 0) {
+        throw std::invalid_argument("Upload ring alignment must be a power of two dividing the capacity");
+    }
+    if (size > _capacity) {
+        return Failed;
+    }
+
+    // The capacity is a multiple of the alignment, so aligning the running position aligns the offset
+    uint64_t start = (_head + alignment - 1) & ~(alignment - 1);
+    if (start % _capacity + size > _capacity) {
+        start = (start / _capacity + 1) * _capacity;
+    }
+    if (start + size - _tail > _capacity) {
+        return Failed;
+    }
+    _head = start + size;
+    return start % _capacity;
+}
+
+void UploadRing::EndFrame(uint64_t fenceValue)
+{
+    if (!_frames.empty() && fenceValue < _frames.back().fenceValue) {
+        throw std::logic_error("Upload ring frames have to end in fence order");
+    }
+    _frames.push_back(Frame{ fenceValue, _head });
+}
+
+void UploadRing::Reclaim(uint64_t completedValue)
+{
+    while (!_frames.empty() && _frames.front().fenceValue <= completedValue) {
+        _tail = _frames.front().end;
+        _frames.pop_front();
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+// Linear allocator over a persistently mapped upload buffer, for data that lives for one frame
+// (constants, per-draw and per-instance data). Only hands out offsets, the caller adds them to its
+// mapped pointer and GPU address. Space is reclaimed a whole frame at a time once the fence value
+// that frame was submitted with has completed.
+//
+// Allocations never wrap: one that doesn't fit before the end of the buffer starts over at offset 0
+// and the skipped bytes are released with its frame.
+class UploadRing
+{
+public:
+    static constexpr uint64_t Failed = UINT64_MAX;
+    static constexpr uint64_t ConstantAlignment = 256;     // D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT
+
+    // capacity has to be a multiple of every alignment asked for
+    explicit UploadRing(uint64_t capacity);
+
+    // Offset of size bytes aligned to alignment (a power of two), or Failed when the space that is
+    // still in use by the GPU leaves no room. Reclaim or wait for OldestFence() and try again.
+    uint64_t Allocate(uint64_t size, uint64_t alignment = ConstantAlignment);
+
+    // Everything allocated since the previous EndFrame is released by fenceValue
+    void EndFrame(uint64_t fenceValue);
+    // Releases the frames whose fence value is <= completedValue
+    void Reclaim(uint64_t completedValue);
+
+    // Fence value of the oldest frame still holding space, 0 when there is none
+    uint64_t OldestFence() const { return _frames.empty() ? 0 : _frames.front().fenceValue; }
+    uint64_t Capacity() const { return _capacity; }
+    uint64_t Used() const { return _head - _tail; }
+
+private:
+    struct Frame
+    {
+        uint64_t fenceValue;
+        uint64_t end;       // _head when the frame ended
+    };
+
+    uint64_t            _capacity;
+    uint64_t            _head = 0;      // bytes ever allocated, the offset is _head % _capacity
+    uint64_t            _tail = 0;      // bytes ever released
+    std::deque<Frame>   _frames;
+};
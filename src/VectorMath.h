@@ -0,0 +1,45 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Just enough vector math for the CPU side of the meshlet pipeline.
+
+inline Float3 operator+(const Float3& a, const Float3& b) { return Float3{ a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline Float3 operator-(const Float3& a, const Float3& b) { return Float3{ a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline Float3 operator*(const Float3& a, float s) { return Float3{ a.x * s, a.y * s, a.z * s }; }
+inline Float3 operator-(const Float3& a) { return Float3{ -a.x, -a.y, -a.z }; }
+
+inline float Dot(const Float3& a, const Float3& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline Float3 Cross(const Float3& a, const Float3& b)
+{
+    return Float3{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+inline float Length(const Float3& a)
+{
+    return std::sqrt(Dot(a, a));
+}
+
+// Zero vectors stay zero
+inline Float3 Normalize(const Float3& a)
+{
+    const float length = Length(a);
+    return length > 0.f ? a * (1.f / length) : a;
+}
+
+inline Float3 Min(const Float3& a, const Float3& b)
+{
+    return Float3{ std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z) };
+}
+
+inline Float3 Max(const Float3& a, const Float3& b)
+{
+    return Float3{ std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z) };
+}
@@ -0,0 +1,224 @@
+#include "VertexQuantization.h"
+
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const float PositionSteps = 65535.f;
+
+float SignNotZero(float value)
+{
+    return value >= 0.f ? 1.f : -1.f;
+}
+
+uint8_t ToSnorm8(float value)
+{
+    return static_cast<uint8_t>(static_cast<int8_t>(std::clamp(value, -127.f, 127.f)));
+}
+
+uint16_t PackOctahedral(float x, float y)
+{
+    return static_cast<uint16_t>(ToSnorm8(x) | (ToSnorm8(y) << 8));
+}
+
+PositionBounds BoundsOf(const Float3& lo, const Float3& hi)
+{
+    auto step = [](float extent) { return extent > 0.f ? extent / PositionSteps : 1.f; };
+    return PositionBounds{ lo, Float3{ step(hi.x - lo.x), step(hi.y - lo.y), step(hi.z - lo.z) } };
+}
+
+uint16_t QuantizePosition(float value, float offset, float scale)
+{
+    return static_cast<uint16_t>(std::clamp(std::round((value - offset) / scale), 0.f, PositionSteps));
+}
+
+} // namespace
+
+uint16_t VertexQuantization::EncodeOctahedral(const Float3& normal)
+{
+    const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (length <= 0.f) {
+        return PackOctahedral(0.f, 0.f);
+    }
+    float x = normal.x / length;
+    float y = normal.y / length;
+    if (normal.z < 0.f) {
+        const float foldedX = (1.f - std::abs(y)) * SignNotZero(x);
+        const float foldedY = (1.f - std::abs(x)) * SignNotZero(y);
+        x = foldedX;
+        y = foldedY;
+    }
+
+    // Plain rounding is off by up to a step on the diagonal, pick the best of the four neighbours
+    const Float3 target = Normalize(normal);
+    const float baseX = std::floor(x * 127.f);
+    const float baseY = std::floor(y * 127.f);
+    uint16_t best = 0;
+    float bestDot = -2.f;
+    for (int i = 0; i < 4; ++i) {
+        const uint16_t candidate = PackOctahedral(baseX + (i & 1), baseY + (i >> 1));
+        const float dot = Dot(DecodeOctahedral(candidate), target);
+        if (dot > bestDot) {
+            bestDot = dot;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+Float3 VertexQuantization::DecodeOctahedral(uint16_t packed)
+{
+    const float x = std::max(static_cast<int8_t>(packed & 0xFF) / 127.f, -1.f);
+    const float y = std::max(static_cast<int8_t>(packed >> 8) / 127.f, -1.f);
+    Float3 n = { x, y, 1.f - std::abs(x) - std::abs(y) };
+    const float t = std::clamp(-n.z, 0.f, 1.f);
+    n.x += n.x >= 0.f ? -t : t;
+    n.y += n.y >= 0.f ? -t : t;
+    return Normalize(n);
+}
+
+uint16_t VertexQuantization::FloatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t biasedExponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (biasedExponent == 0xFF) {
+        return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    }
+    const int32_t exponent = static_cast<int32_t>(biasedExponent) - 127 + 15;
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+
+    // Round to nearest even in both the normal and the denormal case
+    uint32_t shift = 13;
+    uint32_t half = 0;
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000;
+        shift = static_cast<uint32_t>(14 - exponent);
+        half = mantissa >> shift;
+    } else {
+        half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> shift);
+    }
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1))) {
+        ++half;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+float VertexQuantization::HalfToFloat(uint16_t value)
+{
+    const uint32_t sign = (value & 0x8000u) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1F;
+    const uint32_t mantissa = value & 0x3FF;
+
+    if (exponent == 0) {
+        const float denormal = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -denormal : denormal;
+    }
+    const uint32_t bits = exponent == 31 ? sign | 0x7F800000 | (mantissa << 13) : sign | ((exponent + 112) << 23) | (mantissa << 13);
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+Vertex VertexQuantization::Decode(const QuantizedVertex& vertex, const PositionBounds& bounds)
+{
+    Vertex result;
+    result.position = Float3{
+        bounds.offset.x + bounds.scale.x * vertex.position[0],
+        bounds.offset.y + bounds.scale.y * vertex.position[1],
+        bounds.offset.z + bounds.scale.z * vertex.position[2],
+    };
+    result.normal = DecodeOctahedral(vertex.normal);
+    result.textureCoordinate = Float2{ HalfToFloat(vertex.textureCoordinate[0]), HalfToFloat(vertex.textureCoordinate[1]) };
+    return result;
+}
+
+QuantizedMesh VertexQuantization::Encode(const std::vector<Vertex>& vertices, const MeshletData& data, MeshletVertexLayout layout,
+                                         const VertexQuantizationOptions& options)
+{
+    QuantizedMesh result;
+    result.vertices.resize(vertices.size());
+    result.bounds.resize(data.meshlets.size());
+
+    Float3 meshLo = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Float3 meshHi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const Vertex& vertex : vertices) {
+        meshLo = Min(meshLo, vertex.position);
+        meshHi = Max(meshHi, vertex.position);
+    }
+    if (vertices.empty()) {
+        return result;
+    }
+    const float diagonal = Length(meshHi - meshLo);
+
+    auto encode = [&](size_t index, const PositionBounds& bounds)
+    {
+        const Vertex& source = vertices[index];
+        QuantizedVertex& target = result.vertices[index];
+        target.position[0] = QuantizePosition(source.position.x, bounds.offset.x, bounds.scale.x);
+        target.position[1] = QuantizePosition(source.position.y, bounds.offset.y, bounds.scale.y);
+        target.position[2] = QuantizePosition(source.position.z, bounds.offset.z, bounds.scale.z);
+        target.normal = EncodeOctahedral(source.normal);
+        target.textureCoordinate[0] = FloatToHalf(source.textureCoordinate.x);
+        target.textureCoordinate[1] = FloatToHalf(source.textureCoordinate.y);
+
+        const Vertex decoded = Decode(target, bounds);
+        QuantizationError& error = result.error;
+        error.position = std::max(error.position, Length(decoded.position - source.position));
+        const float dot = std::clamp(Dot(decoded.normal, Normalize(source.normal)), -1.f, 1.f);
+        error.normalDegrees = std::max(error.normalDegrees, std::acos(dot) * 57.2957795f);
+        error.texCoord = std::max({ error.texCoord, std::abs(decoded.textureCoordinate.x - source.textureCoordinate.x),
+                                    std::abs(decoded.textureCoordinate.y - source.textureCoordinate.y) });
+    };
+
+    if (layout == MeshletVertexLayout::Flat) {
+        for (size_t m = 0; m < data.meshlets.size(); ++m) {
+            const Meshlet& meshlet = data.meshlets[m];
+            Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+            Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+            for (uint32_t i = meshlet.VertOffset; i < meshlet.VertOffset + meshlet.VertCount; ++i) {
+                lo = Min(lo, vertices.at(i).position);
+                hi = Max(hi, vertices.at(i).position);
+            }
+            result.bounds[m] = meshlet.VertCount ? BoundsOf(lo, hi) : BoundsOf(meshLo, meshHi);
+            for (uint32_t i = meshlet.VertOffset; i < meshlet.VertOffset + meshlet.VertCount; ++i) {
+                encode(i, result.bounds[m]);
+            }
+        }
+    } else {
+        const PositionBounds bounds = BoundsOf(meshLo, meshHi);
+        std::fill(result.bounds.begin(), result.bounds.end(), bounds);
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            encode(i, bounds);
+        }
+    }
+    result.error.positionRelative = diagonal > 0.f ? result.error.position / diagonal : 0.f;
+
+    if (result.error.positionRelative > options.maxPositionError) {
+        throw std::runtime_error("VertexQuantization: position error " + std::to_string(result.error.positionRelative) + " exceeds the limit");
+    }
+    if (result.error.normalDegrees > options.maxNormalDegrees) {
+        throw std::runtime_error("VertexQuantization: normal error " + std::to_string(result.error.normalDegrees) + " degrees exceeds the limit");
+    }
+    if (result.error.texCoord > options.maxTexCoordError) {
+        throw std::runtime_error("VertexQuantization: texture coordinate error " + std::to_string(result.error.texCoord) + " exceeds the limit");
+    }
+    return result;
+}
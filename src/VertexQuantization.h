@@ -0,0 +1,49 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "MeshletBuilder.h"
+
+#include <cstdint>
+#include <vector>
+
+// Largest errors the encoder accepts. Encode throws when the data can't meet them.
+struct VertexQuantizationOptions
+{
+    float   maxPositionError = 1e-4f;       // relative to the mesh bounding box diagonal
+    float   maxNormalDegrees = 1.f;
+    float   maxTexCoordError = 1e-3f;
+};
+
+// Measured errors of an encoded mesh
+struct QuantizationError
+{
+    float   position = 0.f;                 // mesh units
+    float   positionRelative = 0.f;         // relative to the mesh bounding box diagonal
+    float   normalDegrees = 0.f;
+    float   texCoord = 0.f;
+};
+
+struct QuantizedMesh
+{
+    std::vector<QuantizedVertex>    vertices;
+    std::vector<PositionBounds>     bounds;         // one per meshlet
+    QuantizationError               error;
+};
+
+class VertexQuantization
+{
+public:
+    // Encodes the vertices the way the meshlets reference them. Flat layouts get bounds per meshlet,
+    // indexed layouts share vertices between meshlets, so every meshlet gets the mesh bounds.
+    static QuantizedMesh Encode(const std::vector<Vertex>& vertices, const MeshletData& data, MeshletVertexLayout layout,
+                                const VertexQuantizationOptions& options = VertexQuantizationOptions());
+
+    // Reference decoder, the same arithmetic as the QUANTIZED_VERTICES LoadVertex in MeshletMS.hlsl
+    static Vertex Decode(const QuantizedVertex& vertex, const PositionBounds& bounds);
+
+    static uint16_t EncodeOctahedral(const Float3& normal);
+    static Float3 DecodeOctahedral(uint16_t packed);
+
+    static uint16_t FloatToHalf(float value);
+    static float HalfToFloat(uint16_t value);
+};
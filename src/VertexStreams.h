@@ -0,0 +1,29 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+#include <vector>
+
+// MeshletVertexFormat::Split vertices: one tightly packed array per attribute, so passes that only
+// need positions (depth, shadows, culling, the meshlet builders) don't pull normals and texture
+// coordinates through the cache. Feed positions.data() with stride sizeof(Float3) to the builders.
+struct VertexStreams
+{
+    std::vector<Float3> positions;
+    std::vector<Float3> normals;
+    std::vector<Float2> textureCoordinates;
+
+    static VertexStreams FromVertices(const std::vector<Vertex>& vertices)
+    {
+        VertexStreams streams;
+        streams.positions.resize(vertices.size());
+        streams.normals.resize(vertices.size());
+        streams.textureCoordinates.resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            streams.positions[i] = vertices[i].position;
+            streams.normals[i] = vertices[i].normal;
+            streams.textureCoordinates[i] = vertices[i].textureCoordinate;
+        }
+        return streams;
+    }
+};
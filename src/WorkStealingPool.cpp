@@ -0,0 +1,120 @@
+#include "WorkStealingPool.h"
+
+#include "Parallel.h"
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = DefaultThreadCount();
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+    for (uint32_t worker = 1; worker < threadCount; ++worker) {
+        _threads.emplace_back(&WorkStealingPool::WorkerLoop, this, worker);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::Run(uint32_t count, const Job& job)
+{
+    if (count == 0) {
+        return;
+    }
+    _job = &job;
+    _error = nullptr;
+    _remaining = count;
+    for (uint32_t i = 0; i < count; ++i) {
+        Queue& queue = *_queues[i % _queues.size()];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        queue.jobs.push_back(i);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        ++_generation;
+    }
+    _wake.notify_all();
+
+    Work(0);
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        _done.wait(lock, [&]() { return _remaining == 0; });
+    }
+    _job = nullptr;
+
+    if (_error) {
+        std::rethrow_exception(_error);
+    }
+}
+
+void WorkStealingPool::WorkerLoop(uint32_t worker)
+{
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            _wake.wait(lock, [&]() { return _stop || _generation != seen; });
+            if (_stop) {
+                return;
+            }
+            seen = _generation;
+        }
+        Work(worker);
+    }
+}
+
+// Runs jobs until there are none left to take. Jobs still running on other workers are waited for
+// by Run(), nothing new can show up in the queues until then.
+void WorkStealingPool::Work(uint32_t worker)
+{
+    uint32_t job;
+    while (Take(worker, job)) {
+        try {
+            (*_job)(job, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(_errorLock);
+            if (!_error) {
+                _error = std::current_exception();
+            }
+        }
+        if (--_remaining == 0) {
+            std::lock_guard<std::mutex> lock(_lock);
+            _done.notify_all();
+        }
+    }
+}
+
+bool WorkStealingPool::Take(uint32_t worker, uint32_t& job)
+{
+    {
+        Queue& own = *_queues[worker];
+        std::lock_guard<std::mutex> lock(own.lock);
+        if (!own.jobs.empty()) {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < _queues.size(); ++i) {
+        Queue& victim = *_queues[(worker + i) % _queues.size()];
+        std::lock_guard<std::mutex> lock(victim.lock);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            ++_steals;
+            return true;
+        }
+    }
+    return false;
+}
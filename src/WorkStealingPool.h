@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent worker threads with a job deque each. Run() deals the jobs round robin onto the deques,
+// every worker takes its own from the back and steals from the front of the others' once it runs
+// dry, so uneven jobs even out without a shared queue. The calling thread works as worker 0.
+//
+// Jobs can't add jobs, and Run() is not reentrant.
+class WorkStealingPool
+{
+public:
+    using Job = std::function<void(uint32_t job, uint32_t worker)>;
+
+    // threadCount includes the calling thread, 0 means all cores
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Calls job(i, worker) for every i in [0, count) and returns once all are done. worker is in
+    // [0, WorkerCount()) and names the thread running it. The first exception thrown by any job is
+    // rethrown here after the others finished.
+    void Run(uint32_t count, const Job& job);
+
+    uint32_t WorkerCount() const { return static_cast<uint32_t>(_queues.size()); }
+    uint64_t Steals() const { return _steals; }
+
+private:
+    struct Queue
+    {
+        std::mutex              lock;
+        std::deque<uint32_t>    jobs;
+    };
+
+    void WorkerLoop(uint32_t worker);
+    void Work(uint32_t worker);
+    bool Take(uint32_t worker, uint32_t& job);
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread>            _threads;
+    const Job*                          _job = nullptr;
+
+    std::mutex                          _lock;          // guards _generation and _stop, and the wakeups
+    std::condition_variable             _wake;
+    std::condition_variable             _done;
+    uint64_t                            _generation = 0;
+    bool                                _stop = false;
+
+    std::atomic<uint32_t>               _remaining{ 0 };
+    std::atomic<uint64_t>               _steals{ 0 };
+    std::mutex                          _errorLock;
+    std::exception_ptr                  _error;
+};
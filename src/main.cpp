@@ -12,8 +12,35 @@
 #define ASSETS_PATH L"Wrong Assets Path"
 #endif
 
+#ifndef MESHLET_MAX_VERTICES
+#define MESHLET_MAX_VERTICES 128
+#endif
+
+#ifndef MESHLET_MAX_PRIMITIVES
+#define MESHLET_MAX_PRIMITIVES 128
+#endif
+
+#ifndef MESHLET_FLAT_VERTICES
+#define MESHLET_FLAT_VERTICES 0
+#endif
+
+#ifndef MESHLET_BYTE_PRIMITIVES
+#define MESHLET_BYTE_PRIMITIVES 0
+#endif
+
+#ifndef MESHLET_QUANTIZED_VERTICES
+#define MESHLET_QUANTIZED_VERTICES 0
+#endif
+
+#ifndef MESHLET_SPLIT_VERTICES
+#define MESHLET_SPLIT_VERTICES 0
+#endif
+
 #include <algorithm>
+#include <chrono>
+#include <deque>
 #include <iostream>
+#include <memory>
 #include <WindowsX.h>
 #include <windows.h>
 #include <dxgi.h>
@@ -21,6 +48,7 @@
 #include <DirectXMath.h>
 #include <d3dcompiler.h>
 #include <dxcapi.h>
+#include <d3d12shader.h>
 #include "d3dx12.h"
 #include <dxgidebug.h>
 #include <dxgi1_6.h>
@@ -28,8 +56,20 @@
 #include <wrl.h>
 #include <sstream>
 #include <fstream>
-#include <DirectXMesh.h>
-#include <WaveFrontReader.h>
+
+#include "BindlessAllocator.h"
+#include "DepthPyramid.h"
+#include "FrameScheduler.h"
+#include "HeapAllocator.h"
+#include "IndirectDraws.h"
+#include "MeshletConfig.h"
+#include "MeshletCulling.h"
+#include "MeshletPack.h"
+#include "ObjLoader.h"
+#include "RecordingScheduler.h"
+#include "UploadQueue.h"
+#include "UploadRing.h"
+#include "WorkStealingPool.h"
 
 struct App {
 
@@ -59,6 +99,214 @@ struct App {
         }
     }
 
+    // FrameQueue on a D3D12 command queue: one fence counting up, one event reused by every wait
+    class D3D12FrameQueue : public FrameQueue
+    {
+    public:
+        D3D12FrameQueue(ID3D12Device* device, ID3D12CommandQueue* queue)
+            : _queue(queue)
+        {
+            ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&_fence)));
+            _event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+            if (_event == nullptr) {
+                ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+            }
+        }
+
+        ~D3D12FrameQueue() override
+        {
+            CloseHandle(_event);
+        }
+
+        D3D12FrameQueue(const D3D12FrameQueue&) = delete;
+        D3D12FrameQueue& operator=(const D3D12FrameQueue&) = delete;
+
+        uint64_t Signal() override
+        {
+            ThrowIfFailed(_queue->Signal(_fence.Get(), ++_lastSignaled));
+            return _lastSignaled;
+        }
+
+        uint64_t CompletedValue() override
+        {
+            return _fence->GetCompletedValue();
+        }
+
+        void WaitFor(uint64_t value) override
+        {
+            if (_fence->GetCompletedValue() >= value) {
+                return;
+            }
+            ThrowIfFailed(_fence->SetEventOnCompletion(value, _event));
+            WaitForSingleObjectEx(_event, INFINITE, FALSE);
+        }
+
+    private:
+        ID3D12CommandQueue*     _queue;
+        ComPtr<ID3D12Fence>     _fence;
+        HANDLE                  _event = nullptr;
+        uint64_t                _lastSignaled = 0;
+    };
+
+    // Command allocators per recording thread and frame slot, command lists per frame slot, for RecordingScheduler
+    class D3D12Recording : public CommandListBackend
+    {
+    public:
+        D3D12Recording(ID3D12Device* device, ID3D12CommandQueue* queue, uint32_t framesInFlight, uint32_t workers)
+            : _device(device), _queue(queue), _workers(workers), _allocators(size_t(framesInFlight) * workers), _lists(framesInFlight)
+        {
+            for (auto& allocator : _allocators) {
+                ThrowIfFailed(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator)));
+            }
+        }
+
+        ID3D12GraphicsCommandList6* List(uint32_t frameSlot, uint32_t list) const { return _lists[frameSlot][list].Get(); }
+
+        void PrepareLists(uint32_t frameSlot, uint32_t listCount) override
+        {
+            auto& lists = _lists[frameSlot];
+            while (lists.size() < listCount) {
+                // Nothing records into the allocator while lists are prepared, the new list is closed right away
+                ComPtr<ID3D12GraphicsCommandList6> list;
+                ThrowIfFailed(_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, Allocator(frameSlot, 0), nullptr, IID_PPV_ARGS(&list)));
+                ThrowIfFailed(list->Close());
+                lists.push_back(list);
+            }
+        }
+
+        void ResetAllocator(uint32_t frameSlot, uint32_t worker) override
+        {
+            ThrowIfFailed(Allocator(frameSlot, worker)->Reset());
+        }
+
+        void OpenList(uint32_t frameSlot, uint32_t worker, uint32_t list) override
+        {
+            ThrowIfFailed(_lists[frameSlot][list]->Reset(Allocator(frameSlot, worker), nullptr));
+        }
+
+        void CloseList(uint32_t frameSlot, uint32_t list) override
+        {
+            ThrowIfFailed(_lists[frameSlot][list]->Close());
+        }
+
+        void Submit(uint32_t frameSlot, uint32_t listCount) override
+        {
+            std::vector<ID3D12CommandList*> lists(listCount);
+            for (uint32_t i = 0; i < listCount; ++i) {
+                lists[i] = _lists[frameSlot][i].Get();
+            }
+            _queue->ExecuteCommandLists(listCount, lists.data());
+        }
+
+    private:
+        ID3D12CommandAllocator* Allocator(uint32_t frameSlot, uint32_t worker) const { return _allocators[size_t(frameSlot) * _workers + worker].Get(); }
+
+        ID3D12Device*                                           _device;
+        ID3D12CommandQueue*                                     _queue;
+        uint32_t                                                _workers;
+        std::vector<ComPtr<ID3D12CommandAllocator>>             _allocators;
+        std::vector<std::vector<ComPtr<ID3D12GraphicsCommandList6>>> _lists;
+    };
+
+    // Copy queue for UploadQueue. Every batch in flight has a copy list and an upload buffer, lists and
+    // allocators of retired batches are reused.
+    class D3D12CopyQueue : public UploadQueueBackend
+    {
+    public:
+        D3D12CopyQueue(ID3D12Device* device, ID3D12CommandQueue* copyQueue, ID3D12CommandQueue* directQueue)
+            : _device(device), _copyQueue(copyQueue), _directQueue(directQueue)
+        {
+            ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&_fence)));
+        }
+
+        void* BeginBatch(uint64_t batch, uint64_t size) override
+        {
+            Batch open = { batch };
+            if (_free.empty()) {
+                ThrowIfFailed(_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&open.allocator)));
+                ThrowIfFailed(_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, open.allocator.Get(), nullptr, IID_PPV_ARGS(&open.list)));
+            } else {
+                open.allocator = std::move(_free.back().allocator);
+                open.list = std::move(_free.back().list);
+                _free.pop_back();
+                ThrowIfFailed(open.allocator->Reset());
+                ThrowIfFailed(open.list->Reset(open.allocator.Get(), nullptr));
+            }
+
+            auto uploadHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+            auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+            ThrowIfFailed(_device->CreateCommittedResource(&uploadHeap, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&open.upload)));
+            open.upload->SetName(L"Upload Queue Batch");
+            void* memory = nullptr;
+            const CD3DX12_RANGE readRange(0, 0);
+            ThrowIfFailed(open.upload->Map(0, &readRange, &memory));
+
+            _batches.push_back(std::move(open));
+            return memory;
+        }
+
+        void RecordCopy(uint64_t batch, void* destination, uint64_t destinationOffset, uint64_t sourceOffset, uint64_t size) override
+        {
+            const Batch& open = _batches.back();
+            open.list->CopyBufferRegion(static_cast<ID3D12Resource*>(destination), destinationOffset, open.upload.Get(), sourceOffset, size);
+        }
+
+        void Submit(uint64_t batch) override
+        {
+            const Batch& open = _batches.back();
+            open.upload->Unmap(0, nullptr);
+            ThrowIfFailed(open.list->Close());
+            ID3D12CommandList* lists[] = { open.list.Get() };
+            _copyQueue->ExecuteCommandLists(1, lists);
+            ThrowIfFailed(_copyQueue->Signal(_fence.Get(), batch));
+        }
+
+        void Retire(uint64_t batch) override
+        {
+            if (_batches.empty() || _batches.front().value != batch) {
+                throw std::logic_error("Copy batches have to retire in submission order");
+            }
+            Batch& retired = _batches.front();
+            retired.upload.Reset();
+            _free.push_back(std::move(retired));
+            _batches.pop_front();
+        }
+
+        uint64_t CompletedValue() override
+        {
+            return _fence->GetCompletedValue();
+        }
+
+        void WaitFor(uint64_t value) override
+        {
+            // Without an event the call blocks until the fence gets there, from any thread
+            if (_fence->GetCompletedValue() < value) {
+                ThrowIfFailed(_fence->SetEventOnCompletion(value, nullptr));
+            }
+        }
+
+        void QueueWait(uint64_t value) override
+        {
+            ThrowIfFailed(_directQueue->Wait(_fence.Get(), value));
+        }
+
+    private:
+        struct Batch
+        {
+            uint64_t                            value;
+            ComPtr<ID3D12CommandAllocator>      allocator;
+            ComPtr<ID3D12GraphicsCommandList>   list;
+            ComPtr<ID3D12Resource>              upload;
+        };
+
+        ID3D12Device*           _device;
+        ID3D12CommandQueue*     _copyQueue;
+        ID3D12CommandQueue*     _directQueue;
+        ComPtr<ID3D12Fence>     _fence;
+        std::deque<Batch>       _batches;   // in flight, oldest first
+        std::vector<Batch>      _free;
+    };
+
     static void GetHardwareAdapter(const ComPtr<IDXGIFactory4>& pFactory, ComPtr<IDXGIAdapter1>& pAdapter, bool userChoice = false)
     {
         ComPtr<IDXGIFactory6> factory6;
@@ -108,6 +356,79 @@ struct App {
     }
 
     static const UINT SwapChainBufferCount = 2;
+    // Frames the CPU may record ahead of the GPU, each one has its own command allocators
+    static const UINT FramesInFlight = 2;
+    // Threads recording a frame's command lists, the main thread included
+    static const UINT RecordingThreads = 4;
+    // Persistently mapped upload memory for everything that changes every frame
+    static const UINT64 UploadRingSize = 1 << 20;
+    // Default heap blocks the static buffers are placed in, larger buffers get a heap of their own
+    static const UINT64 HeapBlockSize = 64 << 20;
+    // Pending asset data that makes the upload queue submit a copy batch, and upload memory it keeps in flight
+    static const UINT64 UploadBatchSize = 8 << 20;
+    static const UINT64 UploadBudget = 64 << 20;
+
+    enum class BufferCategory : uint32_t
+    {
+        Geometry = 0,       // vertex streams
+        Meshlets,           // meshlets, unique vertex indices, primitive indices
+        Culling,            // meshlet bounds and visibility
+        Count
+    };
+    static constexpr const char* BufferCategoryNames[] = { "geometry", "meshlets", "culling" };
+
+    // Meshlet limits the builder, the pack and the mesh shader variant agree on
+    using ActiveMeshletConfig = MeshletConfig<MESHLET_MAX_VERTICES, MESHLET_MAX_PRIMITIVES>;
+    static_assert(ContainsMeshletConfig<ActiveMeshletConfig, MeshletConfigs>::value, "No mesh shader variant is built for this meshlet configuration, add it to MeshletConfigs and BuildShaders.bat.");
+    static constexpr MeshletVertexLayout ActiveVertexLayout = MESHLET_FLAT_VERTICES ? MeshletVertexLayout::Flat : MeshletVertexLayout::Indexed;
+    static constexpr MeshletPrimitiveFormat ActivePrimitiveFormat = MESHLET_BYTE_PRIMITIVES ? MeshletPrimitiveFormat::Bytes : MeshletPrimitiveFormat::Packed10;
+    static_assert(!(MESHLET_QUANTIZED_VERTICES && MESHLET_SPLIT_VERTICES), "Quantized and split vertices are alternative vertex formats.");
+    static constexpr MeshletVertexFormat ActiveVertexFormat = MESHLET_QUANTIZED_VERTICES ? MeshletVertexFormat::Quantized
+                                                            : MESHLET_SPLIT_VERTICES ? MeshletVertexFormat::Split
+                                                            : MeshletVertexFormat::Full;
+
+    // Meshlets DrawCullCS.hlsl keeps or drops together, 32 amplification shader groups
+    static const UINT MeshletsPerDraw = 1024;
+    // DrawConstants, right after the scene constants in every ROOT_SIG. ExecuteIndirect sets them per draw.
+    static const UINT DrawConstantsRootParameter = 1;
+    // Descriptors at the start of _srvUavHeap the mesh buffers' SRVs are allocated from, see BindlessAllocator
+    static const UINT BindlessCapacity = 4096;
+
+    // Suffix of the mesh shader variant and meshlet pack matching the active settings, see BuildShaders.bat
+    static std::string VariantName()
+    {
+        return ActiveMeshletConfig::Name()
+            + (ActiveVertexLayout == MeshletVertexLayout::Flat ? "_flat" : "")
+            + (ActivePrimitiveFormat == MeshletPrimitiveFormat::Bytes ? "_bytes" : "")
+            + (ActiveVertexFormat == MeshletVertexFormat::Quantized ? "_quant" : "")
+            + (ActiveVertexFormat == MeshletVertexFormat::Split ? "_split" : "");
+    }
+
+    static ComPtr<ID3DBlob> ReadShaderFile(const std::string& path)
+    {
+        std::ifstream shaderCodeFile(path, std::ios::binary | std::ios::ate);
+        if (!shaderCodeFile.is_open()) {
+            throw std::runtime_error("Cannot open shader code file " + path + ".");
+        }
+
+        const size_t size = shaderCodeFile.tellg();
+        shaderCodeFile.seekg(0);
+        ComPtr<ID3DBlob> code;
+        ThrowIfFailed(D3DCreateBlob(size, code.GetAddressOf()));
+        shaderCodeFile.read(reinterpret_cast<char*>(code->GetBufferPointer()), size);
+        return code;
+    }
+
+    // The depth pyramid's descriptors follow the bindless range
+    D3D12_CPU_DESCRIPTOR_HANDLE HzbDescriptor(UINT index) const
+    {
+        return CD3DX12_CPU_DESCRIPTOR_HANDLE(_srvUavHeap->GetCPUDescriptorHandleForHeapStart(), BindlessCapacity + index, _srvUavDescriptorSize);
+    }
+
+    D3D12_GPU_DESCRIPTOR_HANDLE HzbGpuDescriptor(UINT index) const
+    {
+        return CD3DX12_GPU_DESCRIPTOR_HANDLE(_srvUavHeap->GetGPUDescriptorHandleForHeapStart(), BindlessCapacity + index, _srvUavDescriptorSize);
+    }
 
     _declspec(align(256u)) struct SceneConstantBuffer
     {
@@ -117,6 +438,13 @@ struct App {
         uint32_t   DrawMeshlets;
         uint32_t   IndicesCount;
         uint32_t   VerticesCount;
+        uint32_t   MeshletCount;
+        Plane      FrustumPlanes[6];
+        Float3     CameraPosition;
+        uint32_t   HzbLevels;
+        DepthProjection Projection;
+        uint32_t   DepthWidth;
+        uint32_t   DepthHeight;
     };
 
     // DXGI stuff
@@ -132,6 +460,7 @@ struct App {
     // D3D12 stuff
     ComPtr<ID3D12Device2>            _device;
     ComPtr<ID3D12CommandQueue>      _commandQueue;
+    ComPtr<ID3D12CommandQueue>      _copyQueue;
     ComPtr<IDXGISwapChain3>         _swapChain;
     ComPtr<ID3D12DescriptorHeap>    _rtvHeap;
     UINT                            _rtvDescriptorSize;
@@ -139,18 +468,34 @@ struct App {
     UINT                            _dsvDescriptorSize;
 
     ComPtr<ID3D12Resource>              _renderTargets[SwapChainBufferCount];
-    ComPtr<ID3D12CommandAllocator>      _commandAllocator[SwapChainBufferCount];
-    ComPtr<ID3D12GraphicsCommandList6>  _commandList[SwapChainBufferCount];
+    // One-off work recorded on the main thread, like the startup uploads. Frames go through _recordingScheduler.
+    ComPtr<ID3D12CommandAllocator>      _commandAllocator[FramesInFlight];
+    ComPtr<ID3D12GraphicsCommandList6>  _commandList[FramesInFlight];
 
     ComPtr<ID3D12Resource>          _depthStencil;
     ComPtr<ID3D12Resource>          _depthStencilView;
 
-    ComPtr<ID3D12Resource>          _constantBuffer;
-    ComPtr<ID3D12Resource>          _constantBufferView;
-    UINT8*                          _cbvDataBegin;
+    ComPtr<ID3D12Resource>          _uploadBuffer;
+    UINT8*                          _uploadData;
+    UploadRing                      _uploadRing{ UploadRingSize };
 
     ComPtr<ID3D12RootSignature>    _rootSignature;
-    ComPtr<ID3D12PipelineState>    _pipelineState;
+    ComPtr<ID3D12PipelineState>    _pipelineState;         // early occlusion pass
+    ComPtr<ID3D12PipelineState>    _latePipelineState;
+
+    // Depth pyramid of the early pass, see DepthPyramid. Descriptors after the bindless ones: depth SRV,
+    // one SRV per level, SRV of all levels, one UAV per level.
+    ComPtr<ID3D12RootSignature>     _hzbRootSignature;
+    ComPtr<ID3D12PipelineState>     _hzbPipelineState;
+    ComPtr<ID3D12Resource>          _hzb;
+    UINT                            _hzbLevels;
+    ComPtr<ID3D12DescriptorHeap>    _srvUavHeap;
+    UINT                            _srvUavDescriptorSize;
+    BindlessAllocator               _bindless{ BindlessCapacity };
+
+    // Placed buffers are released before the heaps they live in, keep the heaps above them
+    HeapAllocator                   _heapAllocator{ HeapBlockSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT };
+    std::vector<ComPtr<ID3D12Heap>> _heaps;
 
     ComPtr<ID3D12Resource>          _indexBufferResource;
     uint32_t                        _indicesCount;
@@ -160,13 +505,31 @@ struct App {
     // Meshlets data
     ComPtr<ID3D12Resource>          _meshletsBufferResource;
     ComPtr<ID3D12Resource>          _uniqueVertexIBBufferResource;
+    ComPtr<ID3D12Resource>          _positionBoundsResource;
+    ComPtr<ID3D12Resource>          _normalBufferResource;
+    ComPtr<ID3D12Resource>          _texCoordBufferResource;
     ComPtr<ID3D12Resource>          _primitiveIndiceBufferResource;
+    ComPtr<ID3D12Resource>          _meshletBoundsResource;
+    ComPtr<ID3D12Resource>          _meshletVisibilityResource;    // uint per meshlet, written by the late pass
     uint32_t                        _meshletsCount;
+    MeshDescriptors                 _meshDescriptors;               // SRVs of the buffers above
+    // GPU driven draws, see IndirectDraws
+    ComPtr<ID3D12RootSignature>     _drawCullRootSignature;
+    ComPtr<ID3D12PipelineState>     _drawCullPipelineState;
+    ComPtr<ID3D12CommandSignature>  _commandSignature;
+    ComPtr<ID3D12Resource>          _drawsResource;                 // MeshletDraw per MeshletsPerDraw meshlets
+    ComPtr<ID3D12Resource>          _drawCommandsResource;          // DispatchMeshCommand per visible draw, from DrawCullCS.hlsl
+    ComPtr<ID3D12Resource>          _drawCountResource;             // how many of them
+    uint32_t                        _drawCount;
 
     // Runtime
-    UINT _currentSwapChainBufferIndex;
-    UINT _frameId = 0;
-    ComPtr<ID3D12Fence>            _frameProgressFence[SwapChainBufferCount];
+    std::unique_ptr<D3D12FrameQueue>    _frameQueue;
+    std::unique_ptr<FrameScheduler>     _frameScheduler;
+    WorkStealingPool                    _recordingPool{ RecordingThreads };
+    std::unique_ptr<D3D12Recording>     _recording;
+    std::unique_ptr<RecordingScheduler> _recordingScheduler;
+    std::unique_ptr<D3D12CopyQueue>     _copyBackend;
+    std::unique_ptr<UploadQueue>        _uploadQueue;
 
     App(HINSTANCE instance) 
     : _hAppInstance(instance) {
@@ -178,6 +541,17 @@ struct App {
         InitSample();
     }
 
+    ~App()
+    {
+        // The GPU may still use the resources of the last frames and uploads
+        if (_frameScheduler) {
+            _frameScheduler->WaitIdle();
+        }
+        if (_uploadQueue) {
+            _uploadQueue->WaitIdle();
+        }
+    }
+
     bool InitMainWindow() 
     {
         WNDCLASS wc;
@@ -254,6 +628,18 @@ struct App {
             queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
 
             ThrowIfFailed(_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&_commandQueue)));
+            _frameQueue = std::make_unique<D3D12FrameQueue>(_device.Get(), _commandQueue.Get());
+            _frameScheduler = std::make_unique<FrameScheduler>(*_frameQueue, FramesInFlight);
+            _recording = std::make_unique<D3D12Recording>(_device.Get(), _commandQueue.Get(), FramesInFlight, _recordingPool.WorkerCount());
+            _recordingScheduler = std::make_unique<RecordingScheduler>(*_recording, _recordingPool, FramesInFlight);
+
+            // Asset uploads run on their own queue and never hold up the frames that don't use them
+            D3D12_COMMAND_QUEUE_DESC copyQueueDesc = {};
+            copyQueueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+            copyQueueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+            ThrowIfFailed(_device->CreateCommandQueue(&copyQueueDesc, IID_PPV_ARGS(&_copyQueue)));
+            _copyBackend = std::make_unique<D3D12CopyQueue>(_device.Get(), _copyQueue.Get(), _commandQueue.Get());
+            _uploadQueue = std::make_unique<UploadQueue>(*_copyBackend, UploadBatchSize, UploadBudget);
         }
 
         // Describe and create the swap chain.
@@ -280,7 +666,6 @@ struct App {
             // Don't support fullscreen transitions for now...
             ThrowIfFailed(factory->MakeWindowAssociation(_hMainWindow, DXGI_MWA_NO_ALT_ENTER));
             ThrowIfFailed(swapChain.As(&_swapChain));
-            _currentSwapChainBufferIndex = _swapChain->GetCurrentBackBufferIndex();
             
         }
 
@@ -326,7 +711,8 @@ struct App {
             depthOptimizedClearValue.DepthStencil.Stencil = 0;
 
             const CD3DX12_HEAP_PROPERTIES depthStencilHeapProps(D3D12_HEAP_TYPE_DEFAULT);
-            const CD3DX12_RESOURCE_DESC depthStencilTextureDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_D32_FLOAT, _winWidth, _winHeight, 1, 0, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL);
+            // Typeless, the depth pyramid reads it as R32_FLOAT
+            const CD3DX12_RESOURCE_DESC depthStencilTextureDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R32_TYPELESS, _winWidth, _winHeight, 1, 0, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL);
 
             ThrowIfFailed(_device->CreateCommittedResource(
                 &depthStencilHeapProps,
@@ -340,33 +726,73 @@ struct App {
             _device->CreateDepthStencilView(_depthStencil.Get(), &depthStencilDesc, _dsvHeap->GetCPUDescriptorHandleForHeapStart());
         }
 
-        // Create the constant buffer
+        // Create the depth pyramid
         {
-            const UINT64 constantBufferSize = sizeof(SceneConstantBuffer) * SwapChainBufferCount;
-            
-            const CD3DX12_HEAP_PROPERTIES constantBufferHeapProps(D3D12_HEAP_TYPE_UPLOAD);
-            const CD3DX12_RESOURCE_DESC constantBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(constantBufferSize);
+            _hzbLevels = DepthPyramid::LevelCount(_winWidth, _winHeight);
+            const UINT64 hzbWidth = std::max<LONG>(1, _winWidth / 2);
+            const UINT hzbHeight = std::max<LONG>(1, _winHeight / 2);
 
+            const CD3DX12_HEAP_PROPERTIES hzbHeapProps(D3D12_HEAP_TYPE_DEFAULT);
+            const CD3DX12_RESOURCE_DESC hzbDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R32_FLOAT, hzbWidth, hzbHeight, 1, static_cast<UINT16>(_hzbLevels), 1, 0, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
             ThrowIfFailed(_device->CreateCommittedResource(
-                &constantBufferHeapProps,
+                &hzbHeapProps,
                 D3D12_HEAP_FLAG_NONE,
-                &constantBufferDesc,
-                D3D12_RESOURCE_STATE_GENERIC_READ,
+                &hzbDesc,
+                D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
                 nullptr,
-                IID_PPV_ARGS(&_constantBuffer)
+                IID_PPV_ARGS(&_hzb)
             ));
 
-            D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
-            cbvDesc.BufferLocation = _constantBuffer->GetGPUVirtualAddress();
-            cbvDesc.SizeInBytes = constantBufferSize;
+            D3D12_DESCRIPTOR_HEAP_DESC srvUavHeapDesc = {};
+            srvUavHeapDesc.NumDescriptors = BindlessCapacity + 2 + 2 * _hzbLevels;
+            srvUavHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+            srvUavHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+            ThrowIfFailed(_device->CreateDescriptorHeap(&srvUavHeapDesc, IID_PPV_ARGS(&_srvUavHeap)));
+            _srvUavDescriptorSize = _device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+            D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+            srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+            srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+            srvDesc.Texture2D.MipLevels = 1;
+            _device->CreateShaderResourceView(_depthStencil.Get(), &srvDesc, HzbDescriptor(0));
+
+            for (UINT level = 0; level < _hzbLevels; ++level) {
+                srvDesc.Texture2D.MostDetailedMip = level;
+                _device->CreateShaderResourceView(_hzb.Get(), &srvDesc, HzbDescriptor(1 + level));
+
+                D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+                uavDesc.Format = DXGI_FORMAT_R32_FLOAT;
+                uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+                uavDesc.Texture2D.MipSlice = level;
+                _device->CreateUnorderedAccessView(_hzb.Get(), nullptr, &uavDesc, HzbDescriptor(2 + _hzbLevels + level));
+            }
+
+            srvDesc.Texture2D.MostDetailedMip = 0;
+            srvDesc.Texture2D.MipLevels = _hzbLevels;
+            _device->CreateShaderResourceView(_hzb.Get(), &srvDesc, HzbDescriptor(1 + _hzbLevels));
+        }
 
-            // Map and initialize the constant buffer. We don't unmap this until the
-            // app closes. Keeping things mapped for the lifetime of the resource is okay.
+        // Create the upload ring, constants and other per-frame data are allocated from it
+        {
+            const CD3DX12_HEAP_PROPERTIES uploadHeapProps(D3D12_HEAP_TYPE_UPLOAD);
+            const CD3DX12_RESOURCE_DESC uploadBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(UploadRingSize);
+
+            ThrowIfFailed(_device->CreateCommittedResource(
+                &uploadHeapProps,
+                D3D12_HEAP_FLAG_NONE,
+                &uploadBufferDesc,
+                D3D12_RESOURCE_STATE_GENERIC_READ,
+                nullptr,
+                IID_PPV_ARGS(&_uploadBuffer)
+            ));
+
+            // We don't unmap this until the app closes. Keeping things mapped for the lifetime of the resource is okay.
             CD3DX12_RANGE readRange(0, 0);
-            ThrowIfFailed(_constantBuffer->Map(0, &readRange, reinterpret_cast<void**>(&_cbvDataBegin)));
+            ThrowIfFailed(_uploadBuffer->Map(0, &readRange, reinterpret_cast<void**>(&_uploadData)));
         }
 
-        for (int i = 0; i < SwapChainBufferCount; ++i ) {
+        for (int i = 0; i < FramesInFlight; ++i ) {
             ThrowIfFailed(_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&_commandAllocator[i])));
         }
 
@@ -375,11 +801,12 @@ struct App {
 
     void InitSample()
     {
-        D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { D3D_SHADER_MODEL_6_5 };
-        if (FAILED(_device->CheckFeatureSupport(D3D12_FEATURE_SHADER_MODEL, &shaderModel, sizeof(shaderModel))) || (shaderModel.HighestShaderModel < D3D_SHADER_MODEL_6_5))
+        // 6.6 for ResourceDescriptorHeap, the mesh and amplification shaders read every mesh buffer through it
+        D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { D3D_SHADER_MODEL_6_6 };
+        if (FAILED(_device->CheckFeatureSupport(D3D12_FEATURE_SHADER_MODEL, &shaderModel, sizeof(shaderModel))) || (shaderModel.HighestShaderModel < D3D_SHADER_MODEL_6_6))
         {
-            OutputDebugString(L"Error: Shader Model 6.5 is not supported\n");
-            throw std::runtime_error("Shader Model 6.5 is not supported\n");
+            OutputDebugString(L"Error: Shader Model 6.6 is not supported\n");
+            throw std::runtime_error("Shader Model 6.6 is not supported\n");
         }
 
         D3D12_FEATURE_DATA_D3D12_OPTIONS7 features {};
@@ -391,60 +818,70 @@ struct App {
 
         // Create pipeline state 
         {
-            constexpr char* meshShaderPath = "MeshletMS.cso";
-            constexpr char* pixelShaderPath = "MeshletPS.cso";
-            struct 
-            {
-                ComPtr<ID3DBlob> code;
-                ComPtr<ID3DBlob> errors;
-            } meshShader, pixelShader;
-
-            // Read mesh shader code
+            const std::string meshShaderPath = "MeshletMS_" + VariantName() + ".cso";
+            const ComPtr<ID3DBlob> earlyAmplificationShader = ReadShaderFile("MeshletAS_early.cso");
+            const ComPtr<ID3DBlob> lateAmplificationShader = ReadShaderFile("MeshletAS_late.cso");
+            const ComPtr<ID3DBlob> meshShader = ReadShaderFile(meshShaderPath);
+            const ComPtr<ID3DBlob> pixelShader = ReadShaderFile("MeshletPS.cso");
+            const ComPtr<ID3DBlob> hzbShader = ReadShaderFile("HzbCS.cso");
+            const ComPtr<ID3DBlob> drawCullShader = ReadShaderFile("DrawCullCS.cso");
+
+            // Make sure the variant really was compiled for the active meshlet limits
             {
-                std::ifstream shaderCodeFile(meshShaderPath, std::ios::binary | std::ios::ate);
-                if (!shaderCodeFile.is_open()) {
-                    throw std::runtime_error("Cannot open MeshShader code file.");
+                ComPtr<IDxcUtils> dxcUtils;
+                ComPtr<ID3D12ShaderReflection> reflection;
+                ThrowIfFailed(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&dxcUtils)));
+                const DxcBuffer reflectionData = { meshShader->GetBufferPointer(), meshShader->GetBufferSize(), DXC_CP_ACP };
+                ThrowIfFailed(dxcUtils->CreateReflection(&reflectionData, IID_PPV_ARGS(&reflection)));
+
+                UINT groupSizeX = 0, groupSizeY = 0, groupSizeZ = 0;
+                reflection->GetThreadGroupSize(&groupSizeX, &groupSizeY, &groupSizeZ);
+
+                // The group size alone doesn't tell 128v128p from 64v126p. The output limits are in the
+                // pipeline state validation part: PSVRuntimeInfo0 behind its size, MSInfo first.
+                struct MeshShaderInfo
+                {
+                    uint32_t runtimeInfoSize;
+                    uint32_t groupSharedBytesUsed;
+                    uint32_t groupSharedViewIdDependentBytes;
+                    uint32_t payloadSizeInBytes;
+                    uint16_t maxOutputVertices;
+                    uint16_t maxOutputPrimitives;
+                };
+                ComPtr<IDxcContainerReflection> container;
+                ComPtr<IDxcBlobEncoding> containerBlob;
+                ComPtr<IDxcBlob> validationPart;
+                UINT32 validationPartIndex = 0;
+                ThrowIfFailed(DxcCreateInstance(CLSID_DxcContainerReflection, IID_PPV_ARGS(&container)));
+                ThrowIfFailed(dxcUtils->CreateBlobFromPinned(meshShader->GetBufferPointer(), static_cast<UINT32>(meshShader->GetBufferSize()), DXC_CP_ACP, &containerBlob));
+                ThrowIfFailed(container->Load(containerBlob.Get()));
+                ThrowIfFailed(container->FindFirstPartKind(DXC_FOURCC('P', 'S', 'V', '0'), &validationPartIndex));
+                ThrowIfFailed(container->GetPartContent(validationPartIndex, &validationPart));
+                MeshShaderInfo info = {};
+                if (validationPart->GetBufferSize() >= sizeof(info)) {
+                    memcpy(&info, validationPart->GetBufferPointer(), sizeof(info));
                 }
 
-                shaderCodeFile.seekg(0, std::ios::end);
-                size_t size = shaderCodeFile.tellg();
-                shaderCodeFile.seekg(0);
-                D3DCreateBlob(size, meshShader.code.GetAddressOf());
-                shaderCodeFile.read(reinterpret_cast<char*>(meshShader.code->GetBufferPointer()), size);
-
-                shaderCodeFile.close();
-            }
-
-
-            // Read pixel shader code
-            {
-                std::ifstream shaderCodeFile(pixelShaderPath, std::ios::binary | std::ios::ate);
-                if (!shaderCodeFile.is_open()) {
-                    throw std::runtime_error("Cannot open MeshShader code file.");
+                if (groupSizeX != ActiveMeshletConfig::GroupSize || info.maxOutputVertices != ActiveMeshletConfig::MaxVertices
+                    || info.maxOutputPrimitives != ActiveMeshletConfig::MaxPrimitives) {
+                    throw std::runtime_error("Mesh shader " + meshShaderPath + " was compiled for a different meshlet configuration.");
                 }
-
-                shaderCodeFile.seekg(0, std::ios::end);
-                size_t size = shaderCodeFile.tellg();
-                shaderCodeFile.seekg(0);
-                D3DCreateBlob(size, pixelShader.code.GetAddressOf());
-                shaderCodeFile.read(reinterpret_cast<char*>(pixelShader.code->GetBufferPointer()), size);
-
-                shaderCodeFile.close();
             }
 
             // Pull root signature frm the precompiled mesh shader
-            ThrowIfFailed(_device->CreateRootSignature(0, meshShader.code->GetBufferPointer(), meshShader.code->GetBufferSize(), IID_PPV_ARGS(&_rootSignature)));
+            ThrowIfFailed(_device->CreateRootSignature(0, meshShader->GetBufferPointer(), meshShader->GetBufferSize(), IID_PPV_ARGS(&_rootSignature)));
 
             D3D12_RASTERIZER_DESC rasteriserDesc = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
             rasteriserDesc.FrontCounterClockwise = TRUE;
 
             D3DX12_MESH_SHADER_PIPELINE_STATE_DESC psoDesc = {};
             psoDesc.pRootSignature          = _rootSignature.Get();
-            psoDesc.MS                      = { meshShader.code->GetBufferPointer(), meshShader.code->GetBufferSize() };
-            psoDesc.PS                      = { pixelShader.code->GetBufferPointer(), pixelShader.code->GetBufferSize() };
+            psoDesc.AS                      = { earlyAmplificationShader->GetBufferPointer(), earlyAmplificationShader->GetBufferSize() };
+            psoDesc.MS                      = { meshShader->GetBufferPointer(), meshShader->GetBufferSize() };
+            psoDesc.PS                      = { pixelShader->GetBufferPointer(), pixelShader->GetBufferSize() };
             psoDesc.NumRenderTargets        = 1;
             psoDesc.RTVFormats[0]           = _renderTargets[0]->GetDesc().Format;
-            psoDesc.DSVFormat               = _depthStencil->GetDesc().Format;
+            psoDesc.DSVFormat               = DXGI_FORMAT_D32_FLOAT;
             psoDesc.RasterizerState         = rasteriserDesc;
             psoDesc.BlendState              = CD3DX12_BLEND_DESC(D3D12_DEFAULT); // Opaque
             psoDesc.DepthStencilState       = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT); // Less-equal depth test w/ writes; no stencil
@@ -458,11 +895,43 @@ struct App {
             streamDesc.SizeInBytes                   = sizeof(psoStream);
 
             ThrowIfFailed(_device->CreatePipelineState(&streamDesc, IID_PPV_ARGS(&_pipelineState)));
+
+            // Same pipeline with the late pass amplification shader
+            psoDesc.AS = { lateAmplificationShader->GetBufferPointer(), lateAmplificationShader->GetBufferSize() };
+            auto latePsoStream = CD3DX12_PIPELINE_MESH_STATE_STREAM(psoDesc);
+            streamDesc.pPipelineStateSubobjectStream = &latePsoStream;
+            streamDesc.SizeInBytes                   = sizeof(latePsoStream);
+            ThrowIfFailed(_device->CreatePipelineState(&streamDesc, IID_PPV_ARGS(&_latePipelineState)));
+
+            ThrowIfFailed(_device->CreateRootSignature(0, hzbShader->GetBufferPointer(), hzbShader->GetBufferSize(), IID_PPV_ARGS(&_hzbRootSignature)));
+            D3D12_COMPUTE_PIPELINE_STATE_DESC hzbPsoDesc = {};
+            hzbPsoDesc.pRootSignature = _hzbRootSignature.Get();
+            hzbPsoDesc.CS = { hzbShader->GetBufferPointer(), hzbShader->GetBufferSize() };
+            ThrowIfFailed(_device->CreateComputePipelineState(&hzbPsoDesc, IID_PPV_ARGS(&_hzbPipelineState)));
+
+            ThrowIfFailed(_device->CreateRootSignature(0, drawCullShader->GetBufferPointer(), drawCullShader->GetBufferSize(), IID_PPV_ARGS(&_drawCullRootSignature)));
+            D3D12_COMPUTE_PIPELINE_STATE_DESC drawCullPsoDesc = {};
+            drawCullPsoDesc.pRootSignature = _drawCullRootSignature.Get();
+            drawCullPsoDesc.CS = { drawCullShader->GetBufferPointer(), drawCullShader->GetBufferSize() };
+            ThrowIfFailed(_device->CreateComputePipelineState(&drawCullPsoDesc, IID_PPV_ARGS(&_drawCullPipelineState)));
+
+            // DispatchMeshCommand: the draw's root constants, then the DispatchMesh arguments
+            D3D12_INDIRECT_ARGUMENT_DESC arguments[2] = {};
+            arguments[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+            arguments[0].Constant.RootParameterIndex = DrawConstantsRootParameter;
+            arguments[0].Constant.DestOffsetIn32BitValues = 0;
+            arguments[0].Constant.Num32BitValuesToSet = IndirectDraws::DrawConstantCount;
+            arguments[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH_MESH;
+            D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+            signatureDesc.ByteStride = sizeof(DispatchMeshCommand);
+            signatureDesc.NumArgumentDescs = _countof(arguments);
+            signatureDesc.pArgumentDescs = arguments;
+            ThrowIfFailed(_device->CreateCommandSignature(&signatureDesc, _rootSignature.Get(), IID_PPV_ARGS(&_commandSignature)));
         }
 
         // Create command list
         {
-            for (int i = 0; i < SwapChainBufferCount; ++i ){
+            for (int i = 0; i < FramesInFlight; ++i ){
                 ThrowIfFailed(_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, _commandAllocator[i].Get(), _pipelineState.Get(), IID_PPV_ARGS(&_commandList[i])));
                 // Command lists are created in recording state, but there's nothing to record yet. Close for now.
                 ThrowIfFailed(_commandList[i]->Close());
@@ -471,146 +940,324 @@ struct App {
 
         // Get some asset to render
         {
-            const uint8_t swapBuffer = _frameId % SwapChainBufferCount;
-            _commandList[swapBuffer]->Reset(_commandAllocator[swapBuffer].Get(), nullptr);
-
-            WaveFrontReader<uint32_t> wfReader;
-            ThrowIfFailed(wfReader.Load(ASSETS_PATH L"dragon.obj", true));
-
-            _indicesCount = wfReader.indices.size();
-            _verticesCount = wfReader.vertices.size();
-
-            // Generate meshlet data
-            ComPtr<ID3D12Resource> meshletUpload;
-            ComPtr<ID3D12Resource> uniqueVertexIBUpload;
-            ComPtr<ID3D12Resource> primitiveIndicesUpload;
+            const UINT frame = _frameScheduler->BeginFrame();
+            _commandList[frame]->Reset(_commandAllocator[frame].Get(), nullptr);
+
+            // Meshlets only depend on the asset, so they are cooked once and mapped from the pack afterwards.
+            MeshletBuildParams buildParams = ActiveMeshletConfig::BuildParams(MeshletBuilderKind::Parallel);
+            buildParams.ordering = MeshletOrdering::Hilbert;
+            buildParams.vertexLayout = ActiveVertexLayout;
+            buildParams.primitiveFormat = ActivePrimitiveFormat;
+            buildParams.vertexFormat = ActiveVertexFormat;
+            const std::filesystem::path packPath = "dragon_" + VariantName() + ".meshletpack";
+            bool cacheHit = false;
+            const MeshletPack pack = MeshletPack::LoadOrCook(ASSETS_PATH L"dragon.obj", packPath, buildParams, [&](const ObjMesh& mesh, const Float3* positions, size_t positionStride) {
+                return MeshletBuilder::BuildParallel(
+                    mesh.indices.data(), mesh.indices.size(),
+                    positions, mesh.vertices.size(),
+                    buildParams.maxVertices,
+                    buildParams.maxPrimitives,
+                    0,
+                    positionStride
+                );
+            }, &cacheHit);
+            std::cout << (cacheHit ? "Meshlet pack loaded from cache.\n" : "Meshlet pack cooked.\n");
+
+            _indicesCount = 0;
+            for (size_t i = 0; i < pack.StreamCount(MeshletPackStream::Meshlets); ++i) {
+                _indicesCount += pack.Meshlets()[i].PrimCount * 3;
+            }
+            _verticesCount = static_cast<uint32_t>(pack.StreamCount(MeshletPackStream::Vertices) + pack.StreamCount(MeshletPackStream::QuantizedVertices)
+                                                 + pack.StreamCount(MeshletPackStream::Positions));
+            _meshletsCount = static_cast<uint32_t>(pack.StreamCount(MeshletPackStream::Meshlets));
+
+            // Streams in the pack are laid out exactly like the GPU buffers, copy them over as they are.
+            // The shaders read them through a bindless SRV each, raw for the ByteAddressBuffers.
+            const bool rawPrimitives = ActivePrimitiveFormat == MeshletPrimitiveFormat::Bytes;
+            struct
             {
-                std::vector<DirectX::XMFLOAT3> positions;
-                positions.reserve(wfReader.vertices.size());
+                MeshletPackStream           stream;
+                ComPtr<ID3D12Resource>*     target;
+                BufferCategory              category;
+                uint32_t MeshDescriptors::* descriptor;
+                bool                        raw;
+            } const uploads[] = {
+                { MeshletPackStream::Meshlets,              &_meshletsBufferResource,           BufferCategory::Meshlets,   &MeshDescriptors::meshlets,             false },
+                { MeshletPackStream::UniqueVertexIndices,   &_uniqueVertexIBBufferResource,     BufferCategory::Meshlets,   &MeshDescriptors::uniqueVertexIndices,  true },
+                { MeshletPackStream::PrimitiveIndices,      &_primitiveIndiceBufferResource,    BufferCategory::Meshlets,   &MeshDescriptors::primitiveIndices,     rawPrimitives },
+                { MeshletPackStream::Vertices,              &_vertexBufferResource,             BufferCategory::Geometry,   &MeshDescriptors::vertices,             false },
+                { MeshletPackStream::QuantizedVertices,     &_vertexBufferResource,             BufferCategory::Geometry,   &MeshDescriptors::vertices,             false },
+                { MeshletPackStream::PositionBounds,        &_positionBoundsResource,           BufferCategory::Geometry,   &MeshDescriptors::positionBounds,       false },
+                { MeshletPackStream::Positions,             &_vertexBufferResource,             BufferCategory::Geometry,   &MeshDescriptors::vertices,             false },
+                { MeshletPackStream::Normals,               &_normalBufferResource,             BufferCategory::Geometry,   &MeshDescriptors::normals,              false },
+                { MeshletPackStream::TextureCoordinates,    &_texCoordBufferResource,           BufferCategory::Geometry,   &MeshDescriptors::texCoords,            false },
+                { MeshletPackStream::Bounds,                &_meshletBoundsResource,            BufferCategory::Culling,    &MeshDescriptors::bounds,               false },
+            };
+            const uint32_t unused = BindlessAllocator::Invalid;
+            _meshDescriptors = { unused, unused, unused, unused, unused, unused, unused, unused };
+
+            // Every stream goes out through the copy queue, the direct queue waits for the last batch
+            const auto uploadStart = std::chrono::steady_clock::now();
+            uint64_t uploadTicket = 0;
+            std::vector<ID3D12Resource*> uploaded;
+            for (const auto& upload : uploads) {
+                const UINT64 size = pack.StreamSize(upload.stream);
+                if (size == 0) {
+                    // UniqueVertexIndices of flat packs and the streams of the other vertex formats
+                    continue;
+                }
+                CreatePlacedBuffer(size, D3D12_RESOURCE_FLAG_NONE, upload.category, *upload.target);
+                _meshDescriptors.*upload.descriptor = CreateBindlessView(upload.target->Get(), size, upload.raw ? 0 : static_cast<UINT>(size / pack.StreamCount(upload.stream)));
+                uploadTicket = _uploadQueue->Enqueue(pack.StreamData(upload.stream), size, upload.target->Get());
+                uploaded.push_back(upload.target->Get());
+            }
 
-                for (const auto& vert : wfReader.vertices) {
-                    positions.push_back(vert.position);
-                };
+            // Nothing was visible before the first frame. Placed buffers start with undefined contents.
+            const std::vector<uint32_t> noneVisible(_meshletsCount, 0);
+            CreatePlacedBuffer(sizeof(uint32_t) * _meshletsCount, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, BufferCategory::Culling, _meshletVisibilityResource);
+            uploadTicket = _uploadQueue->Enqueue(noneVisible.data(), sizeof(uint32_t) * noneVisible.size(), _meshletVisibilityResource.Get());
+            uploaded.push_back(_meshletVisibilityResource.Get());
+
+            // Draws for DrawCullCS.hlsl. The commands are written every frame, the count is reset at the start of it.
+            const std::vector<MeshletDraw> draws = IndirectDraws::Build(pack.Bounds(), _meshletsCount, MeshletsPerDraw, _meshDescriptors);
+            _drawCount = static_cast<uint32_t>(draws.size());
+            CreatePlacedBuffer(sizeof(MeshletDraw) * draws.size(), D3D12_RESOURCE_FLAG_NONE, BufferCategory::Culling, _drawsResource);
+            uploadTicket = _uploadQueue->Enqueue(draws.data(), sizeof(MeshletDraw) * draws.size(), _drawsResource.Get());
+            uploaded.push_back(_drawsResource.Get());
+            CreatePlacedBuffer(sizeof(DispatchMeshCommand) * draws.size(), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, BufferCategory::Culling, _drawCommandsResource,
+                               D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+            CreatePlacedBuffer(sizeof(uint32_t), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, BufferCategory::Culling, _drawCountResource,
+                               D3D12_RESOURCE_STATE_COPY_DEST);
+
+            // Buffers come back from the copy queue in COMMON
+            _uploadQueue->HandOff(uploadTicket);
+            std::vector<D3D12_RESOURCE_BARRIER> barriers;
+            for (ID3D12Resource* target : uploaded) {
+                // The mesh streams are read by the amplification and mesh shaders, the draws by the culling shader
+                const D3D12_RESOURCE_STATES state = target == _meshletVisibilityResource.Get() ? D3D12_RESOURCE_STATE_UNORDERED_ACCESS
+                                                  : D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+                barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(target, D3D12_RESOURCE_STATE_COMMON, state));
+            }
+            _commandList[frame]->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
 
-                std::vector<DirectX::Meshlet> meshlets;
-                std::vector<uint8_t> uniqueVertexIB;
-                std::vector<DirectX::MeshletTriangle> primitiveIndices;
-
-                ThrowIfFailed(DirectX::ComputeMeshlets(
-                    wfReader.indices.data(), wfReader.indices.size()/3,
-                    positions.data(), positions.size(),
-                    nullptr,
-                    meshlets,
-                    uniqueVertexIB,
-                    primitiveIndices
-                ));
-
-                _meshletsCount = meshlets.size();
-
-                // Target buffers
-                auto meshletsDesc = CD3DX12_RESOURCE_DESC::Buffer(meshlets.size() * sizeof(meshlets[0]));
-                auto uniqueVertexIBDesc = CD3DX12_RESOURCE_DESC::Buffer(uniqueVertexIB.size() * sizeof(uniqueVertexIB[0]));
-                auto primitiveIndicesDesc = CD3DX12_RESOURCE_DESC::Buffer(primitiveIndices.size() * sizeof(primitiveIndices[0]));
-                
-                auto defaultHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-                ThrowIfFailed(_device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &meshletsDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(_meshletsBufferResource.GetAddressOf())));
-                ThrowIfFailed(_device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &uniqueVertexIBDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(_uniqueVertexIBBufferResource.GetAddressOf())));
-                ThrowIfFailed(_device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &primitiveIndicesDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(_primitiveIndiceBufferResource.GetAddressOf())));
-                // Upload
-                {
+            ThrowIfFailed(_commandList[frame]->Close());
 
-                    auto uploadHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-                    ThrowIfFailed(_device->CreateCommittedResource(&uploadHeap, D3D12_HEAP_FLAG_NONE, &meshletsDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(meshletUpload.GetAddressOf())));
-                    meshletUpload->SetName(L"Meshlet Upload Buffer");
-                    ThrowIfFailed(_device->CreateCommittedResource(&uploadHeap, D3D12_HEAP_FLAG_NONE, &uniqueVertexIBDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(uniqueVertexIBUpload.GetAddressOf())));
-                    uniqueVertexIBUpload->SetName(L"Unique Vertex IB Upload Buffer");
-                    ThrowIfFailed(_device->CreateCommittedResource(&uploadHeap, D3D12_HEAP_FLAG_NONE, &primitiveIndicesDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(primitiveIndicesUpload.GetAddressOf())));
-                    primitiveIndicesUpload->SetName(L"Primitive Indices Upload Buffer");
-
-                    // Copy meshlet data
-                    {
-                        byte* memory = nullptr;
-                        meshletUpload->Map(0, nullptr, reinterpret_cast<void**>(&memory));
-                        std::memcpy(memory, meshlets.data(), meshlets.size() * sizeof(meshlets[0]));
-                        meshletUpload->Unmap(0, nullptr);
-
-                        _commandList[swapBuffer]->CopyResource(_meshletsBufferResource.Get(), meshletUpload.Get());
-                        const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(_meshletsBufferResource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-                        _commandList[swapBuffer]->ResourceBarrier(1, &barrier);
-                    }
-
-                    // Copy unique vertex ib data
-                    {
-                        byte* memory = nullptr;
-                        uniqueVertexIBUpload->Map(0, nullptr, reinterpret_cast<void**>(&memory));
-                        std::memcpy(memory, uniqueVertexIB.data(), uniqueVertexIB.size() * sizeof(uniqueVertexIB[0]));
-                        uniqueVertexIBUpload->Unmap(0, nullptr);
-
-                        _commandList[swapBuffer]->CopyResource(_uniqueVertexIBBufferResource.Get(), uniqueVertexIBUpload.Get());
-                        const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(_uniqueVertexIBBufferResource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-                        _commandList[swapBuffer]->ResourceBarrier(1, &barrier);
-                    }
-
-                    // Copy primitive indices data
-                    {
-                        byte* memory = nullptr;
-                        primitiveIndicesUpload->Map(0, nullptr, reinterpret_cast<void**>(&memory));
-                        std::memcpy(memory, primitiveIndices.data(), primitiveIndices.size() * sizeof(primitiveIndices[0]));
-                        primitiveIndicesUpload->Unmap(0, nullptr);
-
-                        _commandList[swapBuffer]->CopyResource(_primitiveIndiceBufferResource.Get(), primitiveIndicesUpload.Get());
-                        const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(_primitiveIndiceBufferResource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-                        _commandList[swapBuffer]->ResourceBarrier(1, &barrier);
-                    }
-                }
+            ID3D12CommandList* ppCommandLists[] = { _commandList[frame].Get() };
+            _commandQueue->ExecuteCommandLists(1, ppCommandLists);
 
+            _frameScheduler->EndFrame();
+            _frameScheduler->WaitIdle();
+            _uploadQueue->Collect();
+
+            const std::chrono::duration<double, std::milli> uploadTime = std::chrono::steady_clock::now() - uploadStart;
+            std::cout << "Uploaded " << _uploadQueue->UploadedBytes() / 1024 << " KiB in " << _uploadQueue->Uploads() << " uploads, "
+                      << _uploadQueue->Batches() << " copy queue batches, peak " << _uploadQueue->PeakInFlightBytes() / 1024 << " KiB upload memory, "
+                      << barriers.size() << " barriers in one batch, " << uploadTime.count() << " ms\n";
+            std::cout << "Placed buffers: " << _heapAllocator.UsedBytes() / 1024 << " KiB in " << _heapAllocator.BlockCount() << " heaps of "
+                      << _heapAllocator.ReservedBytes() / 1024 << " KiB";
+            for (uint32_t category = 0; category < static_cast<uint32_t>(BufferCategory::Count); ++category) {
+                const HeapCategoryStats& stats = _heapAllocator.Category(category);
+                std::cout << ", " << BufferCategoryNames[category] << " " << stats.allocations << " (" << stats.bytes / 1024 << " KiB)";
             }
+            std::cout << "\n";
+        }
+    }
 
-            auto vertexDesc = CD3DX12_RESOURCE_DESC::Buffer(wfReader.vertices.size() * sizeof(wfReader.vertices[0]));
-            auto defaultHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-            ThrowIfFailed(_device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &vertexDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(_vertexBufferResource.GetAddressOf())));
+    // Places a buffer in one of the _heaps, creating the heap when the allocator opened a new block.
+    // The buffers live as long as the sample, so their allocations are never freed.
+    void CreatePlacedBuffer(UINT64 size, D3D12_RESOURCE_FLAGS flags, BufferCategory category, ComPtr<ID3D12Resource>& resource,
+                            D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON)
+    {
+        const CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(size, flags);
+        const D3D12_RESOURCE_ALLOCATION_INFO info = _device->GetResourceAllocationInfo(0, 1, &desc);
+        const HeapAllocation allocation = _heapAllocator.Allocate(info.SizeInBytes, info.Alignment, static_cast<uint32_t>(category));
 
-            ComPtr<ID3D12Resource> vertexUpload;
-            auto uploadHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-            ThrowIfFailed(_device->CreateCommittedResource(&uploadHeap, D3D12_HEAP_FLAG_NONE, &vertexDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(vertexUpload.GetAddressOf())));
+        if (allocation.block >= _heaps.size()) {
+            _heaps.resize(allocation.block + 1);
+        }
+        if (!_heaps[allocation.block]) {
+            const CD3DX12_HEAP_DESC heapDesc(_heapAllocator.BlockCapacity(allocation.block), D3D12_HEAP_TYPE_DEFAULT, 0, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+            ThrowIfFailed(_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&_heaps[allocation.block])));
+        }
+        ThrowIfFailed(_device->CreatePlacedResource(_heaps[allocation.block].Get(), allocation.offset, &desc, initialState, nullptr, IID_PPV_ARGS(&resource)));
+    }
 
-            // Move vertex buffer to upload
-            {
-                byte* memory = nullptr;
-                vertexUpload->Map(0, nullptr, reinterpret_cast<void**>(&memory));
-                std::memcpy(memory, wfReader.vertices.data(), sizeof(wfReader.vertices[0]) * wfReader.vertices.size());
-                vertexUpload->Unmap(0, nullptr);
+    // SRV of a buffer in the bindless range of _srvUavHeap, structured with stride or raw when stride is 0.
+    // Returns its index for the shaders' ResourceDescriptorHeap.
+    uint32_t CreateBindlessView(ID3D12Resource* buffer, UINT64 size, UINT stride)
+    {
+        const uint32_t index = _bindless.Allocate();
+        if (index == BindlessAllocator::Invalid) {
+            throw std::runtime_error("Out of bindless descriptors");
+        }
+        D3D12_SHADER_RESOURCE_VIEW_DESC desc = {};
+        desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+        desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        if (stride == 0) {
+            desc.Format = DXGI_FORMAT_R32_TYPELESS;
+            desc.Buffer.NumElements = static_cast<UINT>(size / 4);
+            desc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+        } else {
+            desc.Format = DXGI_FORMAT_UNKNOWN;
+            desc.Buffer.NumElements = static_cast<UINT>(size / stride);
+            desc.Buffer.StructureByteStride = stride;
+        }
+        _device->CreateShaderResourceView(buffer, &desc, CD3DX12_CPU_DESCRIPTOR_HANDLE(_srvUavHeap->GetCPUDescriptorHandleForHeapStart(), index, _srvUavDescriptorSize));
+        return index;
+    }
+
+    // Copies data into the upload ring for the frame being recorded and returns its GPU address.
+    // Waits for older frames when the ring is full.
+    D3D12_GPU_VIRTUAL_ADDRESS UploadFrameData(const void* data, UINT64 size, UINT64 alignment = UploadRing::ConstantAlignment)
+    {
+        UINT64 offset = _uploadRing.Allocate(size, alignment);
+        while (offset == UploadRing::Failed) {
+            if (_uploadRing.OldestFence() == 0) {
+                throw std::runtime_error("Per-frame data doesn't fit into the upload ring.");
             }
+            _frameQueue->WaitFor(_uploadRing.OldestFence());
+            _uploadRing.Reclaim(_frameQueue->CompletedValue());
+            offset = _uploadRing.Allocate(size, alignment);
+        }
+        memcpy(_uploadData + offset, data, size);
+        return _uploadBuffer->GetGPUVirtualAddress() + offset;
+    }
 
-            _commandList[swapBuffer]->CopyResource(_vertexBufferResource.Get(), vertexUpload.Get());
-            const auto vertexCopyBarrier = CD3DX12_RESOURCE_BARRIER::Transition(_vertexBufferResource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-            _commandList[swapBuffer]->ResourceBarrier(1, &vertexCopyBarrier);
+    enum RenderJob : uint32_t
+    {
+        EarlyPassJob = 0,
+        DepthPyramidJob,
+        LatePassJob,
+        RenderJobCount
+    };
 
-            ThrowIfFailed(_commandList[swapBuffer]->Close());
+    // Records one pass of the frame into a list of its own. Lists start without any state, so every
+    // pass sets what it uses.
+    void RecordRenderJob(ID3D12GraphicsCommandList6* commandList, uint32_t job, UINT backBuffer, D3D12_GPU_VIRTUAL_ADDRESS sceneConstants)
+    {
+        ID3D12DescriptorHeap* descriptorHeaps[] = { _srvUavHeap.Get() };
+        commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
 
-            ID3D12CommandList* ppCommandLists[] = { _commandList[swapBuffer].Get() };
-            _commandQueue->ExecuteCommandLists(1, ppCommandLists);
+        switch (job) {
+        case EarlyPassJob: {
+            CullDraws(commandList, sceneConstants);
 
+            const auto toRenderTargetBarrier = CD3DX12_RESOURCE_BARRIER::Transition(_renderTargets[backBuffer].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+            commandList->ResourceBarrier(1, &toRenderTargetBarrier);
+            SetMeshPassState(commandList, backBuffer, sceneConstants);
 
-            for (int i = 0; i < SwapChainBufferCount; ++i) {
-                ThrowIfFailed(_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(_frameProgressFence[i].GetAddressOf())));
-            }
+            const float clearColor[] = { 0.0f, 0.2f, 0.4f, 1.0f };
+            commandList->ClearRenderTargetView(RenderTargetView(backBuffer), clearColor, 0, nullptr);
+            commandList->ClearDepthStencilView(_dsvHeap->GetCPUDescriptorHandleForHeapStart(), D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
+
+            // What was visible last frame
+            commandList->SetPipelineState(_pipelineState.Get());
+            commandList->ExecuteIndirect(_commandSignature.Get(), _drawCount, _drawCommandsResource.Get(), 0, _drawCountResource.Get(), 0);
+            break;
+        }
+        case DepthPyramidJob:
+            BuildDepthPyramid(commandList);
+            break;
+        case LatePassJob: {
+            // Everything against the pyramid, draws what the early pass missed
+            const auto visibilityBarrier = CD3DX12_RESOURCE_BARRIER::UAV(_meshletVisibilityResource.Get());
+            commandList->ResourceBarrier(1, &visibilityBarrier);
+            SetMeshPassState(commandList, backBuffer, sceneConstants);
+            commandList->SetPipelineState(_latePipelineState.Get());
+            commandList->ExecuteIndirect(_commandSignature.Get(), _drawCount, _drawCommandsResource.Get(), 0, _drawCountResource.Get(), 0);
+
+            // The draw buffers go back to where CullDraws expects them next frame
+            const D3D12_RESOURCE_BARRIER frameDone[] = {
+                CD3DX12_RESOURCE_BARRIER::Transition(_renderTargets[backBuffer].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT),
+                CD3DX12_RESOURCE_BARRIER::Transition(_drawCommandsResource.Get(), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+                CD3DX12_RESOURCE_BARRIER::Transition(_drawCountResource.Get(), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, D3D12_RESOURCE_STATE_COPY_DEST),
+            };
+            commandList->ResourceBarrier(_countof(frameDone), frameDone);
+            break;
+        }
+        }
+    }
 
-            // Sync fence
-            ComPtr<ID3D12Fence> fence;
-            ThrowIfFailed(_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(fence.GetAddressOf())));
+    // Frustum culls the draws on the GPU and leaves the commands of the visible ones and their count
+    // ready for ExecuteIndirect. The CPU side costs the same for any number of draws.
+    void CullDraws(ID3D12GraphicsCommandList6* commandList, D3D12_GPU_VIRTUAL_ADDRESS sceneConstants)
+    {
+        const D3D12_WRITEBUFFERIMMEDIATE_PARAMETER resetCount = { _drawCountResource->GetGPUVirtualAddress(), 0 };
+        commandList->WriteBufferImmediate(1, &resetCount, nullptr);
+        const auto countToAppend = CD3DX12_RESOURCE_BARRIER::Transition(_drawCountResource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+        commandList->ResourceBarrier(1, &countToAppend);
+
+        commandList->SetComputeRootSignature(_drawCullRootSignature.Get());
+        commandList->SetPipelineState(_drawCullPipelineState.Get());
+        commandList->SetComputeRootConstantBufferView(0, sceneConstants);
+        commandList->SetComputeRootShaderResourceView(1, _drawsResource->GetGPUVirtualAddress());
+        commandList->SetComputeRootUnorderedAccessView(2, _drawCommandsResource->GetGPUVirtualAddress());
+        commandList->SetComputeRootUnorderedAccessView(3, _drawCountResource->GetGPUVirtualAddress());
+        commandList->SetComputeRoot32BitConstant(4, _drawCount, 0);
+        commandList->Dispatch((_drawCount + IndirectDraws::GroupSize - 1) / IndirectDraws::GroupSize, 1, 1);
+
+        const D3D12_RESOURCE_BARRIER toIndirect[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(_drawCommandsResource.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT),
+            CD3DX12_RESOURCE_BARRIER::Transition(_drawCountResource.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT),
+        };
+        commandList->ResourceBarrier(_countof(toIndirect), toIndirect);
+    }
 
-            _commandQueue->Signal(fence.Get(), 1);
+    D3D12_CPU_DESCRIPTOR_HANDLE RenderTargetView(UINT backBuffer) const
+    {
+        return CD3DX12_CPU_DESCRIPTOR_HANDLE(_rtvHeap->GetCPUDescriptorHandleForHeapStart(), backBuffer, _rtvDescriptorSize);
+    }
 
-            if (fence->GetCompletedValue() < 1) 
-            {
-                HANDLE event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-                fence->SetEventOnCompletion(1, event);
+    // Root signature, root arguments, viewport and render targets of the mesh shader passes
+    void SetMeshPassState(ID3D12GraphicsCommandList6* commandList, UINT backBuffer, D3D12_GPU_VIRTUAL_ADDRESS sceneConstants)
+    {
+        commandList->SetGraphicsRootSignature(_rootSignature.Get());
+        commandList->RSSetViewports(1, &_viewport);
+        commandList->RSSetScissorRects(1, &_scissorRect);
+
+        const D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = RenderTargetView(backBuffer);
+        const D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = _dsvHeap->GetCPUDescriptorHandleForHeapStart();
+        commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
+
+        // The mesh buffers come from the descriptor heap at the indices ExecuteIndirect puts in the
+        // DrawConstants, the same bindings serve every mesh
+        commandList->SetGraphicsRootConstantBufferView(0, sceneConstants);
+        commandList->SetGraphicsRootUnorderedAccessView(DrawConstantsRootParameter + 1, _meshletVisibilityResource.Get()->GetGPUVirtualAddress());
+        commandList->SetGraphicsRootDescriptorTable(DrawConstantsRootParameter + 2, HzbGpuDescriptor(1 + _hzbLevels));
+    }
 
-                WaitForSingleObjectEx(event, INFINITE, false);
-                CloseHandle(event);
-            }
+    // Reduces the early pass depth into _hzb level by level, see DepthPyramid for the rules.
+    // Leaves the depth buffer writable and the pyramid readable by the late pass.
+    void BuildDepthPyramid(ID3D12GraphicsCommandList6* commandList)
+    {
+        const D3D12_RESOURCE_BARRIER toReduce[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(_depthStencil.Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
+            CD3DX12_RESOURCE_BARRIER::Transition(_hzb.Get(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+        };
+        commandList->ResourceBarrier(_countof(toReduce), toReduce);
+
+        commandList->SetComputeRootSignature(_hzbRootSignature.Get());
+        commandList->SetPipelineState(_hzbPipelineState.Get());
+
+        UINT sourceWidth = _winWidth;
+        UINT sourceHeight = _winHeight;
+        for (UINT level = 0; level < _hzbLevels; ++level) {
+            const UINT width = std::max(1u, sourceWidth / 2);
+            const UINT height = std::max(1u, sourceHeight / 2);
+            const UINT constants[] = { sourceWidth, sourceHeight, width, height };
+            commandList->SetComputeRoot32BitConstants(0, _countof(constants), constants, 0);
+            commandList->SetComputeRootDescriptorTable(1, HzbGpuDescriptor(level));    // depth, then the previous level
+            commandList->SetComputeRootDescriptorTable(2, HzbGpuDescriptor(2 + _hzbLevels + level));
+            commandList->Dispatch((width + 7) / 8, (height + 7) / 8, 1);
+
+            const auto levelDone = CD3DX12_RESOURCE_BARRIER::Transition(_hzb.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, level);
+            commandList->ResourceBarrier(1, &levelDone);
+            sourceWidth = width;
+            sourceHeight = height;
         }
+
+        const auto toDepthWrite = CD3DX12_RESOURCE_BARRIER::Transition(_depthStencil.Get(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+        commandList->ResourceBarrier(1, &toDepthWrite);
     }
 
     void Render() 
@@ -619,8 +1266,13 @@ struct App {
         SceneConstantBuffer data;
         data.IndicesCount = _indicesCount;
         data.VerticesCount = _verticesCount;
-        const uint8_t swapBuffer = _frameId % SwapChainBufferCount;
-
+        data.MeshletCount = _meshletsCount;
+        // Waits only for the frame that last used this slot's command allocator
+        const UINT frame = _frameScheduler->BeginFrame();
+        const UINT backBuffer = _swapChain->GetCurrentBackBufferIndex();
+        _uploadRing.Reclaim(_frameQueue->CompletedValue());
+        _uploadQueue->Collect();
+        _bindless.Reclaim(_frameQueue->CompletedValue());
 
         SYSTEMTIME lt;    
         GetLocalTime(&lt);
@@ -635,58 +1287,35 @@ struct App {
         XMStoreFloat4x4(&data.WorldView, XMMatrixTranspose(world * view));
         XMStoreFloat4x4(&data.WorldViewProj, XMMatrixTranspose(world * view * proj));
 
-        memcpy(_cbvDataBegin + sizeof(SceneConstantBuffer) * _currentSwapChainBufferIndex, &data, sizeof(data) );
-
-        ThrowIfFailed(_commandAllocator[swapBuffer]->Reset());
-        ThrowIfFailed(_commandList[swapBuffer]->Reset(_commandAllocator[swapBuffer].Get(), _pipelineState.Get()));
-
-        _commandList[swapBuffer]->SetGraphicsRootSignature(_rootSignature.Get());
-        _commandList[swapBuffer]->RSSetViewports(1, &_viewport);
-        _commandList[swapBuffer]->RSSetScissorRects(1, &_scissorRect);
-
-        const auto toRenderTargetBarrier = CD3DX12_RESOURCE_BARRIER::Transition(_renderTargets[swapBuffer].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
-        _commandList[swapBuffer]->ResourceBarrier(1, &toRenderTargetBarrier);
-
-        CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(_rtvHeap->GetCPUDescriptorHandleForHeapStart(), swapBuffer, _rtvDescriptorSize);
-        CD3DX12_CPU_DESCRIPTOR_HANDLE dsvHandle(_dsvHeap->GetCPUDescriptorHandleForHeapStart());
-        _commandList[swapBuffer]->OMSetRenderTargets(1, &rtvHandle, FALSE, &dsvHandle);
-
-        const float clearColor[] = { 0.0f, 0.2f, 0.4f, 1.0f };
-        _commandList[swapBuffer]->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
-        _commandList[swapBuffer]->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
-
-        _commandList[swapBuffer]->SetGraphicsRootConstantBufferView(0, _constantBuffer->GetGPUVirtualAddress() + sizeof(SceneConstantBuffer) * _currentSwapChainBufferIndex);
+        // Object space planes, MeshletAS.hlsl tests the pack's meshlet bounds against them as they are
+        XMFLOAT4X4 worldViewProj;
+        XMStoreFloat4x4(&worldViewProj, world * view * proj);
+        const Frustum frustum = Frustum::FromMatrix(worldViewProj.m);
+        std::copy(std::begin(frustum.planes), std::end(frustum.planes), data.FrustumPlanes);
 
-        _commandList[swapBuffer]->SetGraphicsRootShaderResourceView(1, _vertexBufferResource.Get()->GetGPUVirtualAddress());
-        _commandList[swapBuffer]->SetGraphicsRootShaderResourceView(2, _meshletsBufferResource.Get()->GetGPUVirtualAddress());
-        _commandList[swapBuffer]->SetGraphicsRootShaderResourceView(3, _uniqueVertexIBBufferResource.Get()->GetGPUVirtualAddress());
-        _commandList[swapBuffer]->SetGraphicsRootShaderResourceView(4, _primitiveIndiceBufferResource.Get()->GetGPUVirtualAddress());
+        // The camera sits at the view space origin, normal cones are tested in object space too
+        XMFLOAT3 cameraPosition;
+        XMStoreFloat3(&cameraPosition, XMVector3TransformCoord(XMVectorZero(), XMMatrixInverse(nullptr, world * view)));
+        data.CameraPosition = { cameraPosition.x, cameraPosition.y, cameraPosition.z };
 
-        _commandList[swapBuffer]->DispatchMesh(_meshletsCount, 1, 1);
+        XMFLOAT4X4 projection;
+        XMStoreFloat4x4(&projection, proj);
+        data.HzbLevels = _hzbLevels;
+        data.Projection = DepthProjection::FromMatrix(projection.m);
+        data.DepthWidth = _winWidth;
+        data.DepthHeight = _winHeight;
 
-        const auto toPresentBarrier = CD3DX12_RESOURCE_BARRIER::Transition(_renderTargets[swapBuffer].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
-        _commandList[swapBuffer]->ResourceBarrier(1, &toPresentBarrier);
+        const D3D12_GPU_VIRTUAL_ADDRESS sceneConstants = UploadFrameData(&data, sizeof(data));
 
-        ThrowIfFailed(_commandList[swapBuffer]->Close());
-
-        ID3D12CommandList* ppCommandLists[] =  { _commandList[swapBuffer].Get() };
-        _commandQueue->ExecuteCommandLists(1, ppCommandLists);
+        // The passes are recorded in parallel into lists of their own and submitted in pass order
+        _recordingScheduler->RecordFrame(frame, RenderJobCount, [&](uint32_t job, uint32_t)
+        {
+            RecordRenderJob(_recording->List(frame, job), job, backBuffer, sceneConstants);
+        });
 
         ThrowIfFailed(_swapChain->Present(1, 0));
 
-        // We will be using single buffering actually...
-        const UINT nextFence = _frameId + 1;
-        ThrowIfFailed(_commandQueue->Signal(_frameProgressFence[swapBuffer].Get(), nextFence));
-        _frameId++;
-
-        if (_frameProgressFence[swapBuffer]->GetCompletedValue() < nextFence) 
-        {
-            HANDLE event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-            ThrowIfFailed(_frameProgressFence[swapBuffer]->SetEventOnCompletion(nextFence, event));
-
-            WaitForSingleObjectEx(event, INFINITE, false);
-            CloseHandle(event);
-        }
+        _uploadRing.EndFrame(_frameScheduler->EndFrame());
     }
 
     int Run()
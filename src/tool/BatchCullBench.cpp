@@ -0,0 +1,169 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBatchCulling.h"
+#include "MeshletBounds.h"
+#include "MeshletCulling.h"
+#include "Parallel.h"
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+struct View
+{
+    Frustum frustum;
+    Float3  camera;
+};
+
+} // namespace
+
+int BatchCullBenchCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint64_t runs = std::max<uint64_t>(1, args.GetUInt("runs", 5));
+    const uint32_t viewCount = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("views", 8)));
+    const unsigned maxThreads = static_cast<unsigned>(args.GetUInt("threads", DefaultThreadCount()));
+    const uint64_t targetMeshlets = args.GetUInt("meshlets", 4'000'000);
+
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    const MeshletData data = BuildMeshlets(mesh, params);
+    const Float3* positions = &mesh.vertices[0].position;
+    const std::vector<PackedMeshletBounds> meshBounds = MeshletBoundsBuilder::Pack(MeshletBoundsBuilder::Compute(data, positions, sizeof(Vertex)),
+                                                                                   data, positions, sizeof(Vertex));
+
+    Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const Vertex& vertex : mesh.vertices) {
+        lo = Min(lo, vertex.position);
+        hi = Max(hi, vertex.position);
+    }
+    const Float3 extent = hi - lo;
+
+    // Scene: copies of the mesh on a square grid in the xz plane until there are enough meshlets
+    const uint64_t copies = std::max<uint64_t>(1, (targetMeshlets + meshBounds.size() - 1) / meshBounds.size());
+    const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(double(copies))));
+    std::vector<PackedMeshletBounds> bounds;
+    bounds.reserve(copies * meshBounds.size());
+    for (uint64_t copy = 0; copy < copies; ++copy) {
+        const Float3 offset = { (copy % side) * extent.x * 1.1f, 0.f, (copy / side) * extent.z * 1.1f };
+        for (PackedMeshletBounds b : meshBounds) {
+            b.center = b.center + offset;
+            bounds.push_back(b);
+        }
+    }
+    const uint32_t count = static_cast<uint32_t>(bounds.size());
+    const MeshletCullingStreams streams = MeshletCullingStreams::FromPacked(bounds.data(), count);
+
+    // Cameras circling above the middle of the scene, looking down at it
+    const Float3 sceneLo = lo;
+    const Float3 sceneHi = { lo.x + side * extent.x * 1.1f, hi.y, lo.z + side * extent.z * 1.1f };
+    const Float3 sceneCenter = (sceneLo + sceneHi) * 0.5f;
+    const float sceneRadius = Length(sceneHi - sceneLo) * 0.5f;
+    std::vector<View> views(viewCount);
+    std::vector<std::vector<uint32_t>> expected(viewCount);
+    uint64_t visibleTotal = 0;
+    for (uint32_t v = 0; v < viewCount; ++v) {
+        const float angle = 2.f * 3.14159265f * v / viewCount;
+        const Float3 eye = sceneCenter + Float3{ std::cos(angle) * 0.5f * sceneRadius, 0.3f * sceneRadius, std::sin(angle) * 0.5f * sceneRadius };
+        Matrix view, projection, viewProjection;
+        LookAt(eye, sceneCenter, Float3{ 0.f, 1.f, 0.f }, view);
+        Perspective(60.f * 3.14159265f / 180.f, 16.f / 9.f, 0.001f * sceneRadius, 2.f * sceneRadius, projection);
+        Multiply(view, projection, viewProjection);
+        views[v] = View{ Frustum::FromMatrix(viewProjection), eye };
+        expected[v] = MeshletCulling::Cull(views[v].frustum, eye, bounds.data(), count);
+        visibleTotal += expected[v].size();
+    }
+
+    std::cout << count << " meshlets (" << copies << " copies of " << meshBounds.size() << "), " << viewCount << " views, "
+              << std::fixed << std::setprecision(1) << 100.0 * visibleTotal / (double(count) * viewCount) << "% visible, best of " << runs << " runs\n\n";
+
+    auto best = [&](auto&& work)
+    {
+        double seconds = 1e30;
+        for (uint64_t run = 0; run < runs; ++run) {
+            Stopwatch timer;
+            work();
+            seconds = std::min(seconds, timer.Seconds());
+        }
+        return seconds;
+    };
+    auto report = [&](const std::string& name, double seconds, double baseline, bool matches)
+    {
+        const double meshlets = double(count) * viewCount;
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << seconds * 1e3 / viewCount << std::setprecision(3) << std::setw(14) << meshlets / (seconds * 1e9)
+                  << std::setprecision(2) << std::setw(9) << baseline / seconds << "x" << std::setw(9) << (matches ? "yes" : "NO") << "\n";
+    };
+
+    std::cout << std::left << std::setw(22) << "kernel" << std::right << std::setw(10) << "ms/view" << std::setw(14) << "meshlets/ns"
+              << std::setw(10) << "speedup" << std::setw(9) << "exact" << "\n";
+
+    // MeshletCulling::Cull over the interleaved PackedMeshletBounds, what the kernels replace
+    const double reference = best([&]()
+    {
+        for (const View& view : views) {
+            MeshletCulling::Cull(view.frustum, view.camera, bounds.data(), count);
+        }
+    });
+    report("reference (AoS)", reference, reference, true);
+
+    bool allMatch = true;
+    std::vector<uint32_t> visible(streams.centerX.size());
+    for (const CullingKernel kernel : { CullingKernel::Scalar, CullingKernel::Sse41, CullingKernel::Avx2, CullingKernel::Neon }) {
+        if (!MeshletBatchCulling::Supported(kernel)) {
+            continue;
+        }
+        bool matches = true;
+        for (uint32_t v = 0; v < viewCount; ++v) {
+            const uint32_t written = MeshletBatchCulling::Cull(kernel, views[v].frustum, views[v].camera, streams, 0, count, visible.data());
+            matches = matches && std::equal(expected[v].begin(), expected[v].end(), visible.begin(), visible.begin() + written) && written == expected[v].size();
+        }
+        const double seconds = best([&]()
+        {
+            for (const View& view : views) {
+                MeshletBatchCulling::Cull(kernel, view.frustum, view.camera, streams, 0, count, visible.data());
+            }
+        });
+        report(MeshletBatchCulling::Name(kernel), seconds, reference, matches);
+        allMatch = allMatch && matches;
+    }
+
+    // Thread scaling of the fastest kernel, speedup against one thread
+    const CullingKernel kernel = MeshletBatchCulling::Best();
+    double oneThread = 0.0;
+    std::cout << "\n";
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(std::max(1u, maxThreads));
+    for (const unsigned threads : threadCounts) {
+        MeshletBatchCuller culler(kernel, threads);
+        bool matches = true;
+        for (uint32_t v = 0; v < viewCount; ++v) {
+            matches = matches && culler.Cull(views[v].frustum, views[v].camera, streams) == expected[v];
+        }
+        const double seconds = best([&]()
+        {
+            for (const View& view : views) {
+                culler.Cull(view.frustum, view.camera, streams);
+            }
+        });
+        oneThread = threads == 1 ? seconds : oneThread;
+        report(std::string(MeshletBatchCulling::Name(kernel)) + ", " + std::to_string(threads) + (threads == 1 ? " thread" : " threads"),
+               seconds, oneThread, matches);
+        allMatch = allMatch && matches;
+    }
+
+    std::cout << "\nexact = same visible list as MeshletCulling::Cull for every view\n";
+    return allMatch ? 0 : 1;
+}
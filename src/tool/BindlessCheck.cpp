@@ -0,0 +1,142 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "BindlessAllocator.h"
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+template <typename Exception, typename Call>
+bool Throws(Call&& call)
+{
+    try {
+        call();
+    } catch (const Exception&) {
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+// Frames allocate and free indices at random while the GPU completes them a random number of frames
+// late. A reference keeps the fence every freed index waits for, so handing one out before the GPU is
+// done with it, or reporting full while an index is free, shows up as a violation.
+int BindlessCheckCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint32_t capacity = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("capacity", 4096)));
+    const uint64_t frames = std::max<uint64_t>(1, args.GetUInt("frames", 20'000));
+    const uint32_t maxLag = static_cast<uint32_t>(args.GetUInt("max-lag", 3));
+    const uint32_t maxChurn = static_cast<uint32_t>(args.GetUInt("max-churn", 64));
+
+    BindlessAllocator allocator(capacity);
+    std::mt19937_64 random(args.GetUInt("seed", 1));
+
+    // Reference: 0 = free, UINT64_MAX = live, otherwise the fence value the index was freed with
+    const uint64_t Live = UINT64_MAX;
+    std::vector<uint64_t> state(capacity, 0);
+    std::vector<uint32_t> live;
+    std::deque<uint64_t> retiring;
+    uint64_t available = capacity;
+    uint64_t completed = 0;
+    uint64_t earlyReuse = 0, outOfRange = 0, falseFull = 0, countMismatches = 0, allocations = 0, fullAllocations = 0;
+
+    for (uint64_t frame = 1; frame <= frames; ++frame) {
+        // The GPU finishes frames in order, but how far it trails varies
+        const uint64_t lag = std::uniform_int_distribution<uint32_t>(0, maxLag)(random);
+        completed = std::max(completed, frame > lag ? frame - 1 - lag : 0);
+        uint32_t reclaimed = 0;
+        for (; !retiring.empty() && retiring.front() <= completed; retiring.pop_front()) {
+            ++reclaimed;
+        }
+        available += reclaimed;
+        countMismatches += allocator.Reclaim(completed) != reclaimed;
+
+        // Phases of loading and unloading, so the allocator runs full now and then
+        const bool loading = (frame / 500) % 2 == 0;
+        const uint32_t churn = std::uniform_int_distribution<uint32_t>(0, maxChurn)(random);
+        for (uint32_t i = 0; i < churn; ++i) {
+            if (random() % 4 != 0 ? loading : !loading) {
+                const uint32_t index = allocator.Allocate();
+                if (index == BindlessAllocator::Invalid) {
+                    falseFull += available != 0;
+                    ++fullAllocations;
+                    continue;
+                }
+                if (index >= capacity) {
+                    ++outOfRange;
+                    continue;
+                }
+                earlyReuse += state[index] == Live || state[index] > completed;
+                state[index] = Live;
+                live.push_back(index);
+                --available;
+                ++allocations;
+            } else if (!live.empty()) {
+                const size_t pick = random() % live.size();
+                const uint32_t index = live[pick];
+                live[pick] = live.back();
+                live.pop_back();
+                // The frame being recorded may still use it
+                allocator.Free(index, frame);
+                state[index] = frame;
+                retiring.push_back(frame);
+            }
+        }
+        countMismatches += allocator.Live() != live.size();
+    }
+    allocator.Reclaim(frames);
+    for (const uint32_t index : live) {
+        allocator.Free(index, frames + 1);
+    }
+    allocator.Reclaim(frames + 1);
+    const bool drained = allocator.Live() == 0 && allocator.Retiring() == 0 && allocator.Available() == capacity;
+
+    // Misuse has to be caught, not corrupt the free list
+    BindlessAllocator misuse(8);
+    const uint32_t index = misuse.Allocate();
+    misuse.Free(index, 2);
+    bool errors = Throws<std::logic_error>([&]() { misuse.Free(index, 3); });                   // twice
+    errors = errors && Throws<std::out_of_range>([&]() { misuse.Free(8, 3); });
+    errors = errors && Throws<std::logic_error>([&]() { misuse.Free(misuse.Allocate(), 1); });  // fence went back
+    errors = errors && misuse.Reclaim(1) == 0 && misuse.Reclaim(2) == 1;
+
+    // Throughput: steady state of allocating and freeing one frame's worth, reclaimed two frames late
+    const uint32_t benchCapacity = 1 << 20;
+    const uint32_t perFrame = 4096;
+    const uint64_t benchFrames = 2000;
+    BindlessAllocator bench(benchCapacity);
+    std::deque<std::vector<uint32_t>> framesLive;
+    Stopwatch timer;
+    for (uint64_t frame = 1; frame <= benchFrames; ++frame) {
+        bench.Reclaim(frame > 2 ? frame - 2 : 0);
+        std::vector<uint32_t> indices(perFrame);
+        for (uint32_t& allocated : indices) {
+            allocated = bench.Allocate();
+        }
+        framesLive.push_back(std::move(indices));
+        if (framesLive.size() > 4) {
+            for (const uint32_t freed : framesLive.front()) {
+                bench.Free(freed, frame);
+            }
+            framesLive.pop_front();
+        }
+    }
+    const double seconds = timer.Seconds();
+    const double operations = 2.0 * perFrame * benchFrames;
+
+    std::cout << frames << " frames, " << allocations << " allocations from " << capacity << " descriptors, GPU up to " << maxLag
+              << " frames behind, peak " << allocator.PeakLive() << " live, " << fullAllocations << " allocations found it full\n"
+              << earlyReuse << " indices reused before their fence, " << falseFull << " false out of descriptors, " << outOfRange
+              << " out of range, " << countMismatches << " live count mismatches, " << (drained ? "drained" : "NOT drained") << " at the end\n"
+              << "misuse " << (errors ? "rejected" : "NOT rejected") << " (double free, out of range, fence order)\n"
+              << operations / seconds / 1e6 << " M allocate/free per second with " << perFrame << " per frame\n";
+    return earlyReuse == 0 && falseFull == 0 && outOfRange == 0 && countMismatches == 0 && drained && errors ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBuilder.h"
+#include "Parallel.h"
+
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+bool SameMeshlets(const MeshletData& a, const MeshletData& b)
+{
+    return a.meshlets.size() == b.meshlets.size()
+        && std::equal(a.meshlets.begin(), a.meshlets.end(), b.meshlets.begin(), [](const Meshlet& x, const Meshlet& y) {
+               return x.VertCount == y.VertCount && x.VertOffset == y.VertOffset && x.PrimCount == y.PrimCount && x.PrimOffset == y.PrimOffset;
+           })
+        && a.uniqueVertexIndices == b.uniqueVertexIndices
+        && a.primitiveIndices == b.primitiveIndices;
+}
+
+} // namespace
+
+int BuildBenchCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const unsigned maxThreads = static_cast<unsigned>(args.GetUInt("threads", DefaultThreadCount()));
+    const uint64_t runs = std::max<uint64_t>(1, args.GetUInt("runs", 3));
+    const uint32_t maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", 128));
+    const uint32_t maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", 128));
+
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 4'000'000));
+    std::cout << mesh.indices.size() / 3 << " triangles, " << mesh.vertices.size() << " vertices\n" << std::fixed;
+
+    auto measure = [&](const char* name, auto&& build)
+    {
+        double best = 1e30;
+        MeshletData data;
+        for (uint64_t run = 0; run < runs; ++run) {
+            Stopwatch timer;
+            data = build();
+            best = std::min(best, timer.Seconds());
+        }
+        std::cout << "  " << std::left << std::setw(20) << name << std::right << std::setprecision(3) << std::setw(8) << best << " s "
+                  << std::setprecision(2) << std::setw(8) << mesh.indices.size() / 3 / best / 1e6 << " Mtri/s  "
+                  << data.meshlets.size() << " meshlets\n";
+        return std::make_pair(best, std::move(data));
+    };
+
+    const auto serial = measure("greedy (serial)", [&] {
+        return MeshletBuilder::Build(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), maxVertices, maxPrimitives);
+    });
+    ValidateMeshlets(serial.second, mesh.indices, maxVertices, maxPrimitives);
+
+    MeshletData reference;
+    double singleThreaded = 0.0;
+    for (unsigned threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        const std::string name = "parallel " + std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+        auto result = measure(name.c_str(), [&] {
+            return MeshletBuilder::BuildParallel(mesh.indices.data(), mesh.indices.size(), &mesh.vertices[0].position, mesh.vertices.size(),
+                                                 maxVertices, maxPrimitives, threads, sizeof(Vertex));
+        });
+        if (threads == 1) {
+            ValidateMeshlets(result.second, mesh.indices, maxVertices, maxPrimitives);
+            reference = std::move(result.second);
+            singleThreaded = result.first;
+        } else {
+            std::cout << "      speedup " << std::setprecision(2) << singleThreaded / result.first << "x, output "
+                      << (SameMeshlets(reference, result.second) ? "identical" : "DIFFERENT") << "\n";
+            if (!SameMeshlets(reference, result.second)) {
+                return 1;
+            }
+        }
+        if (threads >= maxThreads) {
+            break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// MeshletTool commands. Each one gets the arguments following its name and returns the process exit code.
+
+int OcclusionCheckCommand(const std::vector<std::string>& args);
+int HeapAllocBenchCommand(const std::vector<std::string>& args);
+int ObjBenchCommand(const std::vector<std::string>& args);
+int StartupCommand(const std::vector<std::string>& args);
+int OutOfCoreCommand(const std::vector<std::string>& args);
+int BindlessCheckCommand(const std::vector<std::string>& args);
+int BatchCullBenchCommand(const std::vector<std::string>& args);
+int BuildBenchCommand(const std::vector<std::string>& args);
+int ConeOrbitCommand(const std::vector<std::string>& args);
+int OccupancyCommand(const std::vector<std::string>& args);
+int StatsCommand(const std::vector<std::string>& args);
+int CullBenchCommand(const std::vector<std::string>& args);
+int CullCheckCommand(const std::vector<std::string>& args);
+int FramePacingCommand(const std::vector<std::string>& args);
+int IndirectCheckCommand(const std::vector<std::string>& args);
+int LocalityBenchCommand(const std::vector<std::string>& args);
+int LayoutCheckCommand(const std::vector<std::string>& args);
+int PrimitiveCheckCommand(const std::vector<std::string>& args);
+int PrimitiveCullCommand(const std::vector<std::string>& args);
+int RecordBenchCommand(const std::vector<std::string>& args);
+int QuantizeCheckCommand(const std::vector<std::string>& args);
+int SoaBenchCommand(const std::vector<std::string>& args);
+int UploadArenaCheckCommand(const std::vector<std::string>& args);
+int UploadQueueStressCommand(const std::vector<std::string>& args);
+int UploadRingStressCommand(const std::vector<std::string>& args);
@@ -0,0 +1,106 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBounds.h"
+#include "MeshletCulling.h"
+#include "MeshletStats.h"
+#include "VectorMath.h"
+
+#include <cfloat>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+int ConeOrbitCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint32_t steps = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("steps", 360)));
+    const float tilt = args.GetFloat("tilt", 0.f) * 3.14159265f / 180.f;
+    const float distance = args.GetFloat("distance", 3.f);
+
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    params.coneWeight = args.GetFloat("cone-weight", params.coneWeight);
+    params.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", params.maxVertices));
+    params.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", params.maxPrimitives));
+
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    const MeshletData data = BuildMeshlets(mesh, params);
+    const Float3* positions = &mesh.vertices[0].position;
+    const std::vector<MeshletBounds> bounds = MeshletBoundsBuilder::Compute(data, positions, sizeof(Vertex));
+    const std::vector<PackedMeshletBounds> packed = MeshletBoundsBuilder::Pack(bounds, data, positions, sizeof(Vertex));
+
+    Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const Vertex& vertex : mesh.vertices) {
+        lo = Min(lo, vertex.position);
+        hi = Max(hi, vertex.position);
+    }
+    const Float3 center = (lo + hi) * 0.5f;
+    const float radius = Length(hi - lo) * 0.5f;
+
+    uint64_t openCones = 0;
+    for (const PackedMeshletBounds& b : packed) {
+        openCones += b.coneCutoff == PackedMeshletBounds::OpenCone;
+    }
+    const uint64_t triangles = mesh.indices.size() / 3;
+    std::cout << triangles << " triangles, " << data.meshlets.size() << " meshlets, " << 100.0 * openCones / packed.size() << "% open packed cones, "
+              << steps << " steps, tilt " << args.GetFloat("tilt", 0.f) << " degrees\n"
+              << "cone data per meshlet: " << sizeof(MeshletBounds) << " bytes float, " << sizeof(PackedMeshletBounds) << " bytes packed (with the sphere)\n\n";
+
+    std::cout << std::right << std::setw(8) << "angle" << std::setw(14) << "float mshl" << std::setw(14) << "float tris"
+              << std::setw(14) << "8-bit mshl" << std::setw(14) << "8-bit tris" << "\n";
+
+    struct Totals
+    {
+        uint64_t floatMeshlets = 0, floatTriangles = 0, packedMeshlets = 0, packedTriangles = 0;
+    } total, row;
+    uint64_t wrong = 0;
+    const uint32_t rowEvery = std::max(1u, steps / 12);
+    uint32_t rowSteps = 0;
+
+    for (uint32_t step = 0; step < steps; ++step) {
+        // Circle in the xz plane, tilted around x
+        const double angle = 2.0 * 3.14159265358979 * step / steps;
+        const Float3 direction = { float(std::cos(angle)), float(std::sin(angle) * std::sin(tilt)), float(std::sin(angle) * std::cos(tilt)) };
+        const Float3 camera = center + direction * (radius * distance);
+
+        for (size_t i = 0; i < data.meshlets.size(); ++i) {
+            const uint32_t primitives = data.meshlets[i].PrimCount;
+            if (ConeCulled(bounds[i], camera)) {
+                ++row.floatMeshlets;
+                row.floatTriangles += primitives;
+            }
+            if (!MeshletCulling::ConeVisible(packed[i], camera)) {
+                ++row.packedMeshlets;
+                row.packedTriangles += primitives;
+                wrong += !AllBackFacing(data.meshlets[i], data, mesh, camera);
+            }
+        }
+
+        ++rowSteps;
+        if (rowSteps == rowEvery || step + 1 == steps) {
+            const double meshletViews = double(data.meshlets.size()) * rowSteps;
+            const double triangleViews = double(triangles) * rowSteps;
+            std::cout << std::fixed << std::setprecision(1) << std::setw(7) << 360.0 * (step + 1 - rowSteps) / steps << "d"
+                      << std::setw(13) << 100.0 * row.floatMeshlets / meshletViews << "%" << std::setw(13) << 100.0 * row.floatTriangles / triangleViews << "%"
+                      << std::setw(13) << 100.0 * row.packedMeshlets / meshletViews << "%" << std::setw(13) << 100.0 * row.packedTriangles / triangleViews << "%\n";
+            total.floatMeshlets += row.floatMeshlets;
+            total.floatTriangles += row.floatTriangles;
+            total.packedMeshlets += row.packedMeshlets;
+            total.packedTriangles += row.packedTriangles;
+            row = Totals();
+            rowSteps = 0;
+        }
+    }
+
+    const double meshletViews = double(data.meshlets.size()) * steps;
+    const double triangleViews = double(triangles) * steps;
+    std::cout << std::setw(8) << "orbit" << std::setw(13) << 100.0 * total.floatMeshlets / meshletViews << "%" << std::setw(13) << 100.0 * total.floatTriangles / triangleViews << "%"
+              << std::setw(13) << 100.0 * total.packedMeshlets / meshletViews << "%" << std::setw(13) << 100.0 * total.packedTriangles / triangleViews << "%\n";
+
+    std::cout << "\nrows average the steps from their angle on, mshl / tris = meshlets / triangles rejected by the cone test\n"
+              << wrong << " packed rejections with a front facing triangle\n";
+    return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBounds.h"
+#include "MeshletBuilder.h"
+#include "MeshletStats.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+int CullBenchCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint32_t views = static_cast<uint32_t>(args.GetUInt("views", 64));
+
+    MeshletBuildParams base;
+    base.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", base.maxVertices));
+    base.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", base.maxPrimitives));
+
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    const Float3* positions = &mesh.vertices[0].position;
+    std::cout << mesh.indices.size() / 3 << " triangles, " << mesh.vertices.size() << " vertices, " << views << " views\n\n";
+
+    std::cout << std::left << std::setw(18) << "builder" << std::right << std::setw(9) << "build s" << std::setw(10) << "meshlets"
+              << std::setw(10) << "avg prim" << std::setw(8) << "dup" << std::setw(12) << "radius p50" << std::setw(12) << "radius p90"
+              << std::setw(11) << "cone p50" << std::setw(11) << "open" << std::setw(13) << "culled tris" << "\n";
+
+    auto run = [&](const std::string& name, const MeshletBuildParams& params)
+    {
+        Stopwatch timer;
+        const MeshletData data = BuildMeshlets(mesh, params);
+        const double seconds = timer.Seconds();
+        ValidateMeshlets(data, mesh.indices, params.maxVertices, params.maxPrimitives);
+
+        const std::vector<MeshletBounds> bounds = MeshletBoundsBuilder::Compute(data, positions, sizeof(Vertex));
+        const MeshletStats stats = MeshletStats::Analyze(data, bounds, positions, mesh.vertices.size(), sizeof(Vertex), views);
+
+        std::cout << std::left << std::setw(18) << name << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(9) << seconds << std::setw(10) << stats.meshlets
+                  << std::setprecision(1) << std::setw(10) << stats.averagePrimitives
+                  << std::setprecision(3) << std::setw(8) << stats.duplicationRatio
+                  << std::setprecision(4) << std::setw(12) << stats.boundingRadius.p50 << std::setw(12) << stats.boundingRadius.p90
+                  << std::setprecision(1) << std::setw(10) << stats.coneAngle.p50 << "d" << std::setw(10) << 100.0 * stats.openCones / stats.meshlets << "%"
+                  << std::setw(12) << 100.0 * stats.coneCullTriangles << "%\n";
+    };
+
+    MeshletBuildParams params = base;
+    params.builder = MeshletBuilderKind::Greedy;
+    run("greedy", params);
+    params.builder = MeshletBuilderKind::Parallel;
+    run("parallel", params);
+    params.builder = MeshletBuilderKind::Clustered;
+    for (const float weight : { 0.f, 0.25f, 0.5f, 0.75f, 1.f }) {
+        params.coneWeight = weight;
+        std::ostringstream name;
+        name << "clustered " << std::setprecision(2) << weight;
+        run(name.str(), params);
+    }
+
+    std::cout << "\nradius in mesh radii, cone = normal spread half angle, open = cones that can't cull,\n"
+                 "culled tris = triangles rejected by the cone test averaged over the views\n";
+    return 0;
+}
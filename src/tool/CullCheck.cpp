@@ -0,0 +1,155 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBounds.h"
+#include "MeshletCulling.h"
+#include "MeshletPack.h"
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// Clip space outcodes in double, independent of the plane extraction: bit i set when the point is
+// outside clip plane i in Frustum order.
+uint32_t OutCode(const Float3& p, const Matrix& m)
+{
+    double clip[4];
+    for (int c = 0; c < 4; ++c) {
+        clip[c] = double(p.x) * m[0][c] + double(p.y) * m[1][c] + double(p.z) * m[2][c] + double(m[3][c]);
+    }
+    const double w = clip[3];
+    return (clip[0] < -w) << 0 | (clip[0] > w) << 1 | (clip[1] < -w) << 2 | (clip[1] > w) << 3 | (clip[2] < 0.0) << 4 | (clip[2] > w) << 5;
+}
+
+// Same loop as MeshletAS.hlsl: one group per GroupSize meshlets, survivors compacted by lane prefix count
+std::vector<uint32_t> EmulateAmplificationShader(const Frustum& frustum, const Float3& camera, const std::vector<PackedMeshletBounds>& bounds)
+{
+    const uint32_t meshletCount = static_cast<uint32_t>(bounds.size());
+    std::vector<uint32_t> launched;
+    for (uint32_t group = 0; group < (meshletCount + MeshletCulling::GroupSize - 1) / MeshletCulling::GroupSize; ++group) {
+        uint32_t payload[MeshletCulling::GroupSize];
+        uint32_t ballot = 0;
+        for (uint32_t lane = 0; lane < MeshletCulling::GroupSize; ++lane) {
+            const uint32_t index = group * MeshletCulling::GroupSize + lane;
+            if (index < meshletCount && MeshletCulling::Visible(frustum, camera, bounds[index])) {
+                ballot |= 1u << lane;
+            }
+        }
+        uint32_t count = 0;
+        for (uint32_t lane = 0; lane < MeshletCulling::GroupSize; ++lane) {
+            if (ballot & (1u << lane)) {
+                payload[count++] = group * MeshletCulling::GroupSize + lane;
+            }
+        }
+        launched.insert(launched.end(), payload, payload + count);
+    }
+    return launched;
+}
+
+} // namespace
+
+int CullCheckCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    params.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", params.maxVertices));
+    params.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", params.maxPrimitives));
+
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    const MeshletData data = BuildMeshlets(mesh, params);
+    const Float3* positions = &mesh.vertices[0].position;
+    const std::vector<PackedMeshletBounds> bounds = MeshletBoundsBuilder::Pack(MeshletBoundsBuilder::Compute(data, positions, sizeof(Vertex)),
+                                                                               data, positions, sizeof(Vertex));
+
+    Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const Vertex& vertex : mesh.vertices) {
+        lo = Min(lo, vertex.position);
+        hi = Max(hi, vertex.position);
+    }
+    const Float3 center = (lo + hi) * 0.5f;
+    const float radius = Length(hi - lo) * 0.5f;
+    std::cout << mesh.indices.size() / 3 << " triangles, " << data.meshlets.size() << " meshlets\n\n";
+
+    // Fixed cameras around the mesh bounds. expected: -1 any, 0 nothing visible, 1 everything inside the frustum.
+    // The synthetic grid is a height field facing +y, so cameras stay above it to not cone cull it all.
+    struct Camera
+    {
+        const char* name;
+        Float3      eye;
+        Float3      target;
+        float       fovDegrees;
+        int         expected;
+    } const cameras[] = {
+        { "front",   center + Float3{ 0.f, 0.f, 2.f * radius },         center,                                   60.f, -1 },
+        { "corner",  center + Float3{ 1.f, 1.f, 1.f } * radius,         center + Float3{ 0.5f, 0.f, 0.f } * radius, 45.f, -1 },
+        { "zoomed",  center + Float3{ 0.f, 0.5f, 1.5f } * radius,       center + Float3{ 0.25f, 0.f, 0.f } * radius, 20.f, -1 },
+        { "inside",  center,                                             center + Float3{ 1.f, 0.f, 0.f },         90.f, -1 },
+        { "away",    center + Float3{ 0.f, 0.f, 2.f * radius },         center + Float3{ 0.f, 0.f, 3.f * radius }, 60.f, 0 },
+        { "distant", center + Float3{ 0.f, 0.f, 20.f * radius },        center,                                   60.f, 1 },
+    };
+
+    std::cout << std::left << std::setw(10) << "camera" << std::right << std::setw(10) << "visible" << std::setw(10) << "culled"
+              << std::setw(12) << "false vis" << std::setw(10) << "wrong" << std::setw(20) << "checksum" << "\n";
+
+    bool failed = false;
+    for (const Camera& camera : cameras) {
+        Matrix view, projection, viewProjection;
+        LookAt(camera.eye, camera.target, Float3{ 0.f, 1.f, 0.f }, view);
+        Perspective(camera.fovDegrees * 3.14159265f / 180.f, 16.f / 9.f, 0.01f * radius, 100.f * radius, projection);
+        Multiply(view, projection, viewProjection);
+
+        const Frustum frustum = Frustum::FromMatrix(viewProjection);
+        const std::vector<uint32_t> visible = MeshletCulling::Cull(frustum, camera.eye, bounds.data(), static_cast<uint32_t>(bounds.size()));
+        if (EmulateAmplificationShader(frustum, camera.eye, bounds) != visible) {
+            throw std::runtime_error(std::string("amplification shader emulation differs from MeshletCulling::Cull for camera ") + camera.name);
+        }
+
+        // wrong: culled although no clip plane has all of the meshlet's vertices outside and
+        // the camera sees the front of some triangle.
+        // false vis: passed although one clip plane does, the price of testing spheres.
+        uint64_t wrong = 0;
+        uint64_t falseVisible = 0;
+        size_t next = 0;
+        for (uint32_t i = 0; i < data.meshlets.size(); ++i) {
+            const Meshlet& meshlet = data.meshlets[i];
+            uint32_t outside = 0x3F;
+            for (uint32_t v = 0; v < meshlet.VertCount; ++v) {
+                outside &= OutCode(mesh.vertices[data.uniqueVertexIndices[meshlet.VertOffset + v]].position, viewProjection);
+            }
+            const bool passed = next < visible.size() && visible[next] == i;
+            next += passed;
+            wrong += !passed && !outside && !AllBackFacing(meshlet, data, mesh, camera.eye);
+            falseVisible += passed && outside;
+        }
+
+        const uint64_t checksum = MeshletPack::HashBytes(visible.data(), visible.size() * sizeof(uint32_t));
+        std::cout << std::left << std::setw(10) << camera.name << std::right << std::setw(10) << visible.size()
+                  << std::setw(10) << bounds.size() - visible.size() << std::setw(12) << falseVisible << std::setw(10) << wrong
+                  << std::setw(4) << "" << std::hex << std::setfill('0') << std::setw(16) << checksum << std::dec << std::setfill(' ') << "\n";
+
+        failed |= wrong != 0;
+        failed |= camera.expected == 0 && !visible.empty();
+        failed |= camera.expected == 1 && !std::all_of(bounds.begin(), bounds.end(), [&](const PackedMeshletBounds& b) {
+            return MeshletCulling::SphereVisible(frustum, b.center, b.radius);
+        });
+    }
+
+    std::cout << "\nfalse vis = passed with all vertices outside one clip plane, wrong = culled while possibly visible (frustum or cone)\n"
+                 "checksum = hash of the visible meshlet list, compare against a readback of the amplification shader payloads\n";
+    if (failed) {
+        std::cout << "FAILED\n";
+        return 1;
+    }
+    std::cout << "OK\n";
+    return 0;
+}
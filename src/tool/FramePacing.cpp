@@ -0,0 +1,170 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// GPU queue on a simulated clock. Work runs in submission order, starting when the GPU is free and
+// the CPU has submitted it. Waiting moves the CPU clock to the completion of the awaited work.
+class SimulatedQueue : public FrameQueue
+{
+public:
+    double cpuTime = 0.0;       // ms, advanced by the caller for CPU work and by WaitFor
+
+    void Submit(double gpuMs)
+    {
+        const double start = std::max(cpuTime, _gpuFreeAt);
+        _gpuIdle += start - _gpuFreeAt;
+        _gpuFreeAt = start + gpuMs;
+    }
+
+    uint64_t Signal() override
+    {
+        _completions.push_back(_gpuFreeAt);
+        return _completions.size();
+    }
+
+    uint64_t CompletedValue() override
+    {
+        return std::upper_bound(_completions.begin(), _completions.end(), cpuTime) - _completions.begin();
+    }
+
+    void WaitFor(uint64_t value) override
+    {
+        if (value > _completions.size()) {
+            throw std::logic_error("Waiting for a fence value that was never signaled");
+        }
+        const double completion = _completions[value - 1];
+        if (completion > cpuTime) {
+            _cpuWait += completion - cpuTime;
+            cpuTime = completion;
+        }
+    }
+
+    double CompletionTime(uint64_t value) const { return _completions[value - 1]; }
+    double CpuWait() const { return _cpuWait; }
+    double GpuIdle() const { return _gpuIdle; }
+    double GpuFreeAt() const { return _gpuFreeAt; }
+
+private:
+    std::vector<double> _completions;   // per fence value, non-decreasing
+    double              _gpuFreeAt = 0.0;
+    double              _gpuIdle = 0.0;
+    double              _cpuWait = 0.0;
+};
+
+struct PacingResult
+{
+    double      msPerFrame;
+    double      cpuWaitShare;
+    double      gpuIdleShare;
+    double      latencyMs;      // CPU frame start to GPU completion, average
+    uint32_t    maxInFlight;
+    uint64_t    hazards;
+};
+
+// Deterministic frame times: base * (1 +- jitter)
+class FrameTimes
+{
+public:
+    FrameTimes(double base, double jitter, uint32_t seed) : _base(base), _jitter(jitter), _state(seed) {}
+
+    double Next()
+    {
+        _state = _state * 1664525u + 1013904223u;
+        const double unit = (_state >> 8) * (1.0 / (1u << 24));
+        return _base * (1.0 + _jitter * (2.0 * unit - 1.0));
+    }
+
+private:
+    double      _base;
+    double      _jitter;
+    uint32_t    _state;
+};
+
+PacingResult Simulate(uint32_t framesInFlight, uint32_t frames, double cpuMs, double gpuMs, double jitter)
+{
+    SimulatedQueue queue;
+    FrameScheduler scheduler(queue, framesInFlight);
+    FrameTimes cpuTimes(cpuMs, jitter, 1);
+    FrameTimes gpuTimes(gpuMs, jitter, 2);
+
+    // Tracked here independently of the scheduler: which fence releases every slot
+    std::vector<uint64_t> slotRelease(framesInFlight, 0);
+    std::vector<uint64_t> frameFences;
+    PacingResult result = {};
+    double latency = 0.0;
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        const uint32_t slot = scheduler.BeginFrame();
+        const double frameStart = queue.cpuTime;
+        // Writing the slot's allocator or constants while the GPU still reads them
+        result.hazards += queue.CompletedValue() < slotRelease[slot];
+
+        uint32_t inFlight = 1;
+        for (const uint64_t fence : frameFences) {
+            inFlight += queue.CompletedValue() < fence;
+        }
+        result.maxInFlight = std::max(result.maxInFlight, inFlight);
+
+        queue.cpuTime += cpuTimes.Next();
+        queue.Submit(gpuTimes.Next());
+        slotRelease[slot] = scheduler.EndFrame();
+        frameFences.push_back(slotRelease[slot]);
+        latency += queue.CompletionTime(slotRelease[slot]) - frameStart;
+    }
+    scheduler.WaitIdle();
+
+    const double total = std::max(queue.cpuTime, queue.GpuFreeAt());
+    result.msPerFrame = total / frames;
+    result.cpuWaitShare = queue.CpuWait() / total;
+    result.gpuIdleShare = (queue.GpuIdle() + total - queue.GpuFreeAt()) / total;
+    result.latencyMs = latency / frames;
+    return result;
+}
+
+} // namespace
+
+int FramePacingCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint32_t frames = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("frames", 600)));
+    const double jitter = args.GetFloat("jitter", 0.3);
+    const uint32_t maxFramesInFlight = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("max-frames-in-flight", 3)));
+
+    struct Scenario
+    {
+        const char* name;
+        double      cpuMs;
+        double      gpuMs;
+    };
+    const Scenario scenarios[] = { { "balanced", 8.0, 8.0 }, { "cpu bound", 10.0, 6.0 }, { "gpu bound", 6.0, 10.0 } };
+
+    std::cout << frames << " simulated frames per run, frame times +-" << jitter * 100.0 << "%\n\n";
+    std::cout << std::left << std::setw(12) << "scenario" << std::right << std::setw(10) << "in flight" << std::setw(10) << "ms/frame"
+              << std::setw(10) << "cpu wait" << std::setw(10) << "gpu idle" << std::setw(12) << "latency ms" << std::setw(9) << "hazards" << "\n";
+
+    bool ok = true;
+    for (const Scenario& scenario : scenarios) {
+        double serial = 0.0;
+        for (uint32_t framesInFlight = 1; framesInFlight <= maxFramesInFlight; ++framesInFlight) {
+            const PacingResult result = Simulate(framesInFlight, frames, scenario.cpuMs, scenario.gpuMs, jitter);
+            std::cout << std::left << std::setw(12) << (framesInFlight == 1 ? scenario.name : "") << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(10) << framesInFlight << std::setw(10) << result.msPerFrame
+                      << std::setprecision(1) << std::setw(9) << 100.0 * result.cpuWaitShare << "%" << std::setw(9) << 100.0 * result.gpuIdleShare << "%"
+                      << std::setprecision(2) << std::setw(12) << result.latencyMs << std::setw(9) << result.hazards << "\n";
+
+            serial = framesInFlight == 1 ? result.msPerFrame : serial;
+            ok = ok && result.hazards == 0 && result.maxInFlight <= framesInFlight && result.msPerFrame <= serial;
+        }
+    }
+
+    std::cout << "\n1 in flight is the old Render: every frame waits for its own fence, CPU and GPU never overlap.\n"
+                 "hazards = frames that got a slot the GPU was still using\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "HeapAllocator.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+
+enum Category : uint32_t
+{
+    Geometry = 0,       // vertices
+    Meshlets,           // meshlets, unique vertex indices, primitive indices
+    Culling,            // meshlet bounds and visibility
+    CategoryCount
+};
+
+const char* const CategoryNames[] = { "geometry", "meshlets", "culling" };
+
+// Buffer sizes of a mesh with the given triangle count, as InitSample creates them
+struct MeshBuffer
+{
+    uint64_t    size;
+    Category    category;
+};
+
+std::vector<MeshBuffer> MeshBuffers(uint64_t triangles)
+{
+    const uint64_t vertices = triangles / 2 + 3;
+    const uint64_t meshlets = triangles / 124 + 1;
+    return {
+        { vertices * 32, Geometry },                    // Vertex
+        { meshlets * 16, Meshlets },                    // Meshlet
+        { meshlets * 64 * 4, Meshlets },                // unique vertex indices
+        { triangles * 4, Meshlets },                    // packed primitives
+        { meshlets * 32, Culling },                     // PackedMeshletBounds
+        { meshlets * 4, Culling },                      // visibility
+    };
+}
+
+struct Mesh
+{
+    std::vector<HeapAllocation> allocations;
+};
+
+struct RunResult
+{
+    uint64_t    operations = 0;
+    double      seconds = 0.0;
+    uint64_t    misaligned = 0;
+    uint64_t    overlapping = 0;
+    bool        valid = true;
+};
+
+// One mesh load or unload per step: the scene is filled to meshCount meshes, then meshes are
+// replaced at random, small ones far more often than large ones.
+RunResult Run(HeapAllocator& allocator, uint64_t alignment, uint32_t meshCount, uint64_t churn, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    std::lognormal_distribution<double> triangles(std::log(20'000.0), 1.5);
+    auto load = [&](Mesh& mesh, RunResult& result)
+    {
+        const uint64_t count = std::min<uint64_t>(8'000'000, 64 + static_cast<uint64_t>(triangles(random)));
+        for (const MeshBuffer& buffer : MeshBuffers(count)) {
+            const HeapAllocation allocation = allocator.Allocate(buffer.size, alignment, buffer.category);
+            result.misaligned += allocation.offset % alignment != 0;
+            mesh.allocations.push_back(allocation);
+            ++result.operations;
+        }
+    };
+    auto unload = [&](Mesh& mesh, RunResult& result)
+    {
+        for (const HeapAllocation& allocation : mesh.allocations) {
+            allocator.Free(allocation);
+            ++result.operations;
+        }
+        mesh.allocations.clear();
+    };
+
+    RunResult result;
+    std::vector<Mesh> meshes(meshCount);
+    Stopwatch timer;
+    for (Mesh& mesh : meshes) {
+        load(mesh, result);
+    }
+    for (uint64_t step = 0; step < churn; ++step) {
+        Mesh& mesh = meshes[random() % meshCount];
+        unload(mesh, result);
+        load(mesh, result);
+    }
+    result.seconds = timer.Seconds();
+
+    try {
+        allocator.Validate();
+    } catch (const std::logic_error& error) {
+        std::cout << error.what() << "\n";
+        result.valid = false;
+    }
+    std::vector<HeapAllocation> live;
+    for (const Mesh& mesh : meshes) {
+        live.insert(live.end(), mesh.allocations.begin(), mesh.allocations.end());
+    }
+    std::sort(live.begin(), live.end(), [](const HeapAllocation& a, const HeapAllocation& b) {
+        return a.block != b.block ? a.block < b.block : a.offset < b.offset;
+    });
+    for (size_t i = 1; i < live.size(); ++i) {
+        result.overlapping += live[i].block == live[i - 1].block && live[i].offset < live[i - 1].offset + live[i - 1].size;
+    }
+    return result;
+}
+
+} // namespace
+
+// Fragmentation and throughput of HeapAllocator under a mesh streaming workload, against one
+// committed resource (its own implicit heap) per buffer.
+int HeapAllocBenchCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint32_t meshCount = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("meshes", 4000)));
+    const uint64_t churn = args.GetUInt("churn", 100'000);
+    const uint64_t blockSize = args.GetUInt("block-mb", 64) * 1024 * 1024;
+    const uint64_t seed = args.GetUInt("seed", 1);
+
+    std::cout << meshCount << " meshes of " << MeshBuffers(1).size() << " buffers, " << churn << " mesh replacements, "
+              << blockSize / (1024 * 1024) << " MB blocks\n\n";
+    std::cout << std::right << std::setw(10) << "alignment" << std::setw(12) << "live MB" << std::setw(12) << "heap MB" << std::setw(9) << "heaps"
+              << std::setw(14) << "committed MB" << std::setw(11) << "committed" << std::setw(8) << "frag" << std::setw(10) << "M ops/s" << "\n";
+
+    bool ok = true;
+    // 64 KiB: D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, what every placed buffer needs.
+    // 256 bytes: buffers suballocated from shared resources.
+    for (const uint64_t alignment : { uint64_t(64 * 1024), uint64_t(256) }) {
+        HeapAllocator allocator(blockSize, alignment);
+        const RunResult result = Run(allocator, alignment, meshCount, churn, seed);
+
+        uint64_t live = 0, liveCount = 0;
+        for (uint32_t category = 0; category < CategoryCount; ++category) {
+            live += allocator.Category(category).bytes;
+            liveCount += allocator.Category(category).allocations;
+        }
+        // Committed: every buffer rounded up to 64 KiB in a heap of its own. Same random sequence, so same sizes.
+        HeapAllocator committed(64 * 1024, 64 * 1024);
+        Run(committed, 64 * 1024, meshCount, churn, seed);
+        const uint64_t committedBytes = committed.PeakUsedBytes();
+
+        std::cout << std::fixed << std::setw(10) << alignment << std::setprecision(1) << std::setw(12) << live / 1048576.0
+                  << std::setw(12) << allocator.ReservedBytes() / 1048576.0 << std::setw(9) << allocator.BlockCount()
+                  << std::setw(14) << committedBytes / 1048576.0 << std::setw(11) << liveCount
+                  << std::setprecision(3) << std::setw(8) << allocator.Fragmentation()
+                  << std::setprecision(2) << std::setw(10) << result.operations / result.seconds / 1e6 << "\n";
+        for (uint32_t category = 0; category < CategoryCount; ++category) {
+            const HeapCategoryStats& stats = allocator.Category(category);
+            std::cout << std::setw(22) << CategoryNames[category] << ": " << stats.allocations << " live, "
+                      << std::setprecision(1) << stats.bytes / 1048576.0 << " MB, peak " << stats.peakBytes / 1048576.0 << " MB, "
+                      << stats.totalAllocations << " allocations\n";
+        }
+        if (result.misaligned != 0 || result.overlapping != 0 || !result.valid) {
+            std::cout << std::setw(22) << "FAILED" << ": " << result.misaligned << " misaligned, " << result.overlapping << " overlapping\n";
+            ok = false;
+        }
+    }
+
+    std::cout << "\nheap MB/heaps = blocks the allocator reserved at the end, committed MB = peak footprint of the same buffers as committed resources,\n"
+                 "committed = implicit heaps they would create\n"
+                 "frag = 1 - largest free range / free bytes at the end\n";
+    return ok ? 0 : 1;
+}
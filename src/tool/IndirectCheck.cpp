@@ -0,0 +1,173 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "IndirectDraws.h"
+#include "MeshletBounds.h"
+#include "MeshletCulling.h"
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+namespace {
+
+const uint32_t WaveSize = 32;
+
+// DrawCullCS.hlsl with the waves of all groups running in a random order: every wave bumps the count
+// by its visible lanes and writes them from the returned base in lane order.
+uint32_t EmulateDrawCulling(const Frustum& frustum, const std::vector<MeshletDraw>& draws, DispatchMeshCommand* commands, std::mt19937& random)
+{
+    const uint32_t drawCount = static_cast<uint32_t>(draws.size());
+    const uint32_t groups = (drawCount + IndirectDraws::GroupSize - 1) / IndirectDraws::GroupSize;
+    std::vector<uint32_t> waves(groups * (IndirectDraws::GroupSize / WaveSize));
+    std::iota(waves.begin(), waves.end(), 0);
+    std::shuffle(waves.begin(), waves.end(), random);
+
+    uint32_t count = 0;
+    for (const uint32_t wave : waves) {
+        uint32_t ballot = 0;
+        for (uint32_t lane = 0; lane < WaveSize; ++lane) {
+            const uint32_t index = wave * WaveSize + lane;
+            if (index < drawCount && MeshletCulling::SphereVisible(frustum, draws[index].center, draws[index].radius)) {
+                ballot |= 1u << lane;
+            }
+        }
+        const uint32_t base = count;
+        uint32_t prefix = 0;
+        for (uint32_t lane = 0; lane < WaveSize; ++lane) {
+            if (ballot & (1u << lane)) {
+                commands[base + prefix++] = IndirectDraws::Command(draws[wave * WaveSize + lane]);
+            }
+        }
+        count += prefix;
+    }
+    return count;
+}
+
+} // namespace
+
+// The draws are frustum culled the way DrawCullCS.hlsl does it and the surviving commands are checked
+// against the in-order reference. No meshlet the amplification shader would keep may sit in a culled draw.
+int IndirectCheckCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint32_t meshletsPerDraw = static_cast<uint32_t>(args.GetUInt("meshlets-per-draw", 1024));
+    const uint64_t copies = std::max<uint64_t>(1, args.GetUInt("copies", 64));
+    const uint32_t viewCount = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("views", 16)));
+
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 200'000));
+    const MeshletData data = BuildMeshlets(mesh, params);
+    const Float3* positions = &mesh.vertices[0].position;
+    const std::vector<PackedMeshletBounds> meshBounds = MeshletBoundsBuilder::Pack(MeshletBoundsBuilder::Compute(data, positions, sizeof(Vertex)),
+                                                                                   data, positions, sizeof(Vertex));
+
+    Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const Vertex& vertex : mesh.vertices) {
+        lo = Min(lo, vertex.position);
+        hi = Max(hi, vertex.position);
+    }
+    const Float3 extent = hi - lo;
+
+    // Scene: copies of the mesh on a square grid in the xz plane, one meshlet array like the sample's
+    const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(double(copies))));
+    std::vector<PackedMeshletBounds> bounds;
+    bounds.reserve(copies * meshBounds.size());
+    for (uint64_t copy = 0; copy < copies; ++copy) {
+        const Float3 offset = { (copy % side) * extent.x * 1.1f, 0.f, (copy / side) * extent.z * 1.1f };
+        for (PackedMeshletBounds b : meshBounds) {
+            b.center = b.center + offset;
+            bounds.push_back(b);
+        }
+    }
+    const uint32_t meshletCount = static_cast<uint32_t>(bounds.size());
+
+    // Made up heap indices, every command has to carry them to the root constants
+    const MeshDescriptors descriptors = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    Stopwatch buildTimer;
+    const std::vector<MeshletDraw> draws = IndirectDraws::Build(bounds.data(), meshletCount, meshletsPerDraw, descriptors);
+    const double buildSeconds = buildTimer.Seconds();
+    const uint32_t drawCount = static_cast<uint32_t>(draws.size());
+
+    // The draws tile the meshlets in order, and every meshlet sphere is inside its draw's
+    uint64_t badDraws = 0, escapingSpheres = 0;
+    uint32_t expectedOffset = 0;
+    std::vector<uint32_t> drawOf(meshletCount);
+    for (uint32_t d = 0; d < drawCount; ++d) {
+        const MeshletDraw& draw = draws[d];
+        const DispatchMeshCommand command = IndirectDraws::Command(draw);
+        badDraws += draw.meshletOffset != expectedOffset || draw.meshletCount == 0 || draw.meshletCount > meshletsPerDraw
+                    || command.threadGroupCountX > IndirectDraws::MaxThreadGroups
+                    || command.threadGroupCountX * MeshletCulling::GroupSize < draw.meshletCount
+                    || std::memcmp(&command.descriptors, &descriptors, sizeof(MeshDescriptors)) != 0;
+        for (uint32_t i = draw.meshletOffset; i < draw.meshletOffset + draw.meshletCount && i < meshletCount; ++i) {
+            drawOf[i] = d;
+            escapingSpheres += double(Length(bounds[i].center - draw.center)) + bounds[i].radius > draw.radius;
+        }
+        expectedOffset = draw.meshletOffset + draw.meshletCount;
+    }
+    badDraws += expectedOffset != meshletCount;
+
+    // Cameras circling above the middle of the scene, looking down at it
+    const Float3 sceneHi = { lo.x + side * extent.x * 1.1f, hi.y, lo.z + side * extent.z * 1.1f };
+    const Float3 sceneCenter = (lo + sceneHi) * 0.5f;
+    const float sceneRadius = Length(sceneHi - lo) * 0.5f;
+
+    std::mt19937 random(static_cast<uint32_t>(args.GetUInt("seed", 1)));
+    std::vector<DispatchMeshCommand> reference(drawCount), gpu(drawCount);
+    uint64_t mismatches = 0, missed = 0, acceptedDraws = 0, launchedGroups = 0, visibleMeshlets = 0;
+    double compactSeconds = 0.0;
+    for (uint32_t v = 0; v < viewCount; ++v) {
+        const float angle = 2.f * 3.14159265f * v / viewCount;
+        const Float3 eye = sceneCenter + Float3{ std::cos(angle) * 0.5f * sceneRadius, 0.3f * sceneRadius, std::sin(angle) * 0.5f * sceneRadius };
+        Matrix view, projection, viewProjection;
+        LookAt(eye, sceneCenter, Float3{ 0.f, 1.f, 0.f }, view);
+        Perspective(60.f * 3.14159265f / 180.f, 16.f / 9.f, 0.001f * sceneRadius, 2.f * sceneRadius, projection);
+        Multiply(view, projection, viewProjection);
+        const Frustum frustum = Frustum::FromMatrix(viewProjection);
+
+        Stopwatch timer;
+        const uint32_t count = IndirectDraws::Compact(frustum, draws.data(), drawCount, reference.data());
+        compactSeconds += timer.Seconds();
+
+        // Same set as the reference once the wave order is undone
+        const uint32_t gpuCount = EmulateDrawCulling(frustum, draws, gpu.data(), random);
+        std::sort(gpu.begin(), gpu.begin() + gpuCount,
+                  [](const DispatchMeshCommand& a, const DispatchMeshCommand& b) { return a.meshletOffset < b.meshletOffset; });
+        mismatches += gpuCount != count || std::memcmp(gpu.data(), reference.data(), sizeof(DispatchMeshCommand) * count) != 0;
+
+        std::vector<bool> accepted(drawCount, false);
+        for (uint32_t c = 0; c < count; ++c) {
+            accepted[reference[c].meshletOffset / meshletsPerDraw] = true;
+            launchedGroups += reference[c].threadGroupCountX;
+        }
+        for (uint32_t i = 0; i < meshletCount; ++i) {
+            if (MeshletCulling::SphereVisible(frustum, bounds[i].center, bounds[i].radius)) {
+                ++visibleMeshlets;
+                missed += !accepted[drawOf[i]];
+            }
+        }
+        acceptedDraws += count;
+    }
+
+    const uint64_t fullGroups = uint64_t((meshletCount + MeshletCulling::GroupSize - 1) / MeshletCulling::GroupSize) * viewCount;
+    std::cout << meshletCount << " meshlets (" << copies << " copies of " << meshBounds.size() << ") in " << drawCount << " draws of up to "
+              << meshletsPerDraw << ", built in " << std::fixed << std::setprecision(2) << buildSeconds * 1e3 << " ms, " << viewCount << " views\n"
+              << std::setprecision(1) << 100.0 * acceptedDraws / (double(drawCount) * viewCount) << "% of the draws kept, "
+              << 100.0 * launchedGroups / fullGroups << "% of the amplification groups of a full DispatchMesh launched, "
+              << 100.0 * visibleMeshlets / (double(meshletCount) * viewCount) << "% of the meshlets in the frustum\n"
+              << std::setprecision(3) << compactSeconds * 1e6 / viewCount << " us per view for the CPU reference compaction\n"
+              << "CPU calls per frame: 10 for the draw culling dispatch and 1 ExecuteIndirect per pass, for any number of draws\n"
+              << badDraws << " bad draws, " << escapingSpheres << " meshlet spheres outside their draw, "
+              << mismatches << " views where the wave compaction differs from Compact, " << missed << " visible meshlets in culled draws\n";
+    return badDraws == 0 && escapingSpheres == 0 && mismatches == 0 && missed == 0 ? 0 : 1;
+}
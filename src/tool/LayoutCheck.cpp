@@ -0,0 +1,77 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBuilder.h"
+#include "MeshletLayout.h"
+#include "MeshletReorder.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// What MeshletMS.hlsl emits for one meshlet: the vertex each thread loads, then the triangles over them
+void EmulateMeshShader(const MeshletData& data, const std::vector<Vertex>& vertices, MeshletVertexLayout layout, std::vector<Vertex>& triangles)
+{
+    triangles.clear();
+    std::vector<Vertex> groupVertices;
+    for (const Meshlet& meshlet : data.meshlets) {
+        groupVertices.resize(meshlet.VertCount);
+        for (uint32_t gtid = 0; gtid < meshlet.VertCount; ++gtid) {
+            const uint32_t localIndex = meshlet.VertOffset + gtid;
+            const uint32_t vertexIndex = layout == MeshletVertexLayout::Flat ? localIndex : data.uniqueVertexIndices.at(localIndex);
+            groupVertices[gtid] = vertices.at(vertexIndex);
+        }
+        for (uint32_t gtid = 0; gtid < meshlet.PrimCount; ++gtid) {
+            uint32_t i0, i1, i2;
+            UnpackTriangle(data.primitiveIndices[meshlet.PrimOffset + gtid], i0, i1, i2);
+            triangles.push_back(groupVertices.at(i0));
+            triangles.push_back(groupVertices.at(i1));
+            triangles.push_back(groupVertices.at(i2));
+        }
+    }
+}
+
+} // namespace
+
+int LayoutCheckCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    params.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", params.maxVertices));
+    params.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", params.maxPrimitives));
+
+    ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    MeshletData indexed = BuildMeshlets(mesh, params);
+    MeshletReorder::Apply(mesh, indexed, MeshletOrdering::Hilbert);
+    ValidateMeshlets(indexed, mesh.indices, params.maxVertices, params.maxPrimitives);
+
+    std::vector<Vertex> flatVertices = mesh.vertices;
+    MeshletData flat = indexed;
+    MeshletLayout::Flatten(flatVertices, flat);
+
+    const MeshletLayoutCost cost = MeshletLayout::Cost(indexed, mesh.vertices.size(), sizeof(Vertex));
+    const double mb = 1024.0 * 1024.0;
+    std::cout << mesh.indices.size() / 3 << " triangles, " << mesh.vertices.size() << " vertices, " << indexed.meshlets.size() << " meshlets\n\n"
+              << std::fixed << std::setprecision(2)
+              << "  indexed: " << std::setw(9) << cost.IndexedBytes() / mb << " MB (vertices " << cost.indexedVertexBytes / mb
+              << " MB + unique vertex indices " << cost.indexBytes / mb << " MB)\n"
+              << "  flat:    " << std::setw(9) << cost.FlatBytes() / mb << " MB (" << flat.meshlets.size() << " meshlets, "
+              << flatVertices.size() << " vertices)\n"
+              << "  flat is " << std::showpos << 100.0 * (double(cost.FlatBytes()) / cost.IndexedBytes() - 1.0) << std::noshowpos
+              << "% and saves one dependent load per vertex\n\n";
+
+    std::vector<Vertex> indexedTriangles;
+    std::vector<Vertex> flatTriangles;
+    EmulateMeshShader(indexed, mesh.vertices, MeshletVertexLayout::Indexed, indexedTriangles);
+    EmulateMeshShader(flat, flatVertices, MeshletVertexLayout::Flat, flatTriangles);
+
+    const bool identical = indexedTriangles.size() == flatTriangles.size()
+                        && std::memcmp(indexedTriangles.data(), flatTriangles.data(), indexedTriangles.size() * sizeof(Vertex)) == 0;
+    std::cout << "Emulated mesh shader output " << (identical ? "identical" : "DIFFERENT") << " for both layouts ("
+              << indexedTriangles.size() / 3 << " triangles)\n";
+    return identical ? 0 : 1;
+}
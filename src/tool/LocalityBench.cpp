@@ -0,0 +1,192 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBuilder.h"
+#include "MeshletReorder.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+namespace {
+
+// Set associative LRU cache, just tags. Stands in for the GPU L2 the mesh shader fetches go through.
+class CacheSimulator
+{
+public:
+    CacheSimulator(uint64_t sizeBytes, uint32_t lineBytes, uint32_t ways)
+        : _lineBytes(lineBytes)
+        , _ways(ways)
+        , _sets(std::max<uint64_t>(1, sizeBytes / (uint64_t(lineBytes) * ways)))
+        , _tags(_sets * ways, ~0ull)
+        , _lastUse(_sets * ways, 0)
+    {
+    }
+
+    // True on a hit
+    bool Access(uint64_t address)
+    {
+        const uint64_t line = address / _lineBytes;
+        const size_t first = static_cast<size_t>(line % _sets) * _ways;
+        ++_clock;
+
+        size_t victim = first;
+        for (size_t way = first; way < first + _ways; ++way) {
+            if (_tags[way] == line) {
+                _lastUse[way] = _clock;
+                return true;
+            }
+            if (_lastUse[way] < _lastUse[victim]) {
+                victim = way;
+            }
+        }
+        _tags[victim] = line;
+        _lastUse[victim] = _clock;
+        return false;
+    }
+
+    uint32_t LineBytes() const { return _lineBytes; }
+
+private:
+    uint32_t                _lineBytes;
+    uint32_t                _ways;
+    uint64_t                _sets;
+    std::vector<uint64_t>   _tags;
+    std::vector<uint64_t>   _lastUse;
+    uint64_t                _clock = 0;
+};
+
+struct FetchStats
+{
+    uint64_t    vertexFetches = 0;
+    uint64_t    vertexMisses = 0;
+    uint64_t    otherFetches = 0;
+    uint64_t    otherMisses = 0;
+};
+
+// Replays the loads of MeshletMS.hlsl. groupsInFlight meshlets run side by side and their threads
+// issue loads interleaved, thread 0 of every group first, then thread 1 and so on.
+FetchStats Simulate(const MeshletData& data, CacheSimulator& cache, uint32_t groupsInFlight)
+{
+    // Every buffer is its own allocation, far apart from the others
+    const uint64_t verticesBase = 0;
+    const uint64_t meshletsBase = 1ull << 40;
+    const uint64_t uniqueVertexIndicesBase = 2ull << 40;
+    const uint64_t primitiveIndicesBase = 3ull << 40;
+
+    FetchStats stats;
+    auto other = [&](uint64_t address)
+    {
+        ++stats.otherFetches;
+        stats.otherMisses += !cache.Access(address);
+    };
+
+    for (size_t first = 0; first < data.meshlets.size(); first += groupsInFlight) {
+        const size_t last = std::min(data.meshlets.size(), first + groupsInFlight);
+        uint32_t threads = 0;
+        for (size_t m = first; m < last; ++m) {
+            other(meshletsBase + m * sizeof(Meshlet));
+            threads = std::max({ threads, data.meshlets[m].VertCount, data.meshlets[m].PrimCount });
+        }
+        for (uint32_t thread = 0; thread < threads; ++thread) {
+            for (size_t m = first; m < last; ++m) {
+                const Meshlet& meshlet = data.meshlets[m];
+                if (thread < meshlet.VertCount) {
+                    const uint64_t slot = meshlet.VertOffset + thread;
+                    other(uniqueVertexIndicesBase + slot * sizeof(uint32_t));
+                    ++stats.vertexFetches;
+                    stats.vertexMisses += !cache.Access(verticesBase + uint64_t(data.uniqueVertexIndices[slot]) * sizeof(Vertex));
+                }
+                if (thread < meshlet.PrimCount) {
+                    other(primitiveIndicesBase + uint64_t(meshlet.PrimOffset + thread) * sizeof(uint32_t));
+                }
+            }
+        }
+    }
+    return stats;
+}
+
+// Random triangle order and vertex numbering, like meshes that went through a few tools
+void Shuffle(ObjMesh& mesh)
+{
+    std::mt19937 random(1234);
+
+    std::vector<uint32_t> order(mesh.vertices.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), random);
+    std::vector<uint32_t> remap(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        remap[order[i]] = static_cast<uint32_t>(i);
+    }
+    MeshletReorder::PermuteVertices(mesh.vertices, order);
+
+    std::vector<uint32_t> triangles(mesh.indices.size() / 3);
+    std::iota(triangles.begin(), triangles.end(), 0u);
+    std::shuffle(triangles.begin(), triangles.end(), random);
+    std::vector<uint32_t> indices(mesh.indices.size());
+    for (size_t t = 0; t < triangles.size(); ++t) {
+        for (int corner = 0; corner < 3; ++corner) {
+            indices[t * 3 + corner] = remap[mesh.indices[triangles[t] * 3 + corner]];
+        }
+    }
+    mesh.indices = std::move(indices);
+}
+
+} // namespace
+
+int LocalityBenchCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint64_t cacheBytes = args.GetUInt("cache-kb", 512) * 1024;
+    const uint32_t lineBytes = static_cast<uint32_t>(args.GetUInt("line", 128));
+    const uint32_t ways = static_cast<uint32_t>(args.GetUInt("ways", 16));
+    const uint32_t groupsInFlight = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("groups", 16)));
+
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    params.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", params.maxVertices));
+    params.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", params.maxPrimitives));
+
+    ObjMesh source = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    if (args.Has("shuffle")) {
+        Shuffle(source);
+    }
+    const MeshletData built = BuildMeshlets(source, params);
+    std::cout << source.indices.size() / 3 << " triangles, " << built.meshlets.size() << " meshlets, "
+              << cacheBytes / 1024 << " KiB " << ways << "-way cache, " << lineBytes << " B lines, " << groupsInFlight << " groups in flight\n\n";
+
+    std::cout << std::left << std::setw(30) << "order" << std::right << std::setw(14) << "vertex miss" << std::setw(14) << "other miss"
+              << std::setw(12) << "DRAM MB" << std::setw(12) << "B/tri" << "\n";
+
+    auto run = [&](const char* name, MeshletOrdering ordering, bool remapVertices)
+    {
+        ObjMesh mesh = source;
+        MeshletData data = built;
+        if (remapVertices) {
+            MeshletReorder::Apply(mesh, data, ordering);
+        } else {
+            MeshletReorder::SortMeshlets(data, &mesh.vertices[0].position, mesh.vertices.size(), ordering, sizeof(Vertex));
+        }
+        ValidateMeshlets(data, mesh.indices, params.maxVertices, params.maxPrimitives);
+
+        CacheSimulator cache(cacheBytes, lineBytes, ways);
+        const FetchStats stats = Simulate(data, cache, groupsInFlight);
+        const double bytes = double(stats.vertexMisses + stats.otherMisses) * lineBytes;
+        std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(13) << 100.0 * stats.vertexMisses / stats.vertexFetches << '%'
+                  << std::setw(13) << 100.0 * stats.otherMisses / stats.otherFetches << '%'
+                  << std::setw(12) << bytes / (1024.0 * 1024.0)
+                  << std::setw(12) << bytes / (mesh.indices.size() / 3) << "\n";
+    };
+
+    run("builder", MeshletOrdering::Builder, false);
+    run("morton meshlets", MeshletOrdering::Morton, false);
+    run("hilbert meshlets", MeshletOrdering::Hilbert, false);
+    run("builder + first-use vertices", MeshletOrdering::Builder, true);
+    run("morton + first-use vertices", MeshletOrdering::Morton, true);
+    run("hilbert + first-use vertices", MeshletOrdering::Hilbert, true);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "Commands.h"
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+namespace {
+
+struct Command
+{
+    const char* name;
+    const char* usage;
+    int (*run)(const std::vector<std::string>& args);
+};
+
+const Command Commands[] = {
+    { "batch-cull-bench", "[file.obj] [--synthetic-triangles N] [--meshlets N] [--views N] [--threads N] [--runs N]\n"
+                          "      CPU frustum and cone culling of the scalar, SSE4.1, AVX2 and NEON kernels in meshlets per ns, checks they match MeshletCulling", BatchCullBenchCommand },
+    { "bindless-check", "[--capacity N] [--frames N] [--max-lag N] [--max-churn N] [--seed N]\n"
+                        "      random BindlessAllocator churn against a lagging simulated GPU, checks no index is reused before its fence and reports allocate/free rate", BindlessCheckCommand },
+    { "build-bench", "[file.obj] [--synthetic-triangles N] [--threads N] [--runs N] [--max-vertices N] [--max-primitives N]\n"
+                     "      meshlet builder scaling from 1 to N threads, checks the output is thread count independent", BuildBenchCommand },
+    { "cone-orbit", "[file.obj] [--synthetic-triangles N] [--builder greedy|parallel|clustered] [--cone-weight W] [--steps N] [--tilt D] [--distance R]\n"
+                    "      meshlets and triangles rejected by the float and 8-bit normal cone tests over a 360 degree camera orbit", ConeOrbitCommand },
+    { "cull-bench", "[file.obj] [--synthetic-triangles N] [--views N] [--max-vertices N] [--max-primitives N]\n"
+                    "      cone culling rate and bounds of the greedy, parallel and clustered builders", CullBenchCommand },
+    { "cull-check", "[file.obj] [--synthetic-triangles N] [--builder greedy|parallel|clustered] [--max-vertices N] [--max-primitives N]\n"
+                    "      frustum culling reference over fixed cameras, checks it never culls a visible meshlet and matches the amplification shader loop", CullCheckCommand },
+    { "frame-pacing", "[--frames N] [--jitter J] [--max-frames-in-flight N]\n"
+                      "      FrameScheduler on a simulated GPU queue: frame time, CPU wait and GPU idle per frames in flight, checks for slot reuse hazards", FramePacingCommand },
+    { "indirect-check", "[file.obj] [--synthetic-triangles N] [--builder greedy|parallel|clustered] [--meshlets-per-draw N] [--copies N] [--views N] [--seed N]\n"
+                        "      ExecuteIndirect draw culling: checks the wave compacted commands against the reference and that no visible meshlet is in a culled draw", IndirectCheckCommand },
+    { "layout-check", "[file.obj] [--synthetic-triangles N] [--builder greedy|parallel|clustered] [--max-vertices N] [--max-primitives N]\n"
+                      "      memory of the indexed vs flat vertex layout, checks both give the same mesh shader output", LayoutCheckCommand },
+    { "locality-bench", "[file.obj] [--synthetic-triangles N] [--builder greedy|parallel|clustered] [--shuffle] [--cache-kb N] [--line N] [--ways N] [--groups N]\n"
+                        "      cache simulation of mesh shader fetches before and after space filling curve reordering", LocalityBenchCommand },
+    { "obj-bench", "[file.obj ...] [--synthetic-triangles N] [--threads N] [--runs N]\n"
+                   "      OBJ parsing throughput of the stream reader vs ObjLoader", ObjBenchCommand },
+    { "primitive-check", "[file.obj] [--synthetic-triangles N] [--builder greedy|parallel|clustered] [--max-vertices N] [--max-primitives N]\n"
+                         "      byte packed primitive indices round trip through the reference decoder, reports the size change", PrimitiveCheckCommand },
+    { "primitive-cull", "[file.obj] [--synthetic-triangles N] [--builder greedy|parallel|clustered] [--frames N] [--width N] [--height N]\n"
+                        "      mesh shader per-primitive culling rates over scripted camera paths, checks no rejected triangle covers a pixel", PrimitiveCullCommand },
+    { "quantize-check", "[file.obj] [--synthetic-triangles N] [--builder greedy|parallel|clustered] [--max-position-error E] [--max-normal-degrees D] [--max-texcoord-error E]\n"
+                        "      quantized vertex size and maximum position, normal and texcoord errors of both vertex layouts", QuantizeCheckCommand },
+    { "soa-bench", "[file.obj] [--synthetic-triangles N] [--threads N] [--runs N]\n"
+                   "      bounds and meshlet build passes over interleaved (AoS) vs position-only (SoA) vertices", SoaBenchCommand },
+    { "startup", "[file.obj] [--pack file] [--synthetic-triangles N] [--max-vertices N] [--max-primitives N] [--runs N]\n"
+                 "      cold (cook) vs warm (mapped meshlet pack) startup time", StartupCommand },
+    { "occlusion-check", "[file.obj] [--synthetic-triangles N] [--builder greedy|parallel|clustered] [--frames N] [--width N] [--height N]\n"
+                         "      two pass hierarchical Z occlusion culling on a software depth buffer, checks it draws everything visible", OcclusionCheckCommand },
+    { "occupancy", "[file.obj] [--synthetic-triangles N]\n"
+                   "      mesh shader lane usage of every meshlet configuration", OccupancyCommand },
+    { "stats", "[file.obj] [--synthetic-triangles N] [--builder greedy|parallel|clustered] [--cone-weight W] [--max-vertices N] [--max-primitives N] [--views N] [--output file.json]\n"
+               "      meshlet quality report (fill, duplication, bounds, normal cones, cone culling rate) as JSON", StatsCommand },
+    { "record-bench", "[--frames N] [--draws N] [--jobs N] [--threads N] [--frames-in-flight N] [--seed N]\n"
+                      "      RecordingScheduler on a work stealing pool against a mock command list backend, checks the allocator and submission rules", RecordBenchCommand },
+    { "heap-alloc-bench", "[--meshes N] [--churn N] [--block-mb N] [--seed N]\n"
+                          "      TLSF HeapAllocator fragmentation and throughput under mesh streaming, against committed resources", HeapAllocBenchCommand },
+    { "upload-arena", "[file.obj] [--synthetic-triangles N] [--builder greedy|parallel|clustered] [--runs N] [--random-uploads N] [--seed N]\n"
+                      "      stages the startup streams through one UploadArena, checks the replayed copies and compares against one upload buffer per stream", UploadArenaCheckCommand },
+    { "upload-queue-stress", "[--uploads N] [--threads N] [--max-size-kb N] [--batch-kb N] [--budget-kb N] [--seed N]\n"
+                             "      UploadQueue fed from several threads against a simulated copy queue, checks the direct queue never reads an upload before its copy", UploadQueueStressCommand },
+    { "upload-ring-stress", "[--frames N] [--capacity-kb N] [--max-lag N] [--max-allocations N] [--seed N]\n"
+                            "      random per-frame UploadRing allocations against a lagging simulated GPU, checks no frame's data is overwritten early", UploadRingStressCommand },
+    { "ooc-build", "[--triangles N] [--budget-mb N] [--output file] [--temp dir] [--ordered] [--keep]\n"
+                   "      out-of-core meshlet build of a generated grid, reports peak memory and throughput", OutOfCoreCommand },
+};
+
+void PrintUsage()
+{
+    std::cerr << "Usage: MeshletTool <command> [arguments]\n\nCommands:\n";
+    for (const auto& command : Commands) {
+        std::cerr << "  " << command.name << ' ' << command.usage << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        PrintUsage();
+        return 1;
+    }
+
+    for (const auto& command : Commands) {
+        if (std::strcmp(argv[1], command.name) == 0) {
+            try {
+                return command.run(std::vector<std::string>(argv + 2, argv + argc));
+            } catch (const std::exception& e) {
+                std::cerr << command.name << ": " << e.what() << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    std::cerr << "Unknown command: " << argv[1] << "\n\n";
+    PrintUsage();
+    return 1;
+}
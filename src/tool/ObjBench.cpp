@@ -0,0 +1,183 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "ObjLoader.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <iostream>
+#include <unordered_map>
+
+#ifdef USE_WAVEFRONT_READER
+#include <WaveFrontReader.h>
+#endif
+
+namespace {
+
+// Single-threaded istream parser following WaveFrontReader's approach. It's the reference point
+// on platforms where DirectXMesh's reader isn't available.
+ObjMesh LoadWithStreamReader(const std::filesystem::path& path)
+{
+#ifdef USE_WAVEFRONT_READER
+    WaveFrontReader<uint32_t> reader;
+    if (FAILED(reader.Load(path.c_str(), true))) {
+        throw std::runtime_error("WaveFrontReader failed on " + path.string());
+    }
+    ObjMesh mesh;
+    mesh.vertices.resize(reader.vertices.size());
+    std::memcpy(mesh.vertices.data(), reader.vertices.data(), reader.vertices.size() * sizeof(Vertex));
+    mesh.indices = std::move(reader.indices);
+    return mesh;
+#else
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+
+    std::vector<Float3> positions;
+    std::vector<Float2> texCoords;
+    std::vector<Float3> normals;
+    std::unordered_multimap<uint32_t, uint32_t> vertexCache;
+    ObjMesh mesh;
+
+    auto resolve = [](long index, size_t count) -> size_t
+    {
+        const long resolved = index < 0 ? long(count) + index : index - 1;
+        if (index == 0 || resolved < 0 || size_t(resolved) >= count) {
+            throw std::runtime_error("Face index out of range");
+        }
+        return size_t(resolved);
+    };
+
+    std::string command;
+    while (file >> command) {
+        if (command == "v") {
+            Float3 p;
+            file >> p.x >> p.y >> p.z;
+            positions.push_back(p);
+        } else if (command == "vt") {
+            Float2 t;
+            file >> t.x >> t.y;
+            texCoords.push_back(Float2{ t.x, 1.f - t.y });
+        } else if (command == "vn") {
+            Float3 n;
+            file >> n.x >> n.y >> n.z;
+            normals.push_back(n);
+        } else if (command == "f") {
+            std::vector<uint32_t> face;
+            for (;;) {
+                long position = 0;
+                file >> position;
+                Vertex vertex = {};
+                const size_t positionIndex = resolve(position, positions.size());
+                vertex.position = positions[positionIndex];
+                if (file.peek() == '/') {
+                    file.ignore();
+                    if (file.peek() != '/') {
+                        long texCoord = 0;
+                        file >> texCoord;
+                        vertex.textureCoordinate = texCoords[resolve(texCoord, texCoords.size())];
+                    }
+                    if (file.peek() == '/') {
+                        file.ignore();
+                        long normal = 0;
+                        file >> normal;
+                        vertex.normal = normals[resolve(normal, normals.size())];
+                    }
+                }
+
+                uint32_t index = uint32_t(mesh.vertices.size());
+                bool found = false;
+                auto range = vertexCache.equal_range(uint32_t(positionIndex));
+                for (auto it = range.first; it != range.second; ++it) {
+                    if (std::memcmp(&mesh.vertices[it->second], &vertex, sizeof(Vertex)) == 0) {
+                        index = it->second;
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found) {
+                    mesh.vertices.push_back(vertex);
+                    vertexCache.emplace(uint32_t(positionIndex), index);
+                }
+                face.push_back(index);
+
+                while (file.peek() == ' ' || file.peek() == '\t' || file.peek() == '\r') {
+                    file.ignore();
+                }
+                if (file.peek() == '\n' || !file) {
+                    break;
+                }
+            }
+            for (size_t i = 2; i < face.size(); ++i) {
+                mesh.indices.insert(mesh.indices.end(), { face[0], face[i - 1], face[i] });
+            }
+        } else {
+            file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+    }
+    return mesh;
+#endif
+}
+
+template<class LoadFunc>
+void Measure(const char* name, const std::filesystem::path& path, uint64_t runs, LoadFunc&& load)
+{
+    const double megabytes = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+    double best = 1e30;
+    ObjMesh mesh;
+    for (uint64_t run = 0; run < runs; ++run) {
+        Stopwatch timer;
+        mesh = load();
+        best = std::min(best, timer.Seconds());
+    }
+    std::cout << "  " << std::left << std::setw(22) << name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(9) << best << " s "
+              << std::setprecision(1) << std::setw(9) << megabytes / best << " MB/s   "
+              << mesh.vertices.size() << " vertices, " << mesh.indices.size() / 3 << " triangles\n";
+}
+
+} // namespace
+
+int ObjBenchCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint64_t runs = std::max<uint64_t>(1, args.GetUInt("runs", 3));
+    const unsigned maxThreads = static_cast<unsigned>(args.GetUInt("threads", DefaultThreadCount()));
+
+    std::vector<std::filesystem::path> files(args.Positional().begin(), args.Positional().end());
+    std::filesystem::path syntheticPath;
+    if (files.empty() || args.Has("synthetic-triangles")) {
+        const uint64_t triangles = args.GetUInt("synthetic-triangles", 2'000'000);
+        syntheticPath = std::filesystem::temp_directory_path() / "meshlettool_synthetic.obj";
+        std::cout << "Writing synthetic OBJ with ~" << triangles << " triangles to " << syntheticPath.string() << "\n";
+        WriteObj(syntheticPath, GenerateGridMesh(triangles));
+        files.push_back(syntheticPath);
+    }
+
+    for (const auto& path : files) {
+        std::cout << path.string() << " (" << std::filesystem::file_size(path) / (1024 * 1024) << " MB)\n";
+#ifdef USE_WAVEFRONT_READER
+        Measure("WaveFrontReader", path, runs, [&] { return LoadWithStreamReader(path); });
+#else
+        Measure("stream reader", path, runs, [&] { return LoadWithStreamReader(path); });
+#endif
+        for (unsigned threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+            const std::string name = "ObjLoader " + std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+            Measure(name.c_str(), path, runs, [&] { return ObjLoader::Load(path, true, threads); });
+            if (threads >= maxThreads) {
+                break;
+            }
+        }
+    }
+
+    if (!syntheticPath.empty()) {
+        std::filesystem::remove(syntheticPath);
+    }
+    return 0;
+}
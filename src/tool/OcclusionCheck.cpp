@@ -0,0 +1,289 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "DepthPyramid.h"
+#include "MeshletBounds.h"
+#include "MeshletCulling.h"
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// Depth only software rasterizer standing in for the GPU. Back faces are skipped with the same rule
+// the cone test relies on, triangles reaching in front of the near plane are dropped instead of clipped.
+class DepthRasterizer
+{
+public:
+    DepthRasterizer(uint32_t width, uint32_t height)
+        : _width(width), _height(height), _depth(size_t(width) * height), _owner(size_t(width) * height)
+    {
+    }
+
+    void Clear()
+    {
+        std::fill(_depth.begin(), _depth.end(), 1.f);
+        std::fill(_owner.begin(), _owner.end(), UINT32_MAX);
+    }
+
+    // Clip space of every vertex for this frame
+    void Transform(const ObjMesh& mesh, const Matrix& viewProjection, const Float3& camera, float zNear)
+    {
+        _camera = camera;
+        _zNear = zNear;
+        _clip.resize(mesh.vertices.size());
+        for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+            const Float3& p = mesh.vertices[i].position;
+            for (int c = 0; c < 4; ++c) {
+                _clip[i][c] = p.x * viewProjection[0][c] + p.y * viewProjection[1][c] + p.z * viewProjection[2][c] + viewProjection[3][c];
+            }
+        }
+    }
+
+    void Draw(const ObjMesh& mesh, const MeshletData& data, uint32_t meshletIndex)
+    {
+        const Meshlet& meshlet = data.meshlets[meshletIndex];
+        for (uint32_t p = 0; p < meshlet.PrimCount; ++p) {
+            uint32_t local[3];
+            UnpackTriangle(data.primitiveIndices[meshlet.PrimOffset + p], local[0], local[1], local[2]);
+            uint32_t vertex[3];
+            for (int i = 0; i < 3; ++i) {
+                vertex[i] = data.uniqueVertexIndices[meshlet.VertOffset + local[i]];
+            }
+
+            const Float3& a = mesh.vertices[vertex[0]].position;
+            const Float3 normal = Cross(mesh.vertices[vertex[1]].position - a, mesh.vertices[vertex[2]].position - a);
+            if (Dot(normal, _camera - a) <= 0.f) {
+                continue;
+            }
+            DrawTriangle(_clip[vertex[0]], _clip[vertex[1]], _clip[vertex[2]], meshletIndex);
+        }
+    }
+
+    const std::vector<float>& Depth() const { return _depth; }
+    const std::vector<uint32_t>& Owner() const { return _owner; }
+
+private:
+    using Clip = std::array<float, 4>;
+
+    void DrawTriangle(const Clip& c0, const Clip& c1, const Clip& c2, uint32_t id)
+    {
+        if (c0[3] < _zNear || c1[3] < _zNear || c2[3] < _zNear) {
+            return;
+        }
+        float x[3], y[3], z[3];
+        const Clip* clips[3] = { &c0, &c1, &c2 };
+        for (int i = 0; i < 3; ++i) {
+            const Clip& c = *clips[i];
+            x[i] = (c[0] / c[3] * 0.5f + 0.5f) * _width;
+            y[i] = (c[1] / c[3] * -0.5f + 0.5f) * _height;
+            z[i] = c[2] / c[3];
+        }
+
+        const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (area == 0.f) {
+            return;
+        }
+        const int32_t minX = std::max(0, static_cast<int32_t>(std::floor(std::min({ x[0], x[1], x[2] }))));
+        const int32_t maxX = std::min(int32_t(_width) - 1, static_cast<int32_t>(std::ceil(std::max({ x[0], x[1], x[2] }))));
+        const int32_t minY = std::max(0, static_cast<int32_t>(std::floor(std::min({ y[0], y[1], y[2] }))));
+        const int32_t maxY = std::min(int32_t(_height) - 1, static_cast<int32_t>(std::ceil(std::max({ y[0], y[1], y[2] }))));
+
+        const float inverseArea = 1.f / area;
+        for (int32_t py = minY; py <= maxY; ++py) {
+            for (int32_t px = minX; px <= maxX; ++px) {
+                const float sx = px + 0.5f;
+                const float sy = py + 0.5f;
+                const float w0 = ((x[1] - sx) * (y[2] - sy) - (x[2] - sx) * (y[1] - sy)) * inverseArea;
+                const float w1 = ((x[2] - sx) * (y[0] - sy) - (x[0] - sx) * (y[2] - sy)) * inverseArea;
+                const float w2 = 1.f - w0 - w1;
+                if (w0 < 0.f || w1 < 0.f || w2 < 0.f) {
+                    continue;
+                }
+                const float depth = w0 * z[0] + w1 * z[1] + w2 * z[2];
+                float& stored = _depth[size_t(py) * _width + px];
+                if (depth >= 0.f && depth < stored) {
+                    stored = depth;
+                    _owner[size_t(py) * _width + px] = id;
+                }
+            }
+        }
+    }
+
+    uint32_t                _width;
+    uint32_t                _height;
+    std::vector<float>      _depth;
+    std::vector<uint32_t>   _owner;
+    std::vector<Clip>       _clip;
+    Float3                  _camera = {};
+    float                   _zNear = 0.f;
+};
+
+// Every texel has to be the farthest depth of exactly the pixels DepthPyramid says it covers
+uint64_t CheckPyramid(const DepthPyramid& pyramid, const std::vector<float>& depth)
+{
+    uint64_t wrong = 0;
+    for (uint32_t level = 0; level < pyramid.Levels(); ++level) {
+        std::vector<float> expected(size_t(pyramid.Width(level)) * pyramid.Height(level), 0.f);
+        for (uint32_t y = 0; y < pyramid.DepthHeight(); ++y) {
+            for (uint32_t x = 0; x < pyramid.DepthWidth(); ++x) {
+                const uint32_t tx = std::min(x >> (level + 1), pyramid.Width(level) - 1);
+                const uint32_t ty = std::min(y >> (level + 1), pyramid.Height(level) - 1);
+                float& texel = expected[size_t(ty) * pyramid.Width(level) + tx];
+                texel = std::max(texel, depth[size_t(y) * pyramid.DepthWidth() + x]);
+            }
+        }
+        for (uint32_t y = 0; y < pyramid.Height(level); ++y) {
+            for (uint32_t x = 0; x < pyramid.Width(level); ++x) {
+                wrong += pyramid.Texel(level, x, y) != expected[size_t(y) * pyramid.Width(level) + x];
+            }
+        }
+    }
+    return wrong;
+}
+
+} // namespace
+
+int OcclusionCheckCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint32_t frames = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("frames", 24)));
+    const uint32_t width = static_cast<uint32_t>(args.GetUInt("width", 320));
+    const uint32_t height = static_cast<uint32_t>(args.GetUInt("height", 180));
+
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    params.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", params.maxVertices));
+    params.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", params.maxPrimitives));
+
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 250'000));
+    const MeshletData data = BuildMeshlets(mesh, params);
+    const Float3* positions = &mesh.vertices[0].position;
+    const std::vector<PackedMeshletBounds> bounds = MeshletBoundsBuilder::Pack(MeshletBoundsBuilder::Compute(data, positions, sizeof(Vertex)),
+                                                                               data, positions, sizeof(Vertex));
+    const uint32_t meshletCount = static_cast<uint32_t>(data.meshlets.size());
+
+    Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const Vertex& vertex : mesh.vertices) {
+        lo = Min(lo, vertex.position);
+        hi = Max(hi, vertex.position);
+    }
+    const Float3 center = (lo + hi) * 0.5f;
+    const float radius = Length(hi - lo) * 0.5f;
+
+    std::cout << mesh.indices.size() / 3 << " triangles, " << meshletCount << " meshlets, " << width << "x" << height << ", "
+              << frames << " frames, " << DepthPyramid::LevelCount(width, height) << " pyramid levels\n\n";
+    std::cout << std::right << std::setw(6) << "frame" << std::setw(10) << "in view" << std::setw(8) << "early" << std::setw(8) << "late"
+              << std::setw(10) << "occluded" << std::setw(10) << "visible" << std::setw(12) << "bad pixels" << "\n";
+
+    DepthRasterizer reference(width, height);
+    DepthRasterizer twoPass(width, height);
+    DepthPyramid pyramid;
+    std::vector<uint8_t> visibleLastFrame(meshletCount, 0);
+    std::vector<uint8_t> visibleThisFrame(meshletCount, 0);
+
+    uint64_t totalInView = 0, totalDrawn = 0, totalVisible = 0, badPixels = 0, badTexels = 0;
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        // Low camera circling over the mesh and looking across it, so nearer geometry hides the far side
+        const float angle = 2.f * 3.14159265f * frame / frames;
+        const Float3 direction = { std::cos(angle), 0.f, std::sin(angle) };
+        Float3 eye = center + direction * (0.6f * radius);
+        eye.y = hi.y + 0.05f * radius;
+        Float3 target = center - direction * (0.6f * radius);
+        target.y = lo.y;
+
+        Matrix view, projection, viewProjection;
+        LookAt(eye, target, Float3{ 0.f, 1.f, 0.f }, view);
+        Perspective(60.f * 3.14159265f / 180.f, float(width) / height, 0.01f * radius, 10.f * radius, projection);
+        Multiply(view, projection, viewProjection);
+        const Frustum frustum = Frustum::FromMatrix(viewProjection);
+        const DepthProjection depthProjection = DepthProjection::FromMatrix(projection);
+
+        // Ground truth: everything that passes frustum and cone culling
+        reference.Clear();
+        reference.Transform(mesh, viewProjection, eye, depthProjection.zNear);
+        std::vector<uint8_t> inView(meshletCount);
+        uint32_t inViewCount = 0;
+        for (uint32_t i = 0; i < meshletCount; ++i) {
+            inView[i] = MeshletCulling::Visible(frustum, eye, bounds[i]);
+            inViewCount += inView[i];
+            if (inView[i]) {
+                reference.Draw(mesh, data, i);
+            }
+        }
+
+        // Early pass: what was visible last frame
+        twoPass.Clear();
+        twoPass.Transform(mesh, viewProjection, eye, depthProjection.zNear);
+        uint32_t early = 0;
+        for (uint32_t i = 0; i < meshletCount; ++i) {
+            if (inView[i] && visibleLastFrame[i]) {
+                twoPass.Draw(mesh, data, i);
+                ++early;
+            }
+        }
+
+        // Late pass: everything in view against the pyramid of the early pass, draws what the early pass missed
+        pyramid.Build(twoPass.Depth().data(), width, height);
+        if (frame == 0) {
+            badTexels = CheckPyramid(pyramid, twoPass.Depth());
+        }
+        uint32_t late = 0;
+        uint32_t occluded = 0;
+        for (uint32_t i = 0; i < meshletCount; ++i) {
+            visibleThisFrame[i] = 0;
+            if (!inView[i]) {
+                continue;
+            }
+            const Float3& c = bounds[i].center;
+            const Float3 viewCenter = {
+                c.x * view[0][0] + c.y * view[1][0] + c.z * view[2][0] + view[3][0],
+                c.x * view[0][1] + c.y * view[1][1] + c.z * view[2][1] + view[3][1],
+                c.x * view[0][2] + c.y * view[1][2] + c.z * view[2][2] + view[3][2],
+            };
+            visibleThisFrame[i] = pyramid.SphereVisible(viewCenter, bounds[i].radius, depthProjection);
+            occluded += !visibleThisFrame[i];
+            if (visibleThisFrame[i] && !visibleLastFrame[i]) {
+                twoPass.Draw(mesh, data, i);
+                ++late;
+            }
+        }
+        std::swap(visibleLastFrame, visibleThisFrame);
+
+        // Correct when the two passes end with exactly the depth of drawing everything
+        uint64_t frameBadPixels = 0;
+        for (size_t p = 0; p < reference.Depth().size(); ++p) {
+            frameBadPixels += std::memcmp(&reference.Depth()[p], &twoPass.Depth()[p], sizeof(float)) != 0;
+        }
+        std::vector<uint8_t> owns(meshletCount, 0);
+        for (const uint32_t owner : reference.Owner()) {
+            if (owner != UINT32_MAX) {
+                owns[owner] = 1;
+            }
+        }
+        const uint32_t visible = static_cast<uint32_t>(std::count(owns.begin(), owns.end(), 1));
+
+        std::cout << std::setw(6) << frame << std::setw(10) << inViewCount << std::setw(8) << early << std::setw(8) << late
+                  << std::setw(10) << occluded << std::setw(10) << visible << std::setw(12) << frameBadPixels << "\n";
+        totalInView += inViewCount;
+        totalDrawn += early + late;
+        totalVisible += visible;
+        badPixels += frameBadPixels;
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\ndrawn " << 100.0 * totalDrawn / totalInView << "% of the meshlets in view, "
+              << 100.0 * totalVisible / totalInView << "% own a pixel\n"
+              << "in view = passes frustum and cone culling, early / late = drawn by the pass, occluded = rejected by the pyramid,\n"
+                 "visible = owns a pixel when drawing everything, bad pixels = depth differs from drawing everything\n"
+              << badTexels << " wrong pyramid texels, " << badPixels << " bad pixels\n";
+    return badTexels == 0 && badPixels == 0 ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBuilder.h"
+#include "MeshletConfig.h"
+
+#include <iomanip>
+#include <iostream>
+
+int OccupancyCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    std::cout << mesh.indices.size() / 3 << " triangles, " << mesh.vertices.size() << " vertices\n\n";
+
+    std::cout << std::left << std::setw(10) << "config" << std::right
+              << std::setw(7) << "group" << std::setw(10) << "meshlets" << std::setw(10) << "avg vert" << std::setw(10) << "avg prim"
+              << std::setw(12) << "vert lanes" << std::setw(12) << "prim lanes" << std::setw(14) << "wasted lanes" << std::setw(10) << "waves" << "\n";
+
+    ForEachMeshletConfig([&](auto config) {
+        using Config = decltype(config);
+        const MeshletData data = MeshletBuilder::BuildParallel(mesh.indices.data(), mesh.indices.size(), &mesh.vertices[0].position, mesh.vertices.size(),
+                                                               Config::MaxVertices, Config::MaxPrimitives, 0, sizeof(Vertex));
+
+        // Every meshlet is one thread group of GroupSize threads. A lane does useful work in the
+        // vertex part when gtid < VertCount and in the primitive part when gtid < PrimCount.
+        uint64_t vertices = 0;
+        uint64_t primitives = 0;
+        uint64_t busyLanes = 0;
+        uint64_t waves = 0;
+        for (const Meshlet& meshlet : data.meshlets) {
+            vertices += meshlet.VertCount;
+            primitives += meshlet.PrimCount;
+            busyLanes += std::max(meshlet.VertCount, meshlet.PrimCount);
+            waves += (std::max(meshlet.VertCount, meshlet.PrimCount) + Config::WaveSize - 1) / Config::WaveSize;
+        }
+        const double lanes = double(data.meshlets.size()) * Config::GroupSize;
+        const double meshlets = double(data.meshlets.size());
+
+        std::cout << std::left << std::setw(10) << Config::Name() << std::right << std::fixed
+                  << std::setw(7) << Config::GroupSize << std::setw(10) << data.meshlets.size()
+                  << std::setprecision(1) << std::setw(10) << vertices / meshlets << std::setw(10) << primitives / meshlets
+                  << std::setw(11) << 100.0 * vertices / lanes << '%' << std::setw(11) << 100.0 * primitives / lanes << '%'
+                  << std::setw(13) << 100.0 * (lanes - busyLanes) / lanes << '%' << std::setw(10) << waves << "\n";
+    });
+
+    std::cout << "\nMesh shader defines (BuildShaders.bat):\n";
+    ForEachMeshletConfig([&](auto config) {
+        using Config = decltype(config);
+        std::cout << "  MeshletMS_" << Config::Name() << ".cso: " << Config::ShaderDefines() << "\n";
+    });
+    return 0;
+}
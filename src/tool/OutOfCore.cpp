@@ -0,0 +1,116 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletPack.h"
+#include "StreamingMeshletBuilder.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+namespace {
+
+// Same height field as GenerateGridMesh, produced on demand so meshes far larger than
+// memory can be fed to the streaming builder. Triangles are visited in a scrambled order
+// so the builder can't rely on the input being spatially sorted.
+class GridMeshStream : public MeshStream
+{
+public:
+    GridMeshStream(uint64_t triangleCount, bool scramble)
+    {
+        _side = std::max<uint64_t>(2, static_cast<uint64_t>(std::ceil(std::sqrt(triangleCount / 2.0))) + 1);
+        _triangles = (_side - 1) * (_side - 1) * 2;
+        _stride = 1;
+        if (scramble) {
+            _stride = 2654435761ull % _triangles;
+            while (std::gcd(_stride, _triangles) != 1) {
+                ++_stride;
+            }
+        }
+    }
+
+    uint64_t VertexCount() const override { return _side * _side; }
+    uint64_t TriangleCount() const override { return _triangles; }
+
+    void ReadVertices(uint64_t first, size_t count, Vertex* vertices) override
+    {
+        const float step = 1.f / (_side - 1);
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t index = first + i;
+            const float x = (index % _side) * step;
+            const float z = (index / _side) * step;
+            const float dx = 0.05f * 40.f * std::cos(x * 40.f) * std::cos(z * 37.f) + 0.2f * 3.f * std::cos(x * 3.f + z * 2.f);
+            const float dz = -0.05f * 37.f * std::sin(x * 40.f) * std::sin(z * 37.f) + 0.2f * 2.f * std::cos(x * 3.f + z * 2.f);
+            const float length = std::sqrt(dx * dx + 1 + dz * dz);
+
+            vertices[i].position = Float3{ x, 0.05f * std::sin(x * 40.f) * std::cos(z * 37.f) + 0.2f * std::sin(x * 3.f + z * 2.f), z };
+            vertices[i].normal = Float3{ -dx / length, 1 / length, -dz / length };
+            vertices[i].textureCoordinate = Float2{ x, z };
+        }
+    }
+
+    void ReadTriangles(uint64_t first, size_t count, uint32_t* indices) override
+    {
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t triangle = ((first + i) * _stride) % _triangles;
+            const uint64_t quad = triangle / 2;
+            const uint32_t v = static_cast<uint32_t>((quad / (_side - 1)) * _side + quad % (_side - 1));
+            const uint32_t side = static_cast<uint32_t>(_side);
+            uint32_t* out = indices + i * 3;
+            if (triangle % 2 == 0) {
+                out[0] = v; out[1] = v + side; out[2] = v + 1;
+            } else {
+                out[0] = v + 1; out[1] = v + side; out[2] = v + side + 1;
+            }
+        }
+    }
+
+private:
+    uint64_t _side;
+    uint64_t _triangles;
+    uint64_t _stride;
+};
+
+} // namespace
+
+int OutOfCoreCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+
+    StreamingBuildOptions options;
+    options.memoryBudget = args.GetUInt("budget-mb", 1024) * 1024 * 1024;
+    options.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", options.maxVertices));
+    options.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", options.maxPrimitives));
+    options.tempDirectory = args.Get("temp", "");
+
+    const uint64_t requestedTriangles = args.GetUInt("triangles", 100'000'000);
+    const bool ordered = args.Has("ordered");
+    GridMeshStream source(requestedTriangles, !ordered);
+    // The triangle order changes the meshlets, so it is part of what the pack was built from
+    const uint64_t keyFields[] = { requestedTriangles, ordered };
+    const uint64_t key = MeshletPack::HashBytes(keyFields, sizeof(keyFields));
+    const std::filesystem::path output = args.Get("output", (std::filesystem::temp_directory_path() / "meshlettool_ooc.meshletpack").string());
+
+    std::cout << "Generated grid: " << source.TriangleCount() << " triangles, " << source.VertexCount() << " vertices, "
+              << options.memoryBudget / (1024 * 1024) << " MB budget\n";
+
+    const StreamingBuildStats stats = StreamingMeshletBuilder::Build(source, output, key, options);
+
+    const double mb = 1024.0 * 1024.0;
+    std::cout << std::fixed << std::setprecision(2)
+              << "bins:            " << stats.bins << "\n"
+              << "meshlets:        " << stats.meshlets << " (" << double(stats.triangles) / stats.meshlets << " triangles avg)\n"
+              << "time:            " << stats.seconds << " s\n"
+              << "throughput:      " << stats.triangles / stats.seconds / 1e6 << " Mtri/s\n"
+              << "builder peak:    " << stats.plannedPeakBytes / mb << " MB\n"
+              << "process peak:    " << PeakResidentBytes() / mb << " MB\n"
+              << "spilled:         " << stats.spillBytes / mb << " MB\n"
+              << "output:          " << stats.outputBytes / mb << " MB (" << output.string() << ")\n";
+
+    if (!args.Has("keep")) {
+        std::filesystem::remove(output);
+    }
+    return 0;
+}
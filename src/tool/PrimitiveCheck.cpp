@@ -0,0 +1,70 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBuilder.h"
+#include "PrimitiveEncoding.h"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+
+// Decodes every triangle of the Bytes stream and compares it with the PackTriangle source
+bool RoundTrips(const std::vector<uint32_t>& packed)
+{
+    const std::vector<uint32_t> words = PrimitiveEncoding::EncodeBytes(packed.data(), packed.size());
+    if (words.size() * sizeof(uint32_t) != PrimitiveEncoding::EncodedBytes(packed.size(), MeshletPrimitiveFormat::Bytes)) {
+        return false;
+    }
+    for (size_t t = 0; t < packed.size(); ++t) {
+        uint32_t expected[3];
+        uint32_t decoded[3];
+        UnpackTriangle(packed[t], expected[0], expected[1], expected[2]);
+        PrimitiveEncoding::DecodeBytes(words.data(), static_cast<uint32_t>(t), decoded[0], decoded[1], decoded[2]);
+        if (expected[0] != decoded[0] || expected[1] != decoded[1] || expected[2] != decoded[2]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int PrimitiveCheckCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    params.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", params.maxVertices));
+    params.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", params.maxPrimitives));
+
+    // Every start alignment and stream length up to a few words, indices up to 255
+    std::mt19937 random(42);
+    std::uniform_int_distribution<uint32_t> index(0, 255);
+    bool passed = true;
+    for (size_t count = 1; count <= 64 && passed; ++count) {
+        std::vector<uint32_t> packed(count);
+        for (uint32_t& triangle : packed) {
+            triangle = PackTriangle(index(random), index(random), index(random));
+        }
+        packed.back() = PackTriangle(255, 0, 255);
+        passed = RoundTrips(packed);
+    }
+    std::cout << "Synthetic round trip: " << (passed ? "passed" : "FAILED") << "\n";
+
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    const MeshletData data = BuildMeshlets(mesh, params);
+    ValidateMeshlets(data, mesh.indices, params.maxVertices, params.maxPrimitives);
+    const bool assetPassed = RoundTrips(data.primitiveIndices);
+    std::cout << "Asset round trip:     " << (assetPassed ? "passed" : "FAILED") << "\n\n";
+
+    const uint64_t triangles = data.primitiveIndices.size();
+    const uint64_t packedBytes = PrimitiveEncoding::EncodedBytes(triangles, MeshletPrimitiveFormat::Packed10);
+    const uint64_t byteBytes = PrimitiveEncoding::EncodedBytes(triangles, MeshletPrimitiveFormat::Bytes);
+    std::cout << triangles << " triangles in " << data.meshlets.size() << " meshlets\n" << std::fixed << std::setprecision(2)
+              << "  packed 10-bit: " << std::setw(10) << packedBytes / 1024.0 << " KiB\n"
+              << "  bytes:         " << std::setw(10) << byteBytes / 1024.0 << " KiB (" << 100.0 * (1.0 - double(byteBytes) / packedBytes) << "% smaller)\n";
+    return passed && assetPassed ? 0 : 1;
+}
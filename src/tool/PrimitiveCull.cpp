@@ -0,0 +1,198 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBounds.h"
+#include "MeshletCulling.h"
+#include "PrimitiveCulling.h"
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+struct ReferenceClip
+{
+    double x, y, z, w;
+};
+
+ReferenceClip TransformReference(const Float3& p, const Matrix& m)
+{
+    double c[4];
+    for (int i = 0; i < 4; ++i) {
+        c[i] = double(p.x) * m[0][i] + double(p.y) * m[1][i] + double(p.z) * m[2][i] + m[3][i];
+    }
+    return ReferenceClip{ c[0], c[1], c[2], c[3] };
+}
+
+// True when the front facing triangle covers a pixel center inside the viewport and the depth range,
+// evaluated in double with inclusive edges. Anything touching the camera plane counts as covering.
+bool CoversSample(const ReferenceClip (&c)[3], uint32_t width, uint32_t height)
+{
+    double x[3], y[3], z[3];
+    for (int i = 0; i < 3; ++i) {
+        if (c[i].w <= 0.0) {
+            return true;
+        }
+        x[i] = (c[i].x / c[i].w * 0.5 + 0.5) * width;
+        y[i] = (c[i].y / c[i].w * -0.5 + 0.5) * height;
+        z[i] = c[i].z / c[i].w;
+    }
+
+    const double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area >= 0.0) {
+        return false;
+    }
+    const double minX = std::max(0.0, std::ceil(std::min({ x[0], x[1], x[2] }) - 0.5));
+    const double maxX = std::min(width - 1.0, std::floor(std::max({ x[0], x[1], x[2] }) - 0.5));
+    const double minY = std::max(0.0, std::ceil(std::min({ y[0], y[1], y[2] }) - 0.5));
+    const double maxY = std::min(height - 1.0, std::floor(std::max({ y[0], y[1], y[2] }) - 0.5));
+    for (double py = minY; py <= maxY; ++py) {
+        for (double px = minX; px <= maxX; ++px) {
+            const double sx = px + 0.5;
+            const double sy = py + 0.5;
+            const double w0 = ((x[1] - sx) * (y[2] - sy) - (x[2] - sx) * (y[1] - sy)) / area;
+            const double w1 = ((x[2] - sx) * (y[0] - sy) - (x[0] - sx) * (y[2] - sy)) / area;
+            const double w2 = 1.0 - w0 - w1;
+            if (w0 < 0.0 || w1 < 0.0 || w2 < 0.0) {
+                continue;
+            }
+            const double depth = w0 * z[0] + w1 * z[1] + w2 * z[2];
+            if (depth >= 0.0 && depth <= 1.0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+struct PathTotals
+{
+    uint64_t meshlets = 0;
+    uint64_t triangles = 0;
+    uint64_t rejected[size_t(PrimitiveCullResult::Count)] = {};
+    uint64_t wrong = 0;
+};
+
+} // namespace
+
+int PrimitiveCullCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint32_t frames = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("frames", 12)));
+    const uint32_t width = static_cast<uint32_t>(args.GetUInt("width", 1200));
+    const uint32_t height = static_cast<uint32_t>(args.GetUInt("height", 900));
+
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    params.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", params.maxVertices));
+    params.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", params.maxPrimitives));
+
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    const MeshletData data = BuildMeshlets(mesh, params);
+    const Float3* positions = &mesh.vertices[0].position;
+    const std::vector<PackedMeshletBounds> bounds = MeshletBoundsBuilder::Pack(MeshletBoundsBuilder::Compute(data, positions, sizeof(Vertex)),
+                                                                               data, positions, sizeof(Vertex));
+
+    Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const Vertex& vertex : mesh.vertices) {
+        lo = Min(lo, vertex.position);
+        hi = Max(hi, vertex.position);
+    }
+    const Float3 center = (lo + hi) * 0.5f;
+    const float radius = Length(hi - lo) * 0.5f;
+
+    std::cout << mesh.indices.size() / 3 << " triangles, " << data.meshlets.size() << " meshlets, " << width << "x" << height << ", "
+              << frames << " frames per path\n\n";
+    std::cout << std::right << std::setw(10) << "path" << std::setw(12) << "triangles" << std::setw(10) << "frustum" << std::setw(10) << "backface"
+              << std::setw(10) << "degen" << std::setw(10) << "small" << std::setw(10) << "rejected" << std::setw(8) << "wrong" << "\n";
+
+    // Scripted cameras: an orbit, a low pass across the surface and an orbit far enough out that most triangles are sub-pixel
+    enum class Path { Orbit, Flyover, Distant };
+    const std::pair<Path, const char*> paths[] = { { Path::Orbit, "orbit" }, { Path::Flyover, "flyover" }, { Path::Distant, "distant" } };
+
+    std::vector<Float4> clip(mesh.vertices.size());
+    uint64_t wrong = 0;
+    for (const auto& [path, name] : paths) {
+        PathTotals totals;
+        for (uint32_t frame = 0; frame < frames; ++frame) {
+            const float angle = 2.f * 3.14159265f * frame / frames;
+            const Float3 direction = { std::cos(angle), 0.f, std::sin(angle) };
+            Float3 eye, target = center;
+            switch (path) {
+            case Path::Orbit:
+                eye = center + direction * (2.f * radius);
+                eye.y += radius;
+                break;
+            case Path::Flyover:
+                eye = center + direction * (0.6f * radius);
+                eye.y = hi.y + 0.05f * radius;
+                target = center - direction * (0.6f * radius);
+                target.y = lo.y;
+                break;
+            case Path::Distant:
+                eye = center + direction * (40.f * radius);
+                eye.y += 20.f * radius;
+                break;
+            }
+
+            Matrix view, projection, viewProjection;
+            LookAt(eye, target, Float3{ 0.f, 1.f, 0.f }, view);
+            Perspective(60.f * 3.14159265f / 180.f, float(width) / height, 0.01f * radius, 100.f * radius, projection);
+            Multiply(view, projection, viewProjection);
+            const Frustum frustum = Frustum::FromMatrix(viewProjection);
+
+            for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+                const Float3& p = mesh.vertices[i].position;
+                float c[4];
+                for (int j = 0; j < 4; ++j) {
+                    c[j] = p.x * viewProjection[0][j] + p.y * viewProjection[1][j] + p.z * viewProjection[2][j] + viewProjection[3][j];
+                }
+                clip[i] = Float4{ c[0], c[1], c[2], c[3] };
+            }
+
+            // Only the meshlets the amplification shader lets through reach the mesh shader
+            for (const uint32_t m : MeshletCulling::Cull(frustum, eye, bounds.data(), static_cast<uint32_t>(bounds.size()))) {
+                const Meshlet& meshlet = data.meshlets[m];
+                ++totals.meshlets;
+                totals.triangles += meshlet.PrimCount;
+                for (uint32_t p = 0; p < meshlet.PrimCount; ++p) {
+                    uint32_t local[3];
+                    UnpackTriangle(data.primitiveIndices[meshlet.PrimOffset + p], local[0], local[1], local[2]);
+                    uint32_t vertex[3];
+                    for (int i = 0; i < 3; ++i) {
+                        vertex[i] = data.uniqueVertexIndices[meshlet.VertOffset + local[i]];
+                    }
+
+                    const PrimitiveCullResult result = PrimitiveCulling::Classify(clip[vertex[0]], clip[vertex[1]], clip[vertex[2]], float(width), float(height));
+                    ++totals.rejected[size_t(result)];
+                    if (result != PrimitiveCullResult::Visible) {
+                        const ReferenceClip reference[3] = {
+                            TransformReference(mesh.vertices[vertex[0]].position, viewProjection),
+                            TransformReference(mesh.vertices[vertex[1]].position, viewProjection),
+                            TransformReference(mesh.vertices[vertex[2]].position, viewProjection),
+                        };
+                        totals.wrong += CoversSample(reference, width, height);
+                    }
+                }
+            }
+        }
+
+        const double triangles = double(std::max<uint64_t>(1, totals.triangles));
+        auto percent = [&](PrimitiveCullResult result) { return 100.0 * totals.rejected[size_t(result)] / triangles; };
+        std::cout << std::fixed << std::setprecision(1) << std::setw(10) << name << std::setw(12) << totals.triangles / frames
+                  << std::setw(9) << percent(PrimitiveCullResult::Frustum) << "%" << std::setw(9) << percent(PrimitiveCullResult::Backface) << "%"
+                  << std::setw(9) << percent(PrimitiveCullResult::Degenerate) << "%" << std::setw(9) << percent(PrimitiveCullResult::SmallPrimitive) << "%"
+                  << std::setw(9) << 100.0 - percent(PrimitiveCullResult::Visible) << "%" << std::setw(8) << totals.wrong << "\n";
+        wrong += totals.wrong;
+    }
+
+    std::cout << "\ntriangles = per frame in meshlets that pass frustum and cone culling, the rest = share of them each test rejects first\n"
+              << wrong << " rejected triangles cover a pixel center\n";
+    return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBuilder.h"
+#include "MeshletLayout.h"
+#include "MeshletReorder.h"
+#include "VertexQuantization.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// Every finite half survives half -> float -> half
+bool HalfRoundTrips()
+{
+    for (uint32_t bits = 0; bits <= 0xFFFF; ++bits) {
+        const uint16_t half = static_cast<uint16_t>(bits);
+        if ((half & 0x7C00) == 0x7C00) {
+            continue;
+        }
+        if (VertexQuantization::FloatToHalf(VertexQuantization::HalfToFloat(half)) != half) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int QuantizeCheckCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    params.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", params.maxVertices));
+    params.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", params.maxPrimitives));
+
+    VertexQuantizationOptions options;
+    options.maxPositionError = static_cast<float>(args.GetFloat("max-position-error", options.maxPositionError));
+    options.maxNormalDegrees = static_cast<float>(args.GetFloat("max-normal-degrees", options.maxNormalDegrees));
+    options.maxTexCoordError = static_cast<float>(args.GetFloat("max-texcoord-error", options.maxTexCoordError));
+
+    const bool halfPassed = HalfRoundTrips();
+    std::cout << "Half round trip: " << (halfPassed ? "passed" : "FAILED") << "\n";
+
+    ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    MeshletData data = BuildMeshlets(mesh, params);
+    MeshletReorder::Apply(mesh, data, MeshletOrdering::Hilbert);
+    std::cout << mesh.indices.size() / 3 << " triangles, " << mesh.vertices.size() << " vertices, " << data.meshlets.size() << " meshlets\n\n";
+
+    std::cout << std::left << std::setw(10) << "layout" << std::right << std::setw(12) << "full MB" << std::setw(12) << "quant MB"
+              << std::setw(14) << "pos error" << std::setw(12) << "relative" << std::setw(12) << "normal" << std::setw(12) << "texcoord" << "\n";
+
+    auto run = [&](const char* name, MeshletVertexLayout layout)
+    {
+        std::vector<Vertex> vertices = mesh.vertices;
+        MeshletData layoutData = data;
+        if (layout == MeshletVertexLayout::Flat) {
+            MeshletLayout::Flatten(vertices, layoutData);
+        }
+        const QuantizedMesh quantized = VertexQuantization::Encode(vertices, layoutData, layout, options);
+
+        const double fullBytes = double(vertices.size()) * sizeof(Vertex);
+        const double quantizedBytes = double(quantized.vertices.size()) * sizeof(QuantizedVertex) + double(quantized.bounds.size()) * sizeof(PositionBounds);
+        const QuantizationError& error = quantized.error;
+        std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << fullBytes / (1024.0 * 1024.0) << std::setw(12) << quantizedBytes / (1024.0 * 1024.0)
+                  << std::scientific << std::setprecision(3) << std::setw(14) << error.position << std::setw(12) << error.positionRelative
+                  << std::fixed << std::setw(11) << error.normalDegrees << "d" << std::scientific << std::setw(12) << error.texCoord << "\n";
+    };
+    run("indexed", MeshletVertexLayout::Indexed);
+    run("flat", MeshletVertexLayout::Flat);
+
+    std::cout << "\nrelative = position error / bounding box diagonal, indexed uses mesh bounds, flat per meshlet bounds\n";
+    return halfPassed ? 0 : 1;
+}
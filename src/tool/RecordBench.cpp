@@ -0,0 +1,270 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "FrameScheduler.h"
+#include "Parallel.h"
+#include "RecordingScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+
+namespace {
+
+// GPU that finishes every submission lag submissions after it was made, or when waited for
+class LaggingQueue : public FrameQueue
+{
+public:
+    explicit LaggingQueue(uint64_t lag) : _lag(lag) {}
+
+    uint64_t Signal() override
+    {
+        ++_signaled;
+        _completed = std::max(_completed, _signaled > _lag ? _signaled - _lag : 0);
+        return _signaled;
+    }
+
+    uint64_t CompletedValue() override { return _completed; }
+    void WaitFor(uint64_t value) override { _completed = std::max(_completed, value); }
+
+    uint64_t Signaled() const { return _signaled; }
+
+private:
+    uint64_t    _lag;
+    uint64_t    _signaled = 0;
+    uint64_t    _completed = 0;
+};
+
+// Command lists as vectors of encoded draws. Checks the D3D12 rules the scheduler has to keep: a
+// command allocator is only used by one thread and only reset once the GPU is done with it, lists
+// are closed before submission, and every list holds exactly its job's commands.
+class MockBackend : public CommandListBackend
+{
+public:
+    MockBackend(LaggingQueue& queue, uint32_t framesInFlight, uint32_t workers)
+        : _queue(queue), _workers(workers), _allocators(size_t(framesInFlight) * workers), _lists(framesInFlight)
+    {
+    }
+
+    void PrepareLists(uint32_t frameSlot, uint32_t listCount) override
+    {
+        if (_lists[frameSlot].size() < listCount) {
+            _lists[frameSlot].resize(listCount);
+        }
+    }
+
+    void ResetAllocator(uint32_t frameSlot, uint32_t worker) override
+    {
+        Allocator& allocator = Owned(frameSlot, worker);
+        Count(allocator.open != 0, "allocator reset with a list open");
+        Count(_queue.CompletedValue() < allocator.fence, "allocator reset while the GPU uses it");
+        ++allocator.resets;
+    }
+
+    void OpenList(uint32_t frameSlot, uint32_t worker, uint32_t list) override
+    {
+        Allocator& allocator = Owned(frameSlot, worker);
+        List& target = _lists[frameSlot][list];
+        Count(target.open, "list opened twice");
+        target.open = true;
+        target.allocator = &allocator;
+        target.commands.clear();
+        ++allocator.open;
+    }
+
+    void CloseList(uint32_t frameSlot, uint32_t list) override
+    {
+        List& target = _lists[frameSlot][list];
+        Count(!target.open, "closing a list that isn't open");
+        target.open = false;
+        --target.allocator->open;
+    }
+
+    void Submit(uint32_t frameSlot, uint32_t listCount) override
+    {
+        // The fence FrameScheduler::EndFrame is about to signal releases everything submitted here
+        const uint64_t fence = _queue.Signaled() + 1;
+        for (uint32_t list = 0; list < listCount; ++list) {
+            List& submitted = _lists[frameSlot][list];
+            Count(submitted.open, "submitting an open list");
+            Count(submitted.commands != expected[list], "list with the wrong commands");
+            submitted.allocator->fence = fence;
+        }
+        ++_submissions;
+    }
+
+    void Append(uint32_t frameSlot, uint32_t list, uint32_t command) { _lists[frameSlot][list].commands.push_back(command); }
+
+    std::vector<std::vector<uint32_t>> expected;    // commands of every list, set before recording
+
+    uint64_t Violations() const { return _violations; }
+    uint64_t Submissions() const { return _submissions; }
+    uint64_t Resets() const
+    {
+        uint64_t resets = 0;
+        for (const Allocator& allocator : _allocators) {
+            resets += allocator.resets;
+        }
+        return resets;
+    }
+
+private:
+    struct Allocator
+    {
+        std::thread::id     owner;
+        std::atomic<int>    open{ 0 };
+        uint64_t            fence = 0;
+        uint64_t            resets = 0;
+    };
+
+    struct List
+    {
+        bool                    open = false;
+        Allocator*              allocator = nullptr;
+        std::vector<uint32_t>   commands;
+    };
+
+    Allocator& Owned(uint32_t frameSlot, uint32_t worker)
+    {
+        Allocator& allocator = _allocators[size_t(frameSlot) * _workers + worker];
+        std::lock_guard<std::mutex> lock(_lock);
+        if (allocator.owner == std::thread::id()) {
+            allocator.owner = std::this_thread::get_id();
+        }
+        Count(allocator.owner != std::this_thread::get_id(), "allocator used by two threads");
+        return allocator;
+    }
+
+    void Count(bool violated, const char* what)
+    {
+        if (violated) {
+            std::lock_guard<std::mutex> lock(_violationLock);
+            if (_violations++ < 5) {
+                std::cout << "  violation: " << what << "\n";
+            }
+        }
+    }
+
+    LaggingQueue&               _queue;
+    uint32_t                    _workers;
+    std::vector<Allocator>      _allocators;
+    std::vector<std::vector<List>> _lists;
+    std::mutex                  _lock;
+    std::mutex                  _violationLock;
+    uint64_t                    _violations = 0;
+    uint64_t                    _submissions = 0;
+};
+
+struct BenchResult
+{
+    double      msPerFrame;
+    uint64_t    steals;
+    uint64_t    violations;
+};
+
+// What recording a draw costs on the CPU: its world matrix and a few state changes
+uint32_t RecordDraw(uint32_t job, uint32_t draw)
+{
+    Matrix world = {}, view, result;
+    const float angle = 0.001f * draw;
+    world[0][0] = std::cos(angle);
+    world[0][2] = std::sin(angle);
+    world[1][1] = 1.f;
+    world[2][0] = -std::sin(angle);
+    world[2][2] = std::cos(angle);
+    world[3][3] = 1.f;
+    LookAt(Float3{ 0.f, 4.f, 13.f }, Float3{ 0.f, 0.f, 0.f }, Float3{ 0.f, 1.f, 0.f }, view);
+    for (int i = 0; i < 16; ++i) {
+        Multiply(world, view, result);
+        world[3][0] = result[3][0] * 0.5f;
+    }
+    return (job << 16) | (draw & 0xffff);
+}
+
+BenchResult Bench(uint32_t threads, uint32_t frames, uint32_t framesInFlight, const std::vector<uint32_t>& jobDraws)
+{
+    WorkStealingPool pool(threads);
+    LaggingQueue queue(framesInFlight);
+    FrameScheduler frameScheduler(queue, framesInFlight);
+    MockBackend backend(queue, framesInFlight, pool.WorkerCount());
+    RecordingScheduler recording(backend, pool, framesInFlight);
+
+    const uint32_t jobCount = static_cast<uint32_t>(jobDraws.size());
+    backend.expected.resize(jobCount);
+    for (uint32_t job = 0; job < jobCount; ++job) {
+        for (uint32_t draw = 0; draw < jobDraws[job]; ++draw) {
+            backend.expected[job].push_back((job << 16) | (draw & 0xffff));
+        }
+    }
+
+    Stopwatch timer;
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        const uint32_t slot = frameScheduler.BeginFrame();
+        recording.RecordFrame(slot, jobCount, [&](uint32_t job, uint32_t)
+        {
+            for (uint32_t draw = 0; draw < jobDraws[job]; ++draw) {
+                backend.Append(slot, job, RecordDraw(job, draw));
+            }
+        });
+        frameScheduler.EndFrame();
+    }
+    frameScheduler.WaitIdle();
+    const double seconds = timer.Seconds();
+
+    const bool allSubmitted = backend.Submissions() == frames;
+    return BenchResult{ seconds * 1e3 / frames, pool.Steals(), backend.Violations() + !allSubmitted };
+}
+
+} // namespace
+
+// Multi-threaded recording of a frame of many draws split into uneven jobs, against a mock backend
+// that checks the command list and allocator rules, from one thread up to --threads.
+int RecordBenchCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint32_t frames = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("frames", 200)));
+    const uint32_t draws = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("draws", 2000)));
+    const uint32_t jobCount = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("jobs", 32)));
+    const uint32_t framesInFlight = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("frames-in-flight", 2)));
+    const unsigned maxThreads = static_cast<unsigned>(std::max<uint64_t>(1, args.GetUInt("threads", std::max(4u, DefaultThreadCount()))));
+
+    // Meshes differ in draw count, so do the jobs: some are several times the average
+    std::mt19937 random(static_cast<uint32_t>(args.GetUInt("seed", 1)));
+    std::exponential_distribution<double> share(1.0);
+    std::vector<double> weights(jobCount);
+    double total = 0.0;
+    for (double& weight : weights) {
+        weight = share(random);
+        total += weight;
+    }
+    std::vector<uint32_t> jobDraws(jobCount);
+    uint32_t largest = 0;
+    for (uint32_t job = 0; job < jobCount; ++job) {
+        jobDraws[job] = std::max(1u, static_cast<uint32_t>(draws * weights[job] / total));
+        largest = std::max(largest, jobDraws[job]);
+    }
+
+    std::cout << frames << " frames of " << draws << " draws in " << jobCount << " jobs (largest " << largest << " draws), "
+              << framesInFlight << " frames in flight, " << DefaultThreadCount() << " cores\n\n";
+    std::cout << std::right << std::setw(8) << "threads" << std::setw(12) << "ms/frame" << std::setw(10) << "speedup" << std::setw(10) << "steals"
+              << std::setw(12) << "violations" << "\n";
+
+    bool ok = true;
+    double oneThread = 0.0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        const BenchResult result = Bench(threads, frames, framesInFlight, jobDraws);
+        oneThread = threads == 1 ? result.msPerFrame : oneThread;
+        std::cout << std::fixed << std::setw(8) << threads << std::setprecision(3) << std::setw(12) << result.msPerFrame
+                  << std::setprecision(2) << std::setw(9) << oneThread / result.msPerFrame << "x" << std::setw(10) << result.steals
+                  << std::setw(12) << result.violations << "\n";
+        ok = ok && result.violations == 0;
+    }
+
+    std::cout << "\nviolations = allocator used by two threads or reset while the GPU uses it, lists submitted open or with\n"
+                 "another job's commands, frames not submitted\n";
+    return ok ? 0 : 1;
+}
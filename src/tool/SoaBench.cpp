@@ -0,0 +1,80 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBounds.h"
+#include "MeshletBuilder.h"
+#include "VectorMath.h"
+#include "VertexStreams.h"
+
+#include <cfloat>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+Float3 MeshExtent(const Float3* positions, size_t count, size_t stride)
+{
+    Float3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Float3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (size_t i = 0; i < count; ++i) {
+        const Float3& p = *reinterpret_cast<const Float3*>(reinterpret_cast<const uint8_t*>(positions) + i * stride);
+        lo = Min(lo, p);
+        hi = Max(hi, p);
+    }
+    return hi - lo;
+}
+
+} // namespace
+
+int SoaBenchCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint64_t runs = std::max<uint64_t>(1, args.GetUInt("runs", 5));
+    const unsigned threads = static_cast<unsigned>(args.GetUInt("threads", 1));
+
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 4'000'000));
+    const VertexStreams streams = VertexStreams::FromVertices(mesh.vertices);
+    const MeshletData data = MeshletBuilder::BuildParallel(mesh.indices.data(), mesh.indices.size(), streams.positions.data(), streams.positions.size());
+    std::cout << mesh.indices.size() / 3 << " triangles, " << mesh.vertices.size() << " vertices, " << data.meshlets.size() << " meshlets, "
+              << threads << (threads == 1 ? " thread" : " threads") << "\n\n";
+
+    const Float3* aos = &mesh.vertices[0].position;
+    const Float3* soa = streams.positions.data();
+
+    auto best = [&](auto&& work)
+    {
+        double seconds = 1e30;
+        for (uint64_t run = 0; run < runs; ++run) {
+            Stopwatch timer;
+            work();
+            seconds = std::min(seconds, timer.Seconds());
+        }
+        return seconds;
+    };
+
+    std::cout << std::left << std::setw(22) << "pass" << std::right << std::setw(12) << "AoS ms" << std::setw(12) << "SoA ms" << std::setw(10) << "speedup" << "\n";
+    auto report = [&](const char* name, double aosSeconds, double soaSeconds)
+    {
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << aosSeconds * 1e3 << std::setw(12) << soaSeconds * 1e3 << std::setw(9) << aosSeconds / soaSeconds << "x\n";
+    };
+
+    // Keeps the results alive so the passes aren't optimized away
+    volatile float sink = 0.f;
+
+    report("mesh bounds",
+        best([&] { sink = sink + MeshExtent(aos, mesh.vertices.size(), sizeof(Vertex)).x; }),
+        best([&] { sink = sink + MeshExtent(soa, streams.positions.size(), sizeof(Float3)).x; }));
+
+    report("meshlet bounds",
+        best([&] { sink = sink + MeshletBoundsBuilder::Compute(data, aos, sizeof(Vertex), threads).back().radius; }),
+        best([&] { sink = sink + MeshletBoundsBuilder::Compute(data, soa, sizeof(Float3), threads).back().radius; }));
+
+    report("meshlet build",
+        best([&] { sink = sink + float(MeshletBuilder::BuildParallel(mesh.indices.data(), mesh.indices.size(), aos, mesh.vertices.size(), 128, 128, threads, sizeof(Vertex)).meshlets.size()); }),
+        best([&] { sink = sink + float(MeshletBuilder::BuildParallel(mesh.indices.data(), mesh.indices.size(), soa, streams.positions.size(), 128, 128, threads, sizeof(Float3)).meshlets.size()); }));
+
+    std::cout << "\nposition bytes per vertex fetched from memory: AoS " << sizeof(Vertex) << ", SoA " << sizeof(Float3) << "\n";
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBuilder.h"
+#include "MeshletPack.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// What InitSample does on the CPU: get the meshlet pack (cooking it on a miss) and copy every
+// stream into upload memory.
+double TimeStartup(const std::filesystem::path& source, const std::filesystem::path& packPath, const MeshletBuildParams& params, bool& cacheHit)
+{
+    Stopwatch timer;
+    const MeshletPack pack = MeshletPack::LoadOrCook(source, packPath, params, [&](const ObjMesh& mesh, const Float3*, size_t) {
+        return MeshletBuilder::Build(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), params.maxVertices, params.maxPrimitives);
+    }, &cacheHit);
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(MeshletPackStream::Count); ++i) {
+        const auto stream = static_cast<MeshletPackStream>(i);
+        std::vector<uint8_t> upload(pack.StreamSize(stream));
+        std::memcpy(upload.data(), pack.StreamData(stream), upload.size());
+    }
+    return timer.Seconds();
+}
+
+} // namespace
+
+int StartupCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint64_t runs = std::max<uint64_t>(1, args.GetUInt("runs", 3));
+
+    MeshletBuildParams params;
+    params.builder = MeshletBuilderKind::Greedy;
+    params.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", params.maxVertices));
+    params.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", params.maxPrimitives));
+
+    std::filesystem::path source;
+    bool synthetic = false;
+    if (!args.Positional().empty()) {
+        source = args.Positional()[0];
+    } else {
+        source = std::filesystem::temp_directory_path() / "meshlettool_startup.obj";
+        WriteObj(source, GenerateGridMesh(args.GetUInt("synthetic-triangles", 2'000'000)));
+        synthetic = true;
+    }
+    std::filesystem::path packPath = args.Get("pack", "");
+    if (packPath.empty()) {
+        packPath = source;
+        packPath += ".meshletpack";
+    }
+
+    std::error_code ignored;
+    std::filesystem::remove(packPath, ignored);
+
+    std::cout << std::fixed << std::setprecision(3);
+    bool cacheHit = false;
+    const double cold = TimeStartup(source, packPath, params, cacheHit);
+    std::cout << "cold: " << cold << " s" << (cacheHit ? " (unexpected cache hit)" : "") << "\n";
+
+    double warm = 1e30;
+    for (uint64_t run = 0; run < runs; ++run) {
+        const double seconds = TimeStartup(source, packPath, params, cacheHit);
+        std::cout << "warm: " << seconds << " s" << (cacheHit ? "" : " (unexpected cache miss)") << "\n";
+        warm = std::min(warm, seconds);
+    }
+    std::cout << "pack: " << packPath.string() << " (" << std::filesystem::file_size(packPath) / 1024 << " KiB), "
+              << std::setprecision(1) << cold / warm << "x faster warm\n";
+
+    if (synthetic) {
+        std::filesystem::remove(source, ignored);
+        std::filesystem::remove(packPath, ignored);
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBounds.h"
+#include "MeshletBuilder.h"
+#include "MeshletStats.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+int StatsCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    params.maxVertices = static_cast<uint32_t>(args.GetUInt("max-vertices", params.maxVertices));
+    params.maxPrimitives = static_cast<uint32_t>(args.GetUInt("max-primitives", params.maxPrimitives));
+    params.coneWeight = static_cast<float>(args.GetFloat("cone-weight", params.coneWeight));
+    const uint32_t views = static_cast<uint32_t>(args.GetUInt("views", 64));
+
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    const Float3* positions = &mesh.vertices[0].position;
+
+    const MeshletData data = BuildMeshlets(mesh, params);
+    ValidateMeshlets(data, mesh.indices, params.maxVertices, params.maxPrimitives);
+
+    const std::vector<MeshletBounds> bounds = MeshletBoundsBuilder::Compute(data, positions, sizeof(Vertex));
+    const MeshletStats stats = MeshletStats::Analyze(data, bounds, positions, mesh.vertices.size(), sizeof(Vertex), views);
+
+    const std::string output = args.Get("output", "");
+    if (output.empty()) {
+        stats.WriteJson(std::cout);
+    } else {
+        std::ofstream file(output);
+        if (!file) {
+            throw std::runtime_error("Can't write " + output + ".");
+        }
+        stats.WriteJson(file);
+    }
+    return 0;
+}
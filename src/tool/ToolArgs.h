@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Minimal "--name value" / "--flag" / positional argument parsing for MeshletTool commands.
+class ToolArgs
+{
+public:
+    ToolArgs(const std::vector<std::string>& args)
+    {
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (args[i].rfind("--", 0) == 0) {
+                const bool hasValue = i + 1 < args.size() && args[i + 1].rfind("--", 0) != 0;
+                _options.push_back({ args[i].substr(2), hasValue ? args[++i] : std::string() });
+            } else {
+                _positional.push_back(args[i]);
+            }
+        }
+    }
+
+    const std::vector<std::string>& Positional() const { return _positional; }
+
+    bool Has(const std::string& name) const
+    {
+        return Find(name) != nullptr;
+    }
+
+    std::string Get(const std::string& name, const std::string& fallback) const
+    {
+        const Option* option = Find(name);
+        return option ? option->value : fallback;
+    }
+
+    uint64_t GetUInt(const std::string& name, uint64_t fallback) const
+    {
+        const Option* option = Find(name);
+        if (!option) {
+            return fallback;
+        }
+        try {
+            return std::stoull(option->value);
+        } catch (const std::exception&) {
+            throw std::runtime_error("Option --" + name + " expects a number.");
+        }
+    }
+
+    double GetFloat(const std::string& name, double fallback) const
+    {
+        const Option* option = Find(name);
+        if (!option) {
+            return fallback;
+        }
+        try {
+            return std::stod(option->value);
+        } catch (const std::exception&) {
+            throw std::runtime_error("Option --" + name + " expects a number.");
+        }
+    }
+
+private:
+    struct Option
+    {
+        std::string name;
+        std::string value;
+    };
+
+    const Option* Find(const std::string& name) const
+    {
+        for (const auto& option : _options) {
+            if (option.name == name) {
+                return &option;
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<Option>         _options;
+    std::vector<std::string>    _positional;
+};
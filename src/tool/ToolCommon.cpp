@@ -0,0 +1,251 @@
+#include "ToolCommon.h"
+
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+uint64_t PeakResidentBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+    return 0;
+#endif
+}
+
+ObjMesh GenerateGridMesh(uint64_t triangleCount)
+{
+    const uint32_t side = std::max<uint32_t>(2, static_cast<uint32_t>(std::ceil(std::sqrt(triangleCount / 2.0))) + 1);
+    const float step = 1.f / (side - 1);
+
+    auto height = [](float x, float z)
+    {
+        return 0.05f * std::sin(x * 40.f) * std::cos(z * 37.f) + 0.2f * std::sin(x * 3.f + z * 2.f);
+    };
+
+    ObjMesh mesh;
+    mesh.vertices.resize(size_t(side) * side);
+    for (uint32_t z = 0; z < side; ++z) {
+        for (uint32_t x = 0; x < side; ++x) {
+            const float fx = x * step;
+            const float fz = z * step;
+            const float y = height(fx, fz);
+            const float dx = (height(fx + step, fz) - height(fx - step, fz)) / (2 * step);
+            const float dz = (height(fx, fz + step) - height(fx, fz - step)) / (2 * step);
+            const float length = std::sqrt(dx * dx + 1 + dz * dz);
+
+            Vertex& vertex = mesh.vertices[size_t(z) * side + x];
+            vertex.position = Float3{ fx, y, fz };
+            vertex.normal = Float3{ -dx / length, 1 / length, -dz / length };
+            vertex.textureCoordinate = Float2{ fx, fz };
+        }
+    }
+
+    mesh.indices.reserve(size_t(side - 1) * (side - 1) * 6);
+    for (uint32_t z = 0; z + 1 < side; ++z) {
+        for (uint32_t x = 0; x + 1 < side; ++x) {
+            const uint32_t i = z * side + x;
+            mesh.indices.insert(mesh.indices.end(), { i, i + side, i + 1, i + 1, i + side, i + side + 1 });
+        }
+    }
+    return mesh;
+}
+
+void WriteObj(const std::filesystem::path& path, const ObjMesh& mesh)
+{
+    // The buffer has to outlive the FILE, fclose flushes through it.
+    std::vector<char> buffer(size_t(1) << 20);
+    std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.string().c_str(), "wb"), &std::fclose);
+    if (!file) {
+        throw std::runtime_error("Cannot write " + path.string());
+    }
+    std::setvbuf(file.get(), buffer.data(), _IOFBF, buffer.size());
+
+    for (const auto& vertex : mesh.vertices) {
+        std::fprintf(file.get(), "v %.6f %.6f %.6f\n", vertex.position.x, vertex.position.y, vertex.position.z);
+    }
+    for (const auto& vertex : mesh.vertices) {
+        // ObjLoader and WaveFrontReader flip V on load
+        std::fprintf(file.get(), "vt %.6f %.6f\n", vertex.textureCoordinate.x, 1.f - vertex.textureCoordinate.y);
+    }
+    for (const auto& vertex : mesh.vertices) {
+        std::fprintf(file.get(), "vn %.6f %.6f %.6f\n", vertex.normal.x, vertex.normal.y, vertex.normal.z);
+    }
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        const uint32_t a = mesh.indices[i] + 1;
+        const uint32_t b = mesh.indices[i + 1] + 1;
+        const uint32_t c = mesh.indices[i + 2] + 1;
+        std::fprintf(file.get(), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+    }
+    if (std::ferror(file.get())) {
+        throw std::runtime_error("Failed writing " + path.string());
+    }
+}
+
+ObjMesh LoadMeshArgument(const std::vector<std::string>& positional, uint64_t syntheticTriangles)
+{
+    if (!positional.empty()) {
+        return ObjLoader::Load(positional[0]);
+    }
+    return GenerateGridMesh(syntheticTriangles);
+}
+
+MeshletBuilderKind ParseBuilder(const std::string& name)
+{
+    if (name == "greedy") {
+        return MeshletBuilderKind::Greedy;
+    }
+    if (name == "parallel") {
+        return MeshletBuilderKind::Parallel;
+    }
+    if (name == "clustered") {
+        return MeshletBuilderKind::Clustered;
+    }
+    throw std::runtime_error("Unknown builder " + name + ", expected greedy, parallel or clustered.");
+}
+
+MeshletData BuildMeshlets(const ObjMesh& mesh, const MeshletBuildParams& params)
+{
+    switch (params.builder) {
+    case MeshletBuilderKind::Greedy:
+        return MeshletBuilder::Build(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), params.maxVertices, params.maxPrimitives);
+    case MeshletBuilderKind::Parallel:
+        return MeshletBuilder::BuildParallel(mesh.indices.data(), mesh.indices.size(), &mesh.vertices[0].position, mesh.vertices.size(),
+                                             params.maxVertices, params.maxPrimitives, 0, sizeof(Vertex));
+    case MeshletBuilderKind::Clustered:
+        return MeshletBuilder::BuildClustered(mesh.indices.data(), mesh.indices.size(), &mesh.vertices[0].position, mesh.vertices.size(),
+                                              params.maxVertices, params.maxPrimitives, params.coneWeight, sizeof(Vertex));
+    default:
+        throw std::runtime_error("Builder not available in MeshletTool.");
+    }
+}
+
+void ValidateMeshlets(const MeshletData& data, const std::vector<uint32_t>& indices, uint32_t maxVertices, uint32_t maxPrimitives)
+{
+    using Triangle = std::array<uint32_t, 3>;
+    auto canonical = [](Triangle t)
+    {
+        // Rotate the smallest index first, winding stays intact
+        while (t[0] > t[1] || t[0] > t[2]) {
+            t = Triangle{ t[1], t[2], t[0] };
+        }
+        return t;
+    };
+
+    std::vector<Triangle> expected;
+    expected.reserve(indices.size() / 3);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        expected.push_back(canonical(Triangle{ indices[i], indices[i + 1], indices[i + 2] }));
+    }
+
+    std::vector<Triangle> actual;
+    actual.reserve(expected.size());
+    for (const Meshlet& meshlet : data.meshlets) {
+        if (meshlet.VertCount > maxVertices || meshlet.PrimCount > maxPrimitives
+            || size_t(meshlet.VertOffset) + meshlet.VertCount > data.uniqueVertexIndices.size()
+            || size_t(meshlet.PrimOffset) + meshlet.PrimCount > data.primitiveIndices.size()) {
+            throw std::runtime_error("Meshlet exceeds its limits or buffers");
+        }
+        for (uint32_t p = 0; p < meshlet.PrimCount; ++p) {
+            uint32_t local[3];
+            UnpackTriangle(data.primitiveIndices[meshlet.PrimOffset + p], local[0], local[1], local[2]);
+            Triangle triangle;
+            for (int corner = 0; corner < 3; ++corner) {
+                if (local[corner] >= meshlet.VertCount) {
+                    throw std::runtime_error("Primitive references a vertex outside of its meshlet");
+                }
+                triangle[corner] = data.uniqueVertexIndices[meshlet.VertOffset + local[corner]];
+            }
+            actual.push_back(canonical(triangle));
+        }
+    }
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    if (expected != actual) {
+        throw std::runtime_error("Meshlets don't cover the mesh triangles exactly");
+    }
+}
+
+bool AllBackFacing(const Meshlet& meshlet, const MeshletData& data, const ObjMesh& mesh, const Float3& camera)
+{
+    auto position = [&](uint32_t local) -> const Float3&
+    {
+        return mesh.vertices[data.uniqueVertexIndices[meshlet.VertOffset + local]].position;
+    };
+    for (uint32_t p = 0; p < meshlet.PrimCount; ++p) {
+        uint32_t i0, i1, i2;
+        UnpackTriangle(data.primitiveIndices[meshlet.PrimOffset + p], i0, i1, i2);
+        const Float3& a = position(i0);
+        const Float3& b = position(i1);
+        const Float3& c = position(i2);
+        const double e1[3] = { double(b.x) - a.x, double(b.y) - a.y, double(b.z) - a.z };
+        const double e2[3] = { double(c.x) - a.x, double(c.y) - a.y, double(c.z) - a.z };
+        const double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        if (n[0] * (double(camera.x) - a.x) + n[1] * (double(camera.y) - a.y) + n[2] * (double(camera.z) - a.z) > 0.0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LookAt(const Float3& eye, const Float3& target, const Float3& up, Matrix& m)
+{
+    const Float3 z = Normalize(eye - target);
+    const Float3 x = Normalize(Cross(up, z));
+    const Float3 y = Cross(z, x);
+    const float rows[4][4] = {
+        { x.x, y.x, z.x, 0.f },
+        { x.y, y.y, z.y, 0.f },
+        { x.z, y.z, z.z, 0.f },
+        { -Dot(x, eye), -Dot(y, eye), -Dot(z, eye), 1.f },
+    };
+    std::copy(&rows[0][0], &rows[0][0] + 16, &m[0][0]);
+}
+
+void Perspective(float fovY, float aspect, float nearZ, float farZ, Matrix& m)
+{
+    const float h = 1.f / std::tan(fovY * 0.5f);
+    const float range = farZ / (nearZ - farZ);
+    const float rows[4][4] = {
+        { h / aspect, 0.f, 0.f, 0.f },
+        { 0.f, h, 0.f, 0.f },
+        { 0.f, 0.f, range, -1.f },
+        { 0.f, 0.f, range * nearZ, 0.f },
+    };
+    std::copy(&rows[0][0], &rows[0][0] + 16, &m[0][0]);
+}
+
+void Multiply(const Matrix& a, const Matrix& b, Matrix& result)
+{
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            result[r][c] = a[r][0] * b[0][c] + a[r][1] * b[1][c] + a[r][2] * b[2][c] + a[r][3] * b[3][c];
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "MeshletBuilder.h"
+#include "ObjLoader.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+class Stopwatch
+{
+public:
+    Stopwatch() : _start(std::chrono::steady_clock::now()) {}
+
+    double Seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point _start;
+};
+
+// Highest resident set size of this process so far, 0 when the platform can't tell.
+uint64_t PeakResidentBytes();
+
+// Procedural test mesh: a bumpy height field with roughly triangleCount triangles.
+// Every vertex has its own position, texcoord and normal, like typical scan exports.
+ObjMesh GenerateGridMesh(uint64_t triangleCount);
+
+// Writes mesh as an OBJ file with "f p/t/n" faces.
+void WriteObj(const std::filesystem::path& path, const ObjMesh& mesh);
+
+// OBJ given as the first positional argument, or a generated grid of --synthetic-triangles (default fallbackTriangles).
+ObjMesh LoadMeshArgument(const std::vector<std::string>& positional, uint64_t syntheticTriangles);
+
+// "greedy", "parallel" or "clustered".
+MeshletBuilderKind ParseBuilder(const std::string& name);
+
+// Runs the portable builder params.builder on mesh with all cores.
+MeshletData BuildMeshlets(const ObjMesh& mesh, const MeshletBuildParams& params);
+
+// Throws when meshlets exceed the limits or don't reproduce exactly the triangles of the mesh (in any order, rotation kept).
+void ValidateMeshlets(const MeshletData& data, const std::vector<uint32_t>& indices, uint32_t maxVertices, uint32_t maxPrimitives);
+
+// True when camera is behind the plane of every triangle of meshlet, evaluated in double.
+bool AllBackFacing(const Meshlet& meshlet, const MeshletData& data, const ObjMesh& mesh, const Float3& camera);
+
+using Matrix = float[4][4];
+
+// Row vector camera matrices with the conventions of XMMatrixLookAtRH / XMMatrixPerspectiveFovRH, like the sample's camera
+void LookAt(const Float3& eye, const Float3& target, const Float3& up, Matrix& m);
+void Perspective(float fovY, float aspect, float nearZ, float farZ, Matrix& m);
+void Multiply(const Matrix& a, const Matrix& b, Matrix& result);
@@ -0,0 +1,155 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "MeshletBounds.h"
+#include "UploadArena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+
+// Committed buffers are placed at 64 KiB granularity (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT)
+constexpr uint64_t PlacementAlignment = 64 * 1024;
+
+uint64_t Placed(uint64_t size)
+{
+    return (size + PlacementAlignment - 1) / PlacementAlignment * PlacementAlignment;
+}
+
+struct Stream
+{
+    const char*             name;
+    const void*             data;
+    uint64_t                size;
+};
+
+// Plays the GPU: runs the recorded copies from the upload buffer into the destinations
+void Replay(const UploadArena& arena, const std::vector<uint8_t>& uploadBuffer)
+{
+    for (const UploadArena::Copy& copy : arena.Copies()) {
+        auto* destination = static_cast<std::vector<uint8_t>*>(copy.destination);
+        std::memcpy(destination->data() + copy.destinationOffset, uploadBuffer.data() + copy.sourceOffset, copy.size);
+    }
+}
+
+} // namespace
+
+// Stages the streams InitSample uploads through an UploadArena, replays the copies and checks every
+// destination ends up with its stream, then compares the D3D12 work against one upload buffer per
+// stream. A random pass with mixed sizes, alignments and split destinations checks the allocator.
+int UploadArenaCheckCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint64_t runs = std::max<uint64_t>(1, args.GetUInt("runs", 5));
+
+    MeshletBuildParams params;
+    params.builder = ParseBuilder(args.Get("builder", "parallel"));
+    const ObjMesh mesh = LoadMeshArgument(args.Positional(), args.GetUInt("synthetic-triangles", 1'000'000));
+    const MeshletData data = BuildMeshlets(mesh, params);
+    const Float3* positions = &mesh.vertices[0].position;
+    const std::vector<PackedMeshletBounds> bounds = MeshletBoundsBuilder::Pack(MeshletBoundsBuilder::Compute(data, positions, sizeof(Vertex)),
+                                                                               data, positions, sizeof(Vertex));
+
+    const Stream streams[] = {
+        { "meshlets",               data.meshlets.data(),               data.meshlets.size() * sizeof(Meshlet) },
+        { "unique vertex indices",  data.uniqueVertexIndices.data(),    data.uniqueVertexIndices.size() * sizeof(uint32_t) },
+        { "primitive indices",      data.primitiveIndices.data(),       data.primitiveIndices.size() * sizeof(uint32_t) },
+        { "vertices",               mesh.vertices.data(),               mesh.vertices.size() * sizeof(Vertex) },
+        { "meshlet bounds",         bounds.data(),                      bounds.size() * sizeof(PackedMeshletBounds) },
+    };
+    const size_t streamCount = std::size(streams);
+
+    bool ok = true;
+    std::vector<std::vector<uint8_t>> destinations(streamCount);
+    for (size_t i = 0; i < streamCount; ++i) {
+        destinations[i].assign(streams[i].size, 0);
+    }
+    UploadArena arena;
+    std::vector<uint8_t> uploadBuffer;
+    double arenaSeconds = 1e30;
+    for (uint64_t run = 0; run < runs; ++run) {
+        Stopwatch timer;
+        arena.Reset();
+        for (size_t i = 0; i < streamCount; ++i) {
+            arena.Stage(streams[i].data, streams[i].size, &destinations[i]);
+        }
+        uploadBuffer.resize(arena.Size());
+        arena.Write(uploadBuffer.data());
+        arenaSeconds = std::min(arenaSeconds, timer.Seconds());
+    }
+    Replay(arena, uploadBuffer);
+
+    uint64_t bytes = 0, separateFootprint = 0;
+    for (size_t i = 0; i < streamCount; ++i) {
+        const bool intact = std::memcmp(destinations[i].data(), streams[i].data, streams[i].size) == 0;
+        ok = ok && intact;
+        bytes += streams[i].size;
+        separateFootprint += Placed(streams[i].size);
+        std::cout << std::left << std::setw(24) << streams[i].name << std::right << std::setw(10) << streams[i].size / 1024 << " KiB"
+                  << (intact ? "" : "  MISMATCH") << "\n";
+    }
+
+    // The same bytes the old way: one upload buffer per stream, each filled on its own
+    double separateSeconds = 1e30;
+    for (uint64_t run = 0; run < runs; ++run) {
+        Stopwatch timer;
+        for (const Stream& stream : streams) {
+            std::vector<uint8_t> upload(stream.size);
+            std::memcpy(upload.data(), stream.data, stream.size);
+        }
+        separateSeconds = std::min(separateSeconds, timer.Seconds());
+    }
+
+    std::cout << "\n" << bytes / 1024 << " KiB in " << streamCount << " streams, best of " << runs << " runs\n" << std::fixed << std::setprecision(2)
+              << "per stream: " << streamCount << " upload buffers (" << separateFootprint / 1024 << " KiB placed), " << streamCount << " Map/Unmap, "
+              << streamCount << " CopyResource, " << streamCount << " ResourceBarrier calls, " << separateSeconds * 1e3 << " ms\n"
+              << "arena:      1 upload buffer (" << Placed(arena.Size()) / 1024 << " KiB placed, " << arena.Size() - bytes << " bytes padding), 1 Map/Unmap, "
+              << arena.Copies().size() << " CopyBufferRegion, 1 ResourceBarrier call with " << arena.Destinations().size() << " barriers, "
+              << arenaSeconds * 1e3 << " ms\n";
+
+    // Random uploads, some split over several Stage calls into the same destination
+    std::mt19937_64 random(args.GetUInt("seed", 1));
+    const uint32_t randomUploads = static_cast<uint32_t>(args.GetUInt("random-uploads", 2000));
+    std::vector<std::vector<uint8_t>> sources(randomUploads), targets(randomUploads);
+    uint64_t misaligned = 0, overlapping = 0, corrupted = 0;
+    arena.Reset();
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    for (uint32_t i = 0; i < randomUploads; ++i) {
+        sources[i].resize(std::uniform_int_distribution<size_t>(1, random() % 8 == 0 ? 64 * 1024 : 300)(random));
+        std::generate(sources[i].begin(), sources[i].end(), [&]() { return static_cast<uint8_t>(random()); });
+        targets[i].assign(sources[i].size(), 0);
+
+        const uint32_t pieces = std::uniform_int_distribution<uint32_t>(1, 3)(random);
+        uint64_t start = 0;
+        for (uint32_t piece = 0; piece < pieces; ++piece) {
+            const uint64_t end = piece + 1 == pieces ? sources[i].size() : std::uniform_int_distribution<uint64_t>(start, sources[i].size())(random);
+            const uint64_t alignment = uint64_t(1) << std::uniform_int_distribution<uint32_t>(0, 9)(random);
+            const uint64_t offset = arena.Stage(sources[i].data() + start, end - start, &targets[i], start, alignment);
+            misaligned += offset % alignment != 0;
+            if (end > start) {
+                ranges.emplace_back(offset, offset + end - start);
+            }
+            start = end;
+        }
+    }
+    std::sort(ranges.begin(), ranges.end());
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        overlapping += ranges[i].first < ranges[i - 1].second;
+    }
+    uploadBuffer.assign(arena.Size(), 0);
+    arena.Write(uploadBuffer.data());
+    Replay(arena, uploadBuffer);
+    for (uint32_t i = 0; i < randomUploads; ++i) {
+        corrupted += targets[i] != sources[i];
+    }
+
+    std::cout << "\n" << randomUploads << " random uploads in " << arena.Allocations() << " allocations, " << arena.Copies().size() << " copies: "
+              << misaligned << " misaligned, " << overlapping << " overlapping, " << corrupted << " corrupted\n";
+    ok = ok && misaligned == 0 && overlapping == 0 && corrupted == 0 && arena.StagedBytes() <= arena.Size();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "UploadQueue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+
+// Copy queue that runs its batches in order, a random number of fence polls late. A batch's copies
+// read its upload memory when the batch runs, so memory retired too early shows up as a violation
+// and data read before the copies ran as corruption.
+class SimulatedCopyQueue : public UploadQueueBackend
+{
+public:
+    explicit SimulatedCopyQueue(uint32_t seed) : _random(seed) {}
+
+    void* BeginBatch(uint64_t batch, uint64_t size) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _violations += batch != _batches.size() + 1;
+        _batches.push_back(Batch{ std::vector<uint8_t>(size), {}, false });
+        return _batches.back().upload.data();
+    }
+
+    void RecordCopy(uint64_t batch, void* destination, uint64_t destinationOffset, uint64_t sourceOffset, uint64_t size) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _batches[batch - 1].copies.push_back(Copy{ static_cast<std::vector<uint8_t>*>(destination), destinationOffset, sourceOffset, size });
+    }
+
+    void Submit(uint64_t batch) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _violations += batch != _submitted + 1;
+        _submitted = batch;
+    }
+
+    void Retire(uint64_t batch) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _violations += batch > _completed;
+        Batch& retired = _batches[batch - 1];
+        retired.upload = std::vector<uint8_t>();
+        retired.retired = true;
+        ++_retired;
+    }
+
+    uint64_t CompletedValue() override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // Every poll finds the copy queue one batch further at most
+        if (_completed < _submitted && _random() % 2 == 0) {
+            Run(_completed + 1);
+        }
+        return _completed;
+    }
+
+    void WaitFor(uint64_t value) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (value > _submitted) {
+            // Would block forever
+            ++_violations;
+            return;
+        }
+        Run(value);
+    }
+
+    void QueueWait(uint64_t value) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _violations += value > _submitted;
+        _directWaited = std::max(_directWaited, value);
+    }
+
+    // Work on the direct queue, which starts once the copy fence reaches what the queue waits for
+    template <typename Work>
+    void OnDirectQueue(Work&& work)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Run(std::min(_directWaited, _submitted));
+        work();
+    }
+
+    uint64_t Violations() const { return _violations; }
+    uint64_t Unretired() const { return _batches.size() - _retired; }
+
+private:
+    struct Copy
+    {
+        std::vector<uint8_t>*   destination;
+        uint64_t                destinationOffset;
+        uint64_t                sourceOffset;
+        uint64_t                size;
+    };
+
+    struct Batch
+    {
+        std::vector<uint8_t>    upload;
+        std::vector<Copy>       copies;
+        bool                    retired;
+    };
+
+    void Run(uint64_t value)
+    {
+        for (; _completed < value; ++_completed) {
+            const Batch& batch = _batches[_completed];
+            if (batch.retired) {
+                ++_violations;
+                continue;
+            }
+            for (const Copy& copy : batch.copies) {
+                std::memcpy(copy.destination->data() + copy.destinationOffset, batch.upload.data() + copy.sourceOffset, copy.size);
+            }
+        }
+    }
+
+    std::mutex          _mutex;
+    std::mt19937        _random;
+    std::deque<Batch>   _batches;
+    uint64_t            _submitted = 0;
+    uint64_t            _completed = 0;
+    uint64_t            _directWaited = 0;
+    uint64_t            _retired = 0;
+    uint64_t            _violations = 0;
+};
+
+struct PlannedUpload
+{
+    uint32_t    destination;
+    uint64_t    offset;
+    uint64_t    size;
+};
+
+uint8_t Pattern(uint64_t upload, uint64_t byte)
+{
+    return static_cast<uint8_t>(upload * 131 + byte * 7 + 1);
+}
+
+} // namespace
+
+// Loader threads enqueue uploads while the main thread plays the renderer: it hands off every
+// finished ticket to the direct queue and reads the upload there, where it has to be complete.
+int UploadQueueStressCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint64_t uploadCount = std::max<uint64_t>(1, args.GetUInt("uploads", 20'000));
+    const uint32_t threads = static_cast<uint32_t>(std::max<uint64_t>(1, args.GetUInt("threads", 4)));
+    const uint64_t maxSize = std::max<uint64_t>(1, args.GetUInt("max-size-kb", 64) * 1024);
+    const uint64_t batchBytes = args.GetUInt("batch-kb", 1024) * 1024;
+    const uint64_t budget = std::max<uint64_t>(1, args.GetUInt("budget-kb", 4096) * 1024);
+    const uint32_t seed = static_cast<uint32_t>(args.GetUInt("seed", 1));
+
+    // Every upload gets its own range of one of a few destination buffers
+    const uint32_t destinationCount = 8;
+    std::vector<PlannedUpload> plan(uploadCount);
+    std::vector<uint64_t> destinationSizes(destinationCount, 0);
+    std::mt19937_64 random(seed);
+    uint64_t totalBytes = 0;
+    for (PlannedUpload& upload : plan) {
+        // Mostly small updates, sometimes a whole mesh stream
+        const bool large = random() % 32 == 0;
+        upload.size = std::uniform_int_distribution<uint64_t>(1, large ? maxSize : std::max<uint64_t>(1, maxSize / 64))(random);
+        upload.destination = static_cast<uint32_t>(random() % destinationCount);
+        upload.offset = destinationSizes[upload.destination];
+        destinationSizes[upload.destination] += upload.size;
+        totalBytes += upload.size;
+    }
+    std::vector<std::vector<uint8_t>> destinations(destinationCount);
+    for (uint32_t d = 0; d < destinationCount; ++d) {
+        destinations[d].assign(destinationSizes[d], 0);
+    }
+
+    SimulatedCopyQueue copyQueue(seed);
+    UploadQueue queue(copyQueue, batchBytes, budget);
+
+    std::mutex readyMutex;
+    std::vector<std::pair<uint64_t, uint64_t>> ready;      // upload, ticket
+    uint32_t producersDone = 0;
+
+    Stopwatch timer;
+    std::vector<std::thread> producers;
+    for (uint32_t t = 0; t < threads; ++t) {
+        producers.emplace_back([&, t]()
+        {
+            std::vector<uint8_t> data;
+            for (uint64_t u = t; u < uploadCount; u += threads) {
+                const PlannedUpload& upload = plan[u];
+                data.resize(upload.size);
+                for (uint64_t b = 0; b < upload.size; ++b) {
+                    data[b] = Pattern(u, b);
+                }
+                const uint64_t ticket = queue.Enqueue(data.data(), upload.size, &destinations[upload.destination], upload.offset);
+                std::lock_guard<std::mutex> lock(readyMutex);
+                ready.emplace_back(u, ticket);
+            }
+            std::lock_guard<std::mutex> lock(readyMutex);
+            ++producersDone;
+        });
+    }
+
+    // The renderer: a frame uses whatever uploads were enqueued by then
+    uint64_t frames = 0, handOffs = 0, corrupted = 0;
+    for (bool done = false; !done;) {
+        std::vector<std::pair<uint64_t, uint64_t>> frameUploads;
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            done = producersDone == threads;
+            frameUploads.swap(ready);
+        }
+        for (const auto& [upload, ticket] : frameUploads) {
+            queue.HandOff(ticket);
+            ++handOffs;
+        }
+        copyQueue.OnDirectQueue([&]()
+        {
+            for (const auto& [upload, ticket] : frameUploads) {
+                const PlannedUpload& planned = plan[upload];
+                const uint8_t* bytes = destinations[planned.destination].data() + planned.offset;
+                bool intact = true;
+                for (uint64_t b = 0; b < planned.size && intact; ++b) {
+                    intact = bytes[b] == Pattern(upload, b);
+                }
+                corrupted += !intact;
+            }
+        });
+        queue.Collect();
+        ++frames;
+        std::this_thread::yield();
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    queue.WaitIdle();
+    const double seconds = timer.Seconds();
+
+    std::cout << queue.Uploads() << " uploads (" << totalBytes / (1024 * 1024) << " MB) from " << threads << " threads in " << queue.Batches()
+              << " batches, " << double(queue.Uploads()) / std::max<uint64_t>(1, queue.Batches()) << " uploads per batch\n"
+              << "peak " << queue.PeakInFlightBytes() / 1024 << " KB of upload memory in flight of " << budget / 1024 << " KB, "
+              << queue.BudgetWaits() << " flushes waited for older batches\n"
+              << handOffs << " hand-offs over " << frames << " frames needed " << queue.QueueWaits() << " GPU waits on the direct queue, "
+              << totalBytes / seconds / (1024 * 1024) << " MB/s (including the checks)\n"
+              << corrupted << " uploads read before their copy, " << copyQueue.Violations() << " fence or memory violations, "
+              << copyQueue.Unretired() << " batches never retired, " << queue.InFlightBytes() << " bytes still in flight\n";
+    const bool ok = queue.Uploads() == uploadCount && corrupted == 0 && copyQueue.Violations() == 0 && copyQueue.Unretired() == 0
+                    && queue.InFlightBytes() == 0;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+#include "Commands.h"
+#include "ToolArgs.h"
+#include "ToolCommon.h"
+
+#include "UploadRing.h"
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <random>
+
+namespace {
+
+struct Allocation
+{
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct PendingFrame
+{
+    uint64_t                fenceValue;
+    uint8_t                 pattern;
+    std::vector<Allocation> allocations;
+};
+
+} // namespace
+
+// The GPU is a queue of frames completing a random number of frames late. Every allocation is filled
+// with its frame's byte and has to still hold it when the frame completes, so handing out space the
+// GPU is still reading shows up as a corrupted frame.
+int UploadRingStressCommand(const std::vector<std::string>& arguments)
+{
+    const ToolArgs args(arguments);
+    const uint64_t frames = std::max<uint64_t>(1, args.GetUInt("frames", 20'000));
+    const uint64_t capacity = args.GetUInt("capacity-kb", 512) * 1024;
+    const uint32_t maxLag = static_cast<uint32_t>(args.GetUInt("max-lag", 3));
+    const uint32_t maxAllocations = static_cast<uint32_t>(args.GetUInt("max-allocations", 300));
+
+    UploadRing ring(capacity);
+    std::vector<uint8_t> memory(capacity, 0);
+    std::mt19937_64 random(args.GetUInt("seed", 1));
+    std::deque<PendingFrame> pending;
+    uint64_t completedFence = 0;
+    uint64_t corrupted = 0, misaligned = 0, outOfBounds = 0, stalls = 0, splits = 0, allocations = 0, bytes = 0, peakUsed = 0;
+
+    auto complete = [&]()
+    {
+        const PendingFrame& frame = pending.front();
+        bool intact = true;
+        for (const Allocation& allocation : frame.allocations) {
+            intact = intact && std::all_of(memory.begin() + allocation.offset, memory.begin() + allocation.offset + allocation.size,
+                                           [&](uint8_t value) { return value == frame.pattern; });
+        }
+        corrupted += !intact;
+        completedFence = frame.fenceValue;
+        pending.pop_front();
+        ring.Reclaim(completedFence);
+    };
+
+    Stopwatch timer;
+    for (uint64_t frameIndex = 0; frameIndex < frames; ++frameIndex) {
+        // The GPU finishes frames in order, but how far it trails varies
+        const uint32_t lag = std::uniform_int_distribution<uint32_t>(0, maxLag)(random);
+        while (pending.size() > lag) {
+            complete();
+        }
+
+        PendingFrame frame;
+        frame.fenceValue = frameIndex + 1;
+        frame.pattern = static_cast<uint8_t>(frameIndex % 251 + 1);
+        const uint32_t count = std::uniform_int_distribution<uint32_t>(0, maxAllocations)(random);
+        for (uint32_t i = 0; i < count; ++i) {
+            // Mostly small constants, sometimes a larger per-instance array
+            const bool large = random() % 16 == 0;
+            const uint64_t size = std::uniform_int_distribution<uint64_t>(1, large ? capacity / 64 : 512)(random);
+            const uint64_t alignment = uint64_t(1) << std::uniform_int_distribution<uint32_t>(2, 8)(random);
+
+            uint64_t offset = ring.Allocate(size, alignment);
+            while (offset == UploadRing::Failed && !pending.empty()) {
+                // Full: wait for the oldest frame like the renderer would
+                ++stalls;
+                complete();
+                offset = ring.Allocate(size, alignment);
+            }
+            if (offset == UploadRing::Failed) {
+                // Only this frame's own allocations are left, submit what it has so far and go on
+                ++splits;
+                ring.EndFrame(frame.fenceValue);
+                pending.push_back(std::move(frame));
+                complete();
+                frame = PendingFrame{ frameIndex + 1, static_cast<uint8_t>(frameIndex % 251 + 1), {} };
+                offset = ring.Allocate(size, alignment);
+            }
+
+            misaligned += offset % alignment != 0;
+            if (offset + size > capacity) {
+                ++outOfBounds;
+                continue;
+            }
+            std::fill(memory.begin() + offset, memory.begin() + offset + size, frame.pattern);
+            frame.allocations.push_back(Allocation{ offset, size });
+            ++allocations;
+            bytes += size;
+            peakUsed = std::max(peakUsed, ring.Used());
+        }
+        ring.EndFrame(frame.fenceValue);
+        pending.push_back(std::move(frame));
+    }
+    while (!pending.empty()) {
+        complete();
+    }
+    const double seconds = timer.Seconds();
+
+    std::cout << frames << " frames, " << allocations << " allocations, " << bytes / (1024 * 1024) << " MB, ring " << capacity / 1024 << " KB, "
+              << "GPU up to " << maxLag << " frames behind\n"
+              << "peak use " << 100.0 * peakUsed / capacity << "%, " << stalls << " waits for the GPU, " << splits << " frames larger than the ring split, "
+              << allocations / seconds / 1e6 << " M allocations/s (including the checks)\n"
+              << corrupted << " corrupted frames, " << misaligned << " misaligned, " << outOfBounds << " out of bounds, "
+              << ring.Used() << " bytes still in use after the last frame\n";
+    return corrupted == 0 && misaligned == 0 && outOfBounds == 0 && ring.Used() == 0 ? 0 : 1;
+}